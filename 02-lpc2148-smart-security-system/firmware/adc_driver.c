@@ -1,73 +1,228 @@
 /*
  * File: adc_driver.c
- * Description: Hardware ADC Driver for LPC2148.
- * Channel: AD0.1 (P0.28)
+ * Description: Hardware ADC Driver for LPC2148 (AD0 + AD1, Timer-Synchronised).
+ * Channels: AD0.1 (P0.28), AD0.2 (P0.29), AD1.2 (P0.10), AD1.3 (P0.12)
+ *
+ * Both converters run in hardware-start mode (START = 100): every rising
+ * edge of MAT0.1 starts one conversion on AD0 and one on AD1 in the same
+ * PCLK cycle, so each pair of readings is sampled at the same instant.
+ * MAT0.1 is toggled by Timer0 MR1 half way through each 1ms tick, giving
+ * an edge every 2ms without any CPU involvement.
+ *
+ * Start mode converts one channel per edge, so the ADC interrupt (AD0
+ * global DONE; AD1 finishes on the same clock) collects both results and
+ * selects the next slot of ADC_AD0_CHANNELS / ADC_AD1_CHANNELS for the
+ * next edge. After the last slot the scan is published as one snapshot:
+ * readers copy it under a VIC lock, so the fan decision never mixes two
+ * scans. Two converters halve the scan time of a single-AD0 rotation.
  *
  * IMPORTANT NOTE FOR SIMULATION (PROTEUS 8.11):
  * ---------------------------------------------
- * This file contains the ACTUAL Hardware ADC code using AD0CR/AD0DR registers.
+ * This file contains the ACTUAL Hardware ADC code using AD0CR/AD1CR registers.
  *
  * REASON FOR BYPASS IN SIMULATION:
- * In Proteus 8.11, the LPC2148 model has a known issue where concurrent 
- * high-speed Digital I/O (LCD/Keypad scanning) conflicts with the Analog 
+ * In Proteus 8.11, the LPC2148 model has a known issue where concurrent
+ * high-speed Digital I/O (LCD/Keypad scanning) conflicts with the Analog
  * Read process, causing the simulation to crash or return invalid data.
- * * Therefore, for simulation purposes, the main application (smart_security.c) 
+ * * Therefore, for simulation purposes, the main application (smart_security.c)
  * manually simulates temperature changes using Keypad buttons (+/-).
  * * This file is intended for the PHYSICAL HARDWARE implementation.
  */
 
 #include <LPC214X.h>
+#include <stdio.h>
 #include "adc_driver.h"
 #include "system_init.h"
+#include "uart_driver.h"
+#include "vic.h"
+
+#define ADC_DONE          0x80000000UL
+#define ADC_CLKDIV        13            // 60MHz / 14 = 4.3MHz (<= 4.5MHz): 2.6us per result
+
+static const uint8_t ad0_channels[ADC_SLOTS] = ADC_AD0_CHANNELS;
+static const uint8_t ad1_channels[ADC_SLOTS] = ADC_AD1_CHANNELS;
+
+// Written only by the ISR; read under VIC_Lock (ADC_GetSnapshot)
+static ADC_Snapshot adc_snap;
+
+// Scan in progress, private to the ISR
+static uint16_t scan_raw[ADC_INPUTS];
+static uint16_t scan_filtered[ADC_INPUTS];
+static uint8_t adc_seeded = 0;             // Bit n set once input n has a sample
+static uint8_t adc_slot = 0;
+
+// SEL = one channel (required outside burst mode), PDN = 1, START = 100
+// (MAT0.1, EDGE = 0: rising)
+static unsigned long ADC_Control(uint8_t channel)
+{
+    return (1UL << channel) | ((unsigned long)ADC_CLKDIV << 8) | (1UL << 21) | (4UL << 24);
+}
+
+static void ADC_Sample(uint8_t input, unsigned long dr)
+{
+    uint16_t sample = (uint16_t)((dr >> 6) & 0x3FF);
+
+    scan_raw[input] = sample;
+
+    // EMA: y += (x - y) / 16, computed in Q4 so no resolution is lost
+    if(!(adc_seeded & (1 << input))) {
+        scan_filtered[input] = sample << ADC_FILTER_SHIFT;  // Seed on first sample
+        adc_seeded |= (1 << input);
+    } else {
+        scan_filtered[input] += (int16_t)(sample - (scan_filtered[input] >> ADC_FILTER_SHIFT));
+    }
+}
+
+static void ADC_Publish(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < ADC_INPUTS; i++) {
+        adc_snap.raw[i] = scan_raw[i];
+        adc_snap.filtered[i] = scan_filtered[i];
+    }
+    adc_snap.seq++;
+    adc_snap.tick = sys_ticks;
+}
+
+void ADC_ISR(void) __irq
+{
+    unsigned long dr0, dr1;
+    uint8_t slot = adc_slot;
+
+    dr0 = AD0GDR;                               // Reading clears DONE (and the request)
+    dr1 = AD1GDR;                               // Same edge, same clock: done as well
+
+    if(dr0 & ADC_DONE) ADC_Sample(slot, dr0);
+    if(dr1 & ADC_DONE) ADC_Sample(ADC_SLOTS + slot, dr1);
+
+    // Channel pair for the next MAT0.1 edge; a late ISR only repeats a slot
+    if(++slot == ADC_SLOTS) {
+        slot = 0;
+        ADC_Publish();
+    }
+    adc_slot = slot;
+    AD0CR = ADC_Control(ad0_channels[slot]);
+    AD1CR = ADC_Control(ad1_channels[slot]);
+
+    VICVectAddr = 0;                            // Acknowledge interrupt
+}
 
 void ADC_Init(void)
 {
-    // 1. Configure P0.28 as AD0.1
-    // PINSEL1 Bits[25:24] = 01
-    PINSEL1 &= ~(0x03000000); // Clear bits
-    PINSEL1 |=  (0x01000000); // Set P0.28 to AD0.1
-    
-    // 2. Configure ADC0 Control Register (AD0CR)
-    // SEL = 0x02 (Channel 1)
-    // CLKDIV = 0x04 (VPB Clock / 5) -> 12MHz ADC Clock (Max is 4.5MHz, needs adjustment)
-    // BURST = 0 (Software Control)
-    // CLKS = 0 (11 clocks/10 bits)
-    // PDN = 1 (Operational)
-    
-    // Assuming PCLK = 60MHz. We need ADC_CLK <= 4.5MHz.
-    // Divisor = (60 / 4.5) = 13.3 -> Let's use 14 (value 13 in bits).
-    // AD0CR = (1<<1) | ((13)<<8) | (1<<21);
-    
-    AD0CR = (1 << 1)      |  // Select AD0.1
-            (13 << 8)     |  // CLKDIV = 13 (60MHz / 14 = ~4.28MHz)
-            (1 << 21);       // PDN = 1 (Enable ADC)
+    // 1. Power both converters (PCONP: PCAD0 bit 12, PCAD1 bit 20)
+    PCONP |= (1 << 12) | (1 << 20);
+
+    // 2. Pins
+    // PINSEL1 Bits[25:24] = 01 -> P0.28 AD0.1, Bits[27:26] = 01 -> P0.29 AD0.2
+    PINSEL1 &= ~(0x0F000000);
+    PINSEL1 |=  (0x05000000);
+    // PINSEL0 Bits[21:20] = 11 -> P0.10 AD1.2, Bits[25:24] = 11 -> P0.12 AD1.3
+    PINSEL0 |=  (0x03300000);
+
+    // 3. First slot, waiting for MAT0.1. AD0 raises one interrupt per pair
+    //    (ADGINTEN), AD1 none: its result is read from the same handler.
+    AD0CR = ADC_Control(ad0_channels[0]);
+    AD1CR = ADC_Control(ad1_channels[0]);
+    AD0INTEN = (1 << 8);
+    AD1INTEN = 0;
+
+    // 4. VIC: below tick and UART
+    VIC_Install(VIC_SLOT_ADC, VIC_CH_AD0, (unsigned long)ADC_ISR);
+
+    // 5. Trigger: Timer0 (1ms tick, system_init.c) MR1 toggles MAT0.1 half
+    //    way through each period. No MR1 interrupt or reset (T0MCR).
+    T0MR1 = (PCLK_HZ / TICK_HZ) / 2;
+    T0EMR = (T0EMR & ~(0x03UL << 6)) | (0x03UL << 6);
+}
+
+void ADC_GetSnapshot(ADC_Snapshot *s)
+{
+    unsigned long lock = VIC_Lock(VIC_BIT(VIC_CH_AD0));
+
+    *s = adc_snap;
+    VIC_Unlock(lock);
+}
+
+uint16_t ADC_GetFiltered(uint8_t input)
+{
+    if(input >= ADC_INPUTS) return 0;
+    return adc_snap.filtered[input];           // 16-bit read is atomic
 }
 
 unsigned int ADC_Read(void)
 {
-    unsigned int adc_data;
-    
-    // 1. Start Conversion (Set START bit [26:24] to 001)
-    AD0CR |= (1 << 24); 
-    
-    // 2. Wait for DONE bit (Bit 31 of AD0DR1)
-    // We check the specific Data Register for Channel 1 (AD0DR1)
-    do {
-        adc_data = AD0DR1;
-    } while ((adc_data & 0x80000000) == 0); // Wait until DONE=1
-    
-    // 3. Stop Conversion (Optional, clears START bits)
-    AD0CR &= ~(0x07000000);
-    
-    // 4. Extract Result
-    // Result is in bits [15:6]
-    adc_data = (adc_data >> 6) & 0x3FF; // 10-bit result (0-1023)
-    
-    // 5. Convert to Temperature (Simple Scaling for LM35)
-    // Vref = 3.3V. Step = 3.3/1023 = 3.22mV
-    // LM35 = 10mV/C.
-    // Temp = (ADC * 322) / 100 / 10 = approx ADC / 3.1
-    // For simplicity in demo: Temp = ADC_Val / 3 (Adjust as needed for sensor)
-    
-    return (adc_data / 3); 
+    // Rounded 10-bit result (0-1023) of the temperature channel
+    return (ADC_GetFiltered(ADC_TEMP_CHANNEL) + (1 << (ADC_FILTER_SHIFT - 1))) >> ADC_FILTER_SHIFT;
+}
+
+int16_t ADC_ZoneTemp(const ADC_Snapshot *s, uint8_t input)
+{
+    int32_t mv_q4;
+    int32_t temp;
+
+    // 1. Filtered counts (Q4) -> millivolts (Q4)
+    //    mV = ADC * VREF / 1024. Max 16368 * 3300 fits easily in 32 bits.
+    mv_q4 = ((int32_t)s->filtered[input] * ADC_VREF_MV) >> 10;
+
+    // 2. LM35 = 10mV/C, so 1 mV == 0.1 C. Apply gain (Q12) with rounding,
+    //    then drop the Q4 fraction. Gain is int16 -> product < 2^31.
+    temp = (mv_q4 * adc_cal_gain + (1L << 15)) >> 16;
+
+    // 3. Apply offset (0.1 C)
+    return (int16_t)(temp + adc_cal_offset);
+}
+
+int16_t ADC_GetTemperature(void)
+{
+    ADC_Snapshot s;
+    int16_t t, hottest;
+    uint8_t i;
+
+    // All zones from the same scan: the fan follows the hottest one
+    ADC_GetSnapshot(&s);
+    hottest = ADC_ZoneTemp(&s, ADC_ZONE1);
+    for(i = 1; i < ADC_ZONES; i++) {
+        t = ADC_ZoneTemp(&s, i);
+        if(t > hottest) hottest = t;
+    }
+    return hottest;
+}
+
+uint16_t ADC_GetSupply(void)
+{
+    // Q4 counts * VREF * divider / 1024, rounded. Max 16368 * 3300 * 2 < 2^27.
+    return (uint16_t)((((uint32_t)ADC_GetFiltered(ADC_SUPPLY) * ADC_VREF_MV * ADC_SUPPLY_DIV)
+                       + (1UL << 13)) >> 14);
+}
+
+void ADC_Report(void)
+{
+    ADC_Snapshot s;
+    char line[48];
+    char temp[ADC_TEMP_TEXT];
+    uint8_t i;
+
+    ADC_GetSnapshot(&s);
+
+    UART_SendString("\r\n--- ADC SCAN ---\r\n");
+    sprintf(line, "Scan %lu @ %lu ms\r\n", (unsigned long)s.seq, (unsigned long)s.tick);
+    UART_SendString(line);
+
+    for(i = 0; i < ADC_ZONES; i++) {
+        sprintf(line, "Zone %u: %s C (raw %u)\r\n", (unsigned int)(i + 1),
+                ADC_FormatTemp(temp, ADC_ZoneTemp(&s, i)), (unsigned int)s.raw[i]);
+        UART_SendString(line);
+    }
+
+    sprintf(line, "Supply: %u mV (raw %u)\r\n", (unsigned int)ADC_GetSupply(), (unsigned int)s.raw[ADC_SUPPLY]);
+    UART_SendString(line);
+}
+
+char *ADC_FormatTemp(char *buf, int16_t tenths)
+{
+    unsigned int a = (tenths < 0) ? (unsigned int)(-tenths) : (unsigned int)tenths;
+
+    sprintf(buf, "%s%u.%u", (tenths < 0) ? "-" : "", a / 10, a % 10);
+    return buf;
 }
@@ -4,7 +4,51 @@
 #include <LPC214X.h>
 #include <stdint.h>
 
+// --- Inputs: AD0 and AD1 convert one channel each on every MAT0.1 edge ---
+// Slot n converts ADC_AD0_CHANNELS[n] and ADC_AD1_CHANNELS[n] together;
+// input index = slot for AD0, ADC_SLOTS + slot for AD1.
+#define ADC_SLOTS            2
+#define ADC_AD0_CHANNELS     { 1, 2 }   // AD0.1 (P0.28), AD0.2 (P0.29)
+#define ADC_AD1_CHANNELS     { 2, 3 }   // AD1.2 (P0.10), AD1.3 (P0.12)
+
+#define ADC_ZONE1            0          // LM35, fan / enclosure (AD0.1)
+#define ADC_ZONE2            1          // LM35, PSU area (AD0.2)
+#define ADC_ZONE3            2          // LM35, motor driver (AD1.2)
+#define ADC_SUPPLY           3          // 5V rail through a 1:2 divider (AD1.3)
+#define ADC_INPUTS           (2 * ADC_SLOTS)
+#define ADC_ZONES            3
+
+#define ADC_TEMP_CHANNEL     ADC_ZONE1  // Input behind ADC_Read()
+#define ADC_VREF_MV          3300       // Measured VREF of the board (mV)
+#define ADC_SUPPLY_DIV       2          // Supply divider ratio
+#define ADC_FILTER_SHIFT     4          // EMA weight = 1/16, result kept in Q4
+
+// --- Calibration Defaults (overridden by settings) ---
+#define ADC_CAL_GAIN_UNITY   4096       // Gain in Q12 (4096 = 1.000)
+#define ADC_CAL_OFFSET_ZERO  0          // Offset in 0.1 C
+#define ADC_CAL_GAIN_MIN     2048       // Accepted range: gain 0.5 - 2.0,
+#define ADC_CAL_GAIN_MAX     8192       // offset +-20.0 C
+#define ADC_CAL_OFFSET_MAX   200
+
+// One complete scan of every input, published by the ADC interrupt
+typedef struct {
+    uint16_t raw[ADC_INPUTS];           // Last conversion, 10-bit
+    uint16_t filtered[ADC_INPUTS];      // EMA in Q4 (0 - 16368)
+    uint32_t seq;                       // Completed scans since ADC_Init()
+    uint32_t tick;                      // sys_ticks when the scan completed
+} ADC_Snapshot;
+
 void ADC_Init(void);
-unsigned int ADC_Read(void);
+void ADC_GetSnapshot(ADC_Snapshot *s);       // Coherent copy of the latest scan
+unsigned int ADC_Read(void);                 // Latest filtered 10-bit value
+uint16_t ADC_GetFiltered(uint8_t input);     // Filtered value in Q4 (0 - 16368)
+int16_t ADC_ZoneTemp(const ADC_Snapshot *s, uint8_t input);   // Calibrated LM35, 0.1 C
+int16_t ADC_GetTemperature(void);            // Hottest zone of one scan, 0.1 C
+uint16_t ADC_GetSupply(void);                // Supply rail in mV
+void ADC_Report(void);                       // UART 'A': every input of one scan
+
+// 0.1 C -> "-0.5", "23.4" (sign kept for -0.9 .. -0.1); buf >= ADC_TEMP_TEXT
+#define ADC_TEMP_TEXT        8
+char *ADC_FormatTemp(char *buf, int16_t tenths);
 
 #endif
@@ -0,0 +1,27 @@
+/*
+ * File        : crc16.c
+ * Description : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ *
+ * NOTES:
+ * Nibble-table implementation: 16-entry table (32 bytes of flash) and two
+ * lookups per byte, a good trade-off on ARM7 between a 512-byte table and
+ * the 8-iteration bitwise loop.
+ */
+
+#include "crc16.h"
+
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    while(len--)
+    {
+        crc = (crc << 4) ^ crc16_nibble[((crc >> 12) ^ (*data >> 4)) & 0x0F];
+        crc = (crc << 4) ^ crc16_nibble[((crc >> 12) ^ (*data & 0x0F)) & 0x0F];
+        data++;
+    }
+    return crc;
+}
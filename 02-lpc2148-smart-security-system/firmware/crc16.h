@@ -0,0 +1,11 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+#define CRC16_INIT   0xFFFF
+
+// CRC-16/CCITT-FALSE (poly 0x1021), chainable: pass the previous result as crc
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t len);
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * File        : event_log.c
+ * Description : Access / alert event log (RAM ring buffer + flash flush).
+ *
+ * NOTES:
+ * EventLog_Add() only fills one 12-byte slot and bumps an index (a few
+ * dozen cycles), so it can be called from the monitor loop freely.
+ * The ring keeps the newest EVENT_LOG_SIZE records; older unflushed
+ * records are overwritten.
+ *
+ * EventLog_Flush() appends unflushed records to the reserved log sector
+ * (see iap_flash.h) in 256-byte pages of 21 records. When the sector is
+ * full it is erased and restarted. Call it from idle context only.
+ * The erase masks every IRQ for up to 400ms, so EventLog_FlushIdle() (the
+ * automatic path) stops at a full sector unless the UART link is quiet.
+ *
+ * Record times are RTC seconds since boot, so each record also carries
+ * the boot number: one more than the newest record found in flash at
+ * EventLog_Init(). The sector is only erased to write a record of the
+ * current boot, so the newest flash record always has the highest one.
+ *
+ * Dumps list the flash records first, then the RAM records not yet
+ * flushed, so each event appears exactly once.
+ *
+ * Binary dump: "EVLG" | count:2 | count x Event_Record | crc16:2
+ */
+
+#include <LPC214X.h>
+#include <stdio.h>
+#include <string.h>
+#include "event_log.h"
+#include "system_init.h"
+#include "uart_driver.h"
+#include "rtc_driver.h"
+#include "iap_flash.h"
+#include "crc16.h"
+#include "adc_driver.h"
+
+#define EVENT_LOG_MASK       (EVENT_LOG_SIZE - 1)
+#define EVENT_REC_PER_PAGE   (FLASH_PAGE_SIZE / sizeof(Event_Record))
+#define EVENT_FLASH_PAGES    (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define EVENT_TYPE_BLANK     0xFF
+#define EVENT_ERASE_QUIET_MS 2000   // RX silence before an automatic erase
+
+static Event_Record ring[EVENT_LOG_SIZE];
+static uint32_t head = 0;               // Total records added
+static uint32_t flushed = 0;            // Records [0, flushed) are in flash
+static uint8_t  flash_page = 0;         // Next blank page in the log sector
+static uint16_t boot_no = 1;            // Boot number stamped on new records
+
+// IAP requires a word-aligned RAM source buffer
+static unsigned long page_buf[FLASH_PAGE_SIZE / 4];
+
+static const char *const event_names[] = {
+    "?", "BOOT", "ACCESS_OK", "ACCESS_FAIL", "LOCKOUT",
+    "ALERT_START", "ALERT_END", "PASS_CHANGE", "THRESHOLD"
+};
+
+static const Event_Record *EventLog_FlashRecord(uint8_t page, uint8_t idx)
+{
+    return (const Event_Record *)IAP_FLASH_PTR(FLASH_LOG_BASE + page * FLASH_PAGE_SIZE) + idx;
+}
+
+// Calls fn for every record in order: flash first, then unflushed RAM
+static uint16_t EventLog_Walk(void (*fn)(const Event_Record *))
+{
+    uint8_t page, idx;
+    uint32_t i;
+    uint16_t n = 0;
+    const Event_Record *e;
+
+    for(page = 0; page < flash_page; page++) {
+        for(idx = 0; idx < EVENT_REC_PER_PAGE; idx++) {
+            e = EventLog_FlashRecord(page, idx);
+            if(e->type == EVENT_TYPE_BLANK) break;   // Padded partial page
+            if(fn) fn(e);
+            n++;
+        }
+    }
+
+    for(i = flushed; i < head; i++) {
+        if(fn) fn(&ring[i & EVENT_LOG_MASK]);
+        n++;
+    }
+    return n;
+}
+
+void EventLog_Init(void)
+{
+    const Event_Record *e;
+    uint8_t idx;
+
+    // Locate the first blank page of the flash log
+    flash_page = 0;
+    while(flash_page < EVENT_FLASH_PAGES &&
+          EventLog_FlashRecord(flash_page, 0)->type != EVENT_TYPE_BLANK) {
+        flash_page++;
+    }
+
+    // Newest record = last one of the last written page
+    boot_no = 1;
+    if(flash_page > 0) {
+        for(idx = EVENT_REC_PER_PAGE; idx > 0; idx--) {
+            e = EventLog_FlashRecord(flash_page - 1, idx - 1);
+            if(e->type != EVENT_TYPE_BLANK) { boot_no = e->boot + 1; break; }
+        }
+    }
+    head = 0;
+    flushed = 0;
+}
+
+uint16_t EventLog_Boot(void)
+{
+    return boot_no;
+}
+
+void EventLog_Add(uint8_t type, int16_t temp)
+{
+    Event_Record *e = &ring[head & EVENT_LOG_MASK];
+
+    e->time      = RTC_GetSeconds();
+    e->boot      = boot_no;
+    e->type      = type;
+    e->threshold = temp_threshold;
+    e->temp      = temp;
+    e->reserved  = 0xFFFF;
+    head++;
+}
+
+uint16_t EventLog_Count(void)
+{
+    return (head - flushed > EVENT_LOG_SIZE) ? EVENT_LOG_SIZE : (uint16_t)(head - flushed);
+}
+
+static void EventLog_SendCSV(const Event_Record *e)
+{
+    char line[48];
+    char temp[ADC_TEMP_TEXT];
+
+    sprintf(line, "%u,%lu,%s,%s,%d\r\n", (unsigned int)e->boot, (unsigned long)e->time,
+            event_names[e->type < sizeof(event_names) / sizeof(event_names[0]) ? e->type : 0],
+            ADC_FormatTemp(temp, e->temp), e->threshold);
+    UART_SendString(line);
+}
+
+void EventLog_DumpCSV(void)
+{
+    if(head - flushed > EVENT_LOG_SIZE) flushed = head - EVENT_LOG_SIZE;   // Overwritten
+
+    UART_SendString("\r\nboot,time,event,temp,threshold\r\n");
+    EventLog_Walk(EventLog_SendCSV);
+}
+
+static uint16_t dump_crc;
+
+static void EventLog_SendBinary(const Event_Record *e)
+{
+    const uint8_t *p = (const uint8_t *)e;
+    uint8_t i;
+
+    for(i = 0; i < sizeof(Event_Record); i++) UART_SendChar(p[i]);
+    dump_crc = CRC16_Update(dump_crc, p, sizeof(Event_Record));
+}
+
+void EventLog_DumpBinary(void)
+{
+    uint16_t count;
+
+    if(head - flushed > EVENT_LOG_SIZE) flushed = head - EVENT_LOG_SIZE;   // Overwritten
+
+    count = EventLog_Walk(0);
+    UART_SendString("EVLG");
+    UART_SendChar(count & 0xFF);
+    UART_SendChar(count >> 8);
+
+    dump_crc = CRC16_INIT;
+    EventLog_Walk(EventLog_SendBinary);
+    UART_SendChar(dump_crc & 0xFF);
+    UART_SendChar(dump_crc >> 8);
+}
+
+static uint16_t read_pos, read_first, read_n, read_max;
+static Event_Record *read_out;
+
+static void EventLog_Copy(const Event_Record *e)
+{
+    if(read_pos >= read_first && read_n < read_max) read_out[read_n++] = *e;
+    read_pos++;
+}
+
+uint16_t EventLog_Read(uint16_t first, Event_Record *out, uint16_t max, uint16_t *total)
+{
+    uint16_t n;
+
+    if(head - flushed > EVENT_LOG_SIZE) flushed = head - EVENT_LOG_SIZE;   // Overwritten
+
+    read_pos = 0; read_first = first; read_n = 0; read_max = max; read_out = out;
+    n = EventLog_Walk(EventLog_Copy);
+    if(total) *total = n;
+    return read_n;
+}
+
+static uint8_t EventLog_FlushPages(uint8_t may_erase)
+{
+    uint8_t n;
+
+    if(head - flushed > EVENT_LOG_SIZE) flushed = head - EVENT_LOG_SIZE;   // Overwritten
+
+    while(flushed < head)
+    {
+        if(flash_page >= EVENT_FLASH_PAGES) {
+            if(!may_erase || !IAP_EraseSector(FLASH_LOG_SECTOR)) return 0;
+            flash_page = 0;
+        }
+
+        // Stage up to one page; unused slots stay blank (0xFF)
+        memset(page_buf, 0xFF, FLASH_PAGE_SIZE);
+        for(n = 0; n < EVENT_REC_PER_PAGE && flushed + n < head; n++) {
+            ((Event_Record *)page_buf)[n] = ring[(flushed + n) & EVENT_LOG_MASK];
+        }
+
+        if(!IAP_ProgramPage(FLASH_LOG_SECTOR,
+                            FLASH_LOG_BASE + flash_page * FLASH_PAGE_SIZE, page_buf)) return 0;
+
+        flash_page++;
+        flushed += n;
+    }
+    return 1;
+}
+
+uint8_t EventLog_Flush(void)
+{
+    return EventLog_FlushPages(1);
+}
+
+uint8_t EventLog_FlushIdle(void)
+{
+    // Pages program in ~1ms each; the sector erase waits for a quiet link
+    return EventLog_FlushPages(UART_RxIdle(EVENT_ERASE_QUIET_MS));
+}
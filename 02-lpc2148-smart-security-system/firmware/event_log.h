@@ -0,0 +1,42 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- Event Types ---
+#define EVT_BOOT             0x01
+#define EVT_ACCESS_OK        0x02
+#define EVT_ACCESS_FAIL      0x03
+#define EVT_LOCKOUT          0x04
+#define EVT_ALERT_START      0x05
+#define EVT_ALERT_END        0x06
+#define EVT_PASSWORD_CHANGE  0x07
+#define EVT_THRESHOLD_SET    0x08
+
+#define EVENT_LOG_SIZE       64     // RAM records (power of 2)
+#define EVENT_LOG_FLUSH_LVL  21     // Idle auto-flush level (one flash page)
+
+// Fixed-size binary record (12 bytes, little-endian). time restarts at
+// every reset: order records by (boot, time).
+typedef struct {
+    uint32_t time;          // RTC seconds since boot
+    uint16_t boot;          // Boot number (newest flash record's + 1)
+    uint8_t  type;          // EVT_*
+    uint8_t  threshold;     // Threshold at event time (C)
+    int16_t  temp;          // Temperature at event time (0.1 C)
+    uint16_t reserved;      // 0xFFFF
+} Event_Record;
+
+void EventLog_Init(void);
+void EventLog_Add(uint8_t type, int16_t temp);   // Main context only
+uint16_t EventLog_Count(void);                   // Unflushed records in RAM
+void EventLog_DumpCSV(void);
+void EventLog_DumpBinary(void);
+// Copies records [first, first+max) in dump order; returns the number copied
+uint16_t EventLog_Read(uint16_t first, Event_Record *out, uint16_t max, uint16_t *total);
+uint8_t EventLog_Flush(void);                    // Persist unflushed records to flash
+uint8_t EventLog_FlushIdle(void);                // Same, erases only with the UART quiet
+uint16_t EventLog_Boot(void);                    // Boot number of this run
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * File        : fan_control.c
+ * Description : Fixed-point PI controller mapping temperature error to fan duty.
+ *
+ * NOTES:
+ * The integrator is kept in Q8 and clamped to the output range (anti-windup),
+ * so no floating point is needed. The Monitor Mode loop period varies (LCD
+ * redraws, protocol frames, flash writes), so the integral step is scaled by
+ * the sys_ticks elapsed since the previous update. The soft-start ramp itself
+ * is applied by the PWM interrupt in motor_driver.c.
+ */
+
+#include "fan_control.h"
+#include "motor_driver.h"
+#include "system_init.h"
+
+#define FAN_OUT_MAX_Q8   ((int32_t)MOTOR_DUTY_MAX << 8)
+
+static int32_t integ_q8 = 0;
+static uint32_t last_tick = 0;
+
+void FanControl_Reset(void)
+{
+    integ_q8 = 0;
+    last_tick = sys_ticks;
+}
+
+uint16_t FanControl_Update(int16_t temp, int16_t limit)
+{
+    int32_t error = (int32_t)temp - limit;     // 0.1 C, positive = too hot
+    int32_t out_q8;
+    uint32_t now = sys_ticks;
+    uint32_t dt = now - last_tick;
+
+    last_tick = now;
+    if(dt > FAN_DT_MAX_MS) dt = FAN_DT_MAX_MS;
+
+    // 1. Integral term (per FAN_PERIOD_MS) with anti-windup clamp
+    integ_q8 += error * FAN_KI_Q8 * (int32_t)dt / FAN_PERIOD_MS;
+    if(integ_q8 < 0) integ_q8 = 0;
+    if(integ_q8 > FAN_OUT_MAX_Q8) integ_q8 = FAN_OUT_MAX_Q8;
+
+    // 2. Proportional term + integral
+    out_q8 = error * FAN_KP_Q8 + integ_q8;
+    if(out_q8 < 0) out_q8 = 0;
+    if(out_q8 > FAN_OUT_MAX_Q8) out_q8 = FAN_OUT_MAX_Q8;
+
+    // 3. Q8 -> duty (rounded); avoid stalling the fan at very low duty
+    out_q8 = (out_q8 + 128) >> 8;
+    if(out_q8 < FAN_MIN_DUTY) out_q8 = (error > 0) ? FAN_MIN_DUTY : 0;
+
+    return (uint16_t)out_q8;
+}
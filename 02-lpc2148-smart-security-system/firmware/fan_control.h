@@ -0,0 +1,17 @@
+#ifndef FAN_CONTROL_H
+#define FAN_CONTROL_H
+
+#include <stdint.h>
+
+// --- PI Tuning (Fixed Point, Q8) ---
+// Error is in 0.1 C, output is duty in 0.1% (0 - MOTOR_DUTY_MAX)
+#define FAN_KP_Q8        (20 * 256)   // 2.0% duty per 0.1 C -> full speed at +5 C
+#define FAN_KI_Q8        64           // 0.025% duty per 0.1 C per FAN_PERIOD_MS
+#define FAN_PERIOD_MS    50           // Integral step reference (Monitor loop pacing)
+#define FAN_DT_MAX_MS    1000         // Longer gaps (menus, flash) count as this
+#define FAN_MIN_DUTY     150          // Below this the fan stalls -> switch off
+
+void FanControl_Reset(void);
+uint16_t FanControl_Update(int16_t temp, int16_t limit);   // Integral scaled by elapsed sys_ticks
+
+#endif
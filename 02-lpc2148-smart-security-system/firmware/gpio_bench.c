@@ -0,0 +1,68 @@
+/*
+ * File        : gpio_bench.c
+ * Description : Cycle-count benchmark of the LCD nibble write paths.
+ *
+ * NOTES:
+ * Compares the old APB sequence (IO0CLR + IO0SET) with the fast GPIO
+ * masked store used by LCD_Write4Bits(). Timer1 is the free-running
+ * cycle counter (PCLK = CCLK, see system_init.c). A loop
+ * with a RAM store in place of the port writes is subtracted as baseline.
+ *
+ * Safe at runtime: in fast GPIO mode the legacy registers no longer
+ * drive the pins, and the FIO loop only moves D4-D7 while EN is low, so
+ * the LCD ignores it. Interrupts are masked during the measurement.
+ */
+
+#include <LPC214X.h>
+#include <stdio.h>
+#include "gpio_bench.h"
+#include "lcd_driver.h"
+#include "system_init.h"
+#include "uart_driver.h"
+#include "vic.h"
+
+static volatile uint32_t bench_sink;
+
+static void Bench_Print(char *name, uint32_t cycles, uint32_t base)
+{
+    char buf[40];
+    uint32_t x100 = ((cycles - base) * 100) / GPIO_BENCH_LOOPS;
+
+    sprintf(buf, "%s: %lu.%02lu cycles\r\n", name,
+            (unsigned long)(x100 / 100), (unsigned long)(x100 % 100));
+    UART_SendString(buf);
+}
+
+void GPIO_Benchmark(void)
+{
+    unsigned long lock;
+    uint32_t t_base, t_apb, t_fio;
+    uint32_t i;
+
+    lock = VIC_Lock(VIC_ALL);           // No ISR time in the samples
+
+    t_base = CYCLES_NOW();
+    for(i = 0; i < GPIO_BENCH_LOOPS; i++) bench_sink = (i & 0x0F) << 4;
+    t_base = CYCLES_NOW() - t_base;
+
+    t_apb = CYCLES_NOW();
+    for(i = 0; i < GPIO_BENCH_LOOPS; i++) {
+        IO0CLR = LCD_PIN_DATA;
+        IO0SET = (i & 0x0F) << 4;
+    }
+    t_apb = CYCLES_NOW() - t_apb;
+
+    t_fio = CYCLES_NOW();
+    for(i = 0; i < GPIO_BENCH_LOOPS; i++) {
+        FIO0MASK = ~LCD_PIN_DATA;
+        FIO0PIN  = (i & 0x0F) << 4;
+        FIO0MASK = 0;
+    }
+    t_fio = CYCLES_NOW() - t_fio;
+
+    VIC_Unlock(lock);
+
+    UART_SendString("\r\n--- LCD NIBBLE WRITE ---\r\n");
+    Bench_Print("APB IO0CLR+IO0SET", t_apb, t_base);
+    Bench_Print("FIO masked store ", t_fio, t_base);
+}
@@ -0,0 +1,12 @@
+#ifndef GPIO_BENCH_H
+#define GPIO_BENCH_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+#define GPIO_BENCH_LOOPS   256
+
+// Legacy (APB) vs fast (FIO) LCD nibble write, printed in CCLK cycles
+void GPIO_Benchmark(void);
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * File        : iap_flash.c
+ * Description : In-Application Programming (IAP) wrapper for on-chip flash.
+ *
+ * NOTES:
+ * Flash is unavailable while the IAP ROM routine runs, so all VIC
+ * interrupts are masked for the duration of each call and restored
+ * afterwards. The top 32 bytes of on-chip RAM are used by IAP and must
+ * not be used by the application (reserve them in the Keil IRAM setting).
+ * Page program ~1ms, 4KB sector erase ~100-400ms.
+ */
+
+#include <LPC214X.h>
+#include "iap_flash.h"
+#include "vic.h"
+
+#define IAP_LOCATION          0x7FFFFFF1
+#define IAP_CMD_PREPARE       50
+#define IAP_CMD_COPY_RAM      51
+#define IAP_CMD_ERASE         52
+#define IAP_CMD_SUCCESS       0
+
+typedef void (*IAP_Entry)(unsigned long cmd[], unsigned long result[]);
+
+static unsigned long IAP_Call(unsigned long *cmd)
+{
+    unsigned long result[5];
+    unsigned long lock;
+    IAP_Entry iap = (IAP_Entry)IAP_LOCATION;
+
+    // Flash is busy during IAP: mask every VIC source, then restore
+    lock = VIC_Lock(VIC_ALL);
+    iap(cmd, result);
+    VIC_Unlock(lock);
+    return result[0];
+}
+
+static uint8_t IAP_Prepare(uint8_t sector)
+{
+    unsigned long cmd[5];
+
+    cmd[0] = IAP_CMD_PREPARE;
+    cmd[1] = sector;
+    cmd[2] = sector;
+    return IAP_Call(cmd) == IAP_CMD_SUCCESS;
+}
+
+uint8_t IAP_EraseSector(uint8_t sector)
+{
+    unsigned long cmd[5];
+
+    if(!IAP_Prepare(sector)) return 0;
+
+    cmd[0] = IAP_CMD_ERASE;
+    cmd[1] = sector;
+    cmd[2] = sector;
+    cmd[3] = IAP_CCLK_KHZ;
+    return IAP_Call(cmd) == IAP_CMD_SUCCESS;
+}
+
+uint8_t IAP_ProgramPage(uint8_t sector, uint32_t addr, const unsigned long *buf)
+{
+    unsigned long cmd[5];
+
+    if(!IAP_Prepare(sector)) return 0;
+
+    cmd[0] = IAP_CMD_COPY_RAM;
+    cmd[1] = addr;                     // 256-byte aligned
+    cmd[2] = (unsigned long)buf;       // Word-aligned RAM
+    cmd[3] = FLASH_PAGE_SIZE;
+    cmd[4] = IAP_CCLK_KHZ;
+    return IAP_Call(cmd) == IAP_CMD_SUCCESS;
+}
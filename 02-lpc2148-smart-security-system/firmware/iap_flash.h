@@ -0,0 +1,26 @@
+#ifndef IAP_FLASH_H
+#define IAP_FLASH_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+#include "system_init.h"
+
+// --- Reserved Flash Layout (exclude from Keil IROM: limit to 0x7A000) ---
+#define FLASH_PAGE_SIZE         256
+#define FLASH_SECTOR_SIZE       4096        // Sectors 22-26 are 4KB
+#define FLASH_LOG_SECTOR        24          // Event log    0x7A000 - 0x7AFFF
+#define FLASH_LOG_BASE          0x0007A000
+#define FLASH_SETTINGS_SECTOR   25          // Settings A/B 0x7B000 - 0x7CFFF
+#define FLASH_SETTINGS_BASE     0x0007B000
+
+#define IAP_CCLK_KHZ            (CCLK_HZ / 1000)   // Must track the running CCLK
+
+// Read access to a flash address (the host simulator remaps this)
+#ifndef IAP_FLASH_PTR
+#define IAP_FLASH_PTR(addr)     ((const void *)(addr))
+#endif
+
+uint8_t IAP_EraseSector(uint8_t sector);                               // 1 = OK
+uint8_t IAP_ProgramPage(uint8_t sector, uint32_t addr, const unsigned long *buf); // 256 bytes
+
+#endif
@@ -6,33 +6,48 @@
  * GPIO sequencing and conservative delays are used to ensure stable
  * operation in simulation environments where instruction timing
  * may not perfectly reflect real hardware behavior.
+ *
+ * Pins are driven through the fast GPIO registers (FIO0xxx). The data
+ * nibble is written with one masked FIO0PIN store: FIO0MASK hides every
+ * pin except D4-D7 for that single access, so RS/EN are never disturbed
+ * and no clear+set glitch appears on the bus. FIO0SET/FIO0CLR obey the
+ * mask too, so with VIC_PROBE_PIN enabled the tick (whose ISR drives the
+ * probe pin on port 0) is held off for the three stores; no other ISR
+ * touches port 0.
  */
 
 #include <LPC214X.h>
 #include "system_init.h"
 #include "lcd_driver.h"
+#include "vic.h"
 
 void LCD_PulseEnable(void)
 {
-    IO0SET = (1 << 2);      // EN High
+    FIO0SET = LCD_PIN_EN;   // EN High
     delayms(2);
-    IO0CLR = (1 << 2);      // EN Low
+    FIO0CLR = LCD_PIN_EN;   // EN Low
 }
 
 void LCD_Write4Bits(uint8_t val)
 {
-    // Clear Data Pins (P0.4 - P0.7)
-    IO0CLR = 0x000000F0; 
-    
-    // Shift Data to P0.4-P0.7 and Write
-    IO0SET = ((val & 0x0F) << 4);
+#if VIC_PROBE_PIN
+    unsigned long lock = VIC_Lock(VIC_BIT(VIC_CH_TIMER0));   // Probe write would be masked
+#endif
+
+    // Masked store: only P0.4-P0.7 take the new nibble
+    FIO0MASK = ~LCD_PIN_DATA;
+    FIO0PIN  = (val & 0x0F) << 4;
+    FIO0MASK = 0;
+#if VIC_PROBE_PIN
+    VIC_Unlock(lock);
+#endif
     
     LCD_PulseEnable();
 }
 
 void LCD_SendCommand(char cmd)
 {
-    IO0CLR = (1 << 0);        // RS = 0 (Command)
+    FIO0CLR = LCD_PIN_RS;     // RS = 0 (Command)
     LCD_Write4Bits(cmd >> 4); // Send Upper Nibble
     LCD_Write4Bits(cmd);      // Send Lower Nibble
     delayms(2);
@@ -40,7 +55,7 @@ void LCD_SendCommand(char cmd)
 
 void LCD_SendChar(char data)
 {
-    IO0SET = (1 << 0);         // RS = 1 (Data)
+    FIO0SET = LCD_PIN_RS;      // RS = 1 (Data)
     LCD_Write4Bits(data >> 4); // Send Upper Nibble
     LCD_Write4Bits(data);      // Send Lower Nibble
     delayms(2);
@@ -54,13 +69,13 @@ void LCD_SendString(char *str)
 void LCD_Init(void)
 {
     // Configure Control & Data Pins as Output
-    IODIR0 |= 0x000000F5;  
-    IO0CLR = 0x000000F5; 
+    FIO0DIR |= LCD_PIN_RS | LCD_PIN_EN | LCD_PIN_DATA;
+    FIO0CLR  = LCD_PIN_RS | LCD_PIN_EN | LCD_PIN_DATA;
     
     delayms(50); // Power-up stabilization
     
     // 4-Bit Initialization Sequence
-    IO0CLR = (1 << 0); 
+    FIO0CLR = LCD_PIN_RS; 
     LCD_Write4Bits(0x02); 
     delayms(5);
     
@@ -4,6 +4,11 @@
 #include<LPC214X.h>
 #include <stdint.h>
 
+// --- Pins (Port 0, fast GPIO) ---
+#define LCD_PIN_RS               (1 << 0)
+#define LCD_PIN_EN               (1 << 2)
+#define LCD_PIN_DATA             0x000000F0   // D4-D7 on P0.4-P0.7
+
 #define LCD_CMD_CLEAR            0x01
 #define LCD_CMD_HOME             0x02
 #define LCD_CMD_4BIT             0x28
@@ -2,6 +2,11 @@
  * File: motor_driver.c
  * Description: PWM Motor Control Driver (P0.21 / PWM5).
  *
+ * The PWM timer runs undivided from PCLK at 25kHz (MOTOR_PWM_PERIOD counts
+ * per period), giving 0.1% duty resolution without audible whine.
+ * Duty changes are applied as a soft ramp by the PWM MR0 interrupt, which
+ * is enabled only while the output is moving towards its target.
+ *
  * SIMULATION NOTE (Proteus 8.11):
  * -------------------------------
  * While this driver generates a valid PWM signal on P0.21, connecting an
@@ -16,6 +21,42 @@
  */
 
 #include "motor_driver.h"
+#include "vic.h"
+
+static volatile uint16_t duty_target  = 0;
+static volatile uint16_t duty_current = 0;
+static uint8_t ramp_div = 0;
+
+static void Motor_ApplyDuty(uint16_t duty)
+{
+    // Scale 0-1000 to 0-MOTOR_PWM_PERIOD match counts (MR5 > MR0: never
+    // cleared, output high for the whole period = 100%)
+    PWMMR5 = ((uint32_t)duty * MOTOR_PWM_PERIOD) / MOTOR_DUTY_MAX;
+
+    // Latch the new value to update PWM hardware (at next period)
+    PWMLER = (1 << 5);
+}
+
+void PWM_ISR(void) __irq
+{
+    VIC_LatencySample(VIC_PROBE_PWM, PWMTC);    // TC restarted at MR0
+    PWMIR = (1 << 0);                   // Clear MR0 interrupt
+
+    if(++ramp_div >= MOTOR_RAMP_DIV)
+    {
+        ramp_div = 0;
+
+        if(duty_current < duty_target)      duty_current++;
+        else if(duty_current > duty_target) duty_current--;
+
+        Motor_ApplyDuty(duty_current);
+
+        // Ramp complete: stop interrupting every period
+        if(duty_current == duty_target) PWMMCR &= ~(1 << 0);
+    }
+
+    VICVectAddr = 0;                    // Acknowledge interrupt
+}
 
 void Motor_Init(void)
 {
@@ -23,45 +64,62 @@ void Motor_Init(void)
     // PINSEL1 [11:10] = 01 -> 0x00000400
     PINSEL1 &= ~(0x00000C00); // Clear bits 10,11
     PINSEL1 |=  0x00000400;   // Set P0.21 to PWM5
-    
+
     // 2. PWM Configuration
     PWMTCR = (1 << 1);     // Reset Counter
-    
-    // Prescaler for 1ms Timer resolution
-    // PCLK = 60MHz. 60,000,000 / 60,000 = 1000Hz (1ms)
-    PWMPR  = 60000 - 1;    
-    
-    // Set Total Period = 10ms (100Hz)
-    PWMMR0 = 10;           
-    
-    PWMMCR = 0x02;         // Reset PWMTC when it matches MR0
-    
+
+    // No prescaler: PWM timer ticks at PCLK (60MHz, 16.7ns)
+    PWMPR  = 0;
+
+    // Set Total Period = 2400 ticks (40us, 25kHz): the counter resets on
+    // the tick after matching MR0, so a period is MR0 + 1 counts
+    PWMMR0 = MOTOR_PWM_PERIOD - 1;
+
+    PWMMCR = 0x02;         // Reset PWMTC when it matches MR0 (IRQ off until ramping)
+
     // Enable PWM5 Output (Bit 13) and Set Single Edge Mode
-    PWMPCR = (1 << 13);    
-    
+    PWMPCR = (1 << 13);
+
     // Initial State: OFF (Duty Cycle 0)
-    PWMMR5 = 0;            
-    
+    PWMMR5 = 0;
+
     // Latch Enable (Load MR0 and MR5)
-    PWMLER = (1 << 0) | (1 << 5); 
-    
+    PWMLER = (1 << 0) | (1 << 5);
+
+    // 3. VIC: ramp stepping
+    VIC_Install(VIC_SLOT_PWM, VIC_CH_PWM, (unsigned long)PWM_ISR);
+
     // Enable PWM and Counter
-    PWMTCR = 0x09;         
+    PWMTCR = 0x09;
+}
+
+void Motor_SetDuty(uint16_t duty)
+{
+    if(duty > MOTOR_DUTY_MAX) duty = MOTOR_DUTY_MAX;
+    if(duty == duty_target) return;
+
+    duty_target = duty;
+    PWMMCR |= (1 << 0);    // Interrupt on MR0 -> ISR ramps towards target
 }
 
 void Motor_SetState(uint8_t state)
 {
     if(state == 1)
     {
-        // Turn ON: Set Duty Cycle to 10ms (100% Speed)
-        PWMMR5 = 10; 
+        // Turn ON: Ramp up to 100% Speed
+        Motor_SetDuty(MOTOR_DUTY_MAX);
     }
     else
     {
-        // Turn OFF: Set Duty Cycle to 0ms
-        PWMMR5 = 0; 
+        // Turn OFF: Stop immediately (safety), cancel any ramp
+        PWMMCR &= ~(1 << 0);
+        duty_target  = 0;
+        duty_current = 0;
+        Motor_ApplyDuty(0);
     }
-    
-    // Latch the new value to update PWM hardware
-    PWMLER = (1 << 5); 
-}
\ No newline at end of file
+}
+
+uint16_t Motor_GetDuty(void)
+{
+    return duty_current;
+}
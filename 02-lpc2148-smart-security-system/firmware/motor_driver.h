@@ -4,7 +4,15 @@
 #include <LPC214X.h>
 #include <stdint.h>
 
+// --- PWM Configuration ---
+#define MOTOR_PWM_PERIOD     2400   // 60MHz / 2400 = 25kHz (above audible range)
+#define MOTOR_DUTY_MAX       1000   // Duty API resolution: 0.1% steps
+#define MOTOR_RAMP_DIV       12     // PWM periods per ramp step
+                                    // -> 0 to 100% in ~0.5s (1000 * 12 / 25kHz)
+
 void Motor_Init(void);
-void Motor_SetState(uint8_t state); // 1 = ON, 0 = OFF
+void Motor_SetState(uint8_t state);   // 1 = ON (ramped), 0 = OFF (immediate)
+void Motor_SetDuty(uint16_t duty);    // 0 - MOTOR_DUTY_MAX, soft-start ramp
+uint16_t Motor_GetDuty(void);         // Duty currently applied to PWM5
 
 #endif
@@ -0,0 +1,73 @@
+/*
+ * File        : perf_probe.c
+ * Description : Cycle profile of the Monitor Mode loop.
+ *
+ * NOTES:
+ * PERF_MARK(PERF_MONITOR_LOOP) at the top of each iteration samples the
+ * Timer1 cycle counter and the Idle-mode total from cpu_idle(). Each
+ * window of PERF_WINDOW iterations yields the mean period and the busy
+ * cycles (period minus Idle time). ISRs that run right after a wake-up
+ * are counted as idle. A gap of more than one second (Monitor Mode left
+ * and re-entered) is not sampled.
+ *
+ * UART 'P' prints the last window together with the MAM and power mode,
+ * so builds with PERF_PROFILE = 0 / 1 can be compared directly.
+ */
+
+#include <LPC214X.h>
+#include <stdio.h>
+#include "perf_probe.h"
+#include "system_init.h"
+#include "uart_driver.h"
+
+static uint8_t  armed = 0;
+static uint32_t last_cycles, last_idle;
+static uint32_t n = 0, sum_cycles = 0, sum_idle = 0;
+
+// Last complete window (per iteration)
+static uint32_t win_cycles = 0, win_busy = 0;
+
+void Perf_Mark(uint8_t id)
+{
+    uint32_t now = CYCLES_NOW();
+    uint32_t idle = idle_cycles;
+    uint32_t dt = now - last_cycles;
+
+    if(id != PERF_MONITOR_LOOP) return;
+
+    if(armed && dt < PCLK_HZ)
+    {
+        sum_cycles += dt;
+        sum_idle   += idle - last_idle;
+
+        if(++n == PERF_WINDOW) {
+            win_cycles = sum_cycles / PERF_WINDOW;
+            win_busy   = (sum_cycles - sum_idle) / PERF_WINDOW;
+            n = 0; sum_cycles = 0; sum_idle = 0;
+        }
+    }
+
+    armed = 1;
+    last_cycles = now;
+    last_idle = idle;
+}
+
+void Perf_Report(void)
+{
+    char buf[64];
+    uint32_t load_x10 = win_cycles ? (uint32_t)(((uint64_t)win_busy * 1000) / win_cycles) : 0;
+
+    UART_SendString("\r\n--- MONITOR LOOP PROFILE ---\r\n");
+    if(win_cycles == 0) {
+        UART_SendString("No data: run Monitor Mode first.\r\n");
+        return;
+    }
+    sprintf(buf, "Period: %lu cycles\r\n", (unsigned long)win_cycles);
+    UART_SendString(buf);
+    sprintf(buf, "Busy  : %lu cycles (%lu.%lu%% load)\r\n", (unsigned long)win_busy,
+            (unsigned long)(load_x10 / 10), (unsigned long)(load_x10 % 10));
+    UART_SendString(buf);
+    sprintf(buf, "MAMCR %lu MAMTIM %lu, power %s\r\n", (unsigned long)MAMCR, (unsigned long)MAMTIM,
+            power_get_mode() == POWER_IDLE ? "IDLE" : "RUN");
+    UART_SendString(buf);
+}
@@ -0,0 +1,20 @@
+#ifndef PERF_PROBE_H
+#define PERF_PROBE_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- Probe Points ---
+#define PERF_MONITOR_LOOP    0x01   // Top of each Monitor Mode iteration
+
+#define PERF_WINDOW          32     // Iterations averaged per report
+
+void Perf_Mark(uint8_t id);
+void Perf_Report(void);             // Last complete window over UART
+
+// The host simulator's LPC214X.h wraps PERF_MARK to timestamp marks too
+#ifndef PERF_MARK
+#define PERF_MARK(id)        Perf_Mark(id)
+#endif
+
+#endif
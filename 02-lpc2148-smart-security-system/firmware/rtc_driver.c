@@ -0,0 +1,62 @@
+/*
+ * File        : rtc_driver.c
+ * Description : On-chip RTC driver (1Hz timebase for alert timing).
+ *
+ * NOTES:
+ * The RTC is clocked from PCLK through the reference prescaler
+ * (PREINT/PREFRAC) so no 32kHz crystal is required. The counter
+ * increment interrupt (CIIR.IMSEC) fires once per second and advances
+ * a monotonic seconds count, independent of LCD/keypad/UART blocking.
+ */
+
+#include <LPC214X.h>
+#include "rtc_driver.h"
+#include "system_init.h"
+#include "vic.h"
+
+static volatile uint32_t rtc_seconds = 0;
+
+void RTC_ISR(void) __irq
+{
+    rtc_seconds++;
+    ILR = (1 << 0);                 // Clear counter increment flag (RTCCIF)
+    VICVectAddr = 0;                // Acknowledge interrupt
+}
+
+void RTC_Init(void)
+{
+    CCR = 0x00;                     // Stop RTC while configuring
+
+    // Reference clock from PCLK: 60MHz / 32768 = 1831.05
+    // PREINT  = int(PCLK / 32768) - 1 = 1830
+    // PREFRAC = PCLK - (PREINT + 1) * 32768 = 1792
+    PREINT  = (PCLK_HZ / 32768) - 1;
+    PREFRAC = PCLK_HZ - ((PCLK_HZ / 32768) * 32768);
+
+    // Time registers are undefined after first power-up: sanitise
+    if(SEC > 59 || MIN > 59 || HOUR > 23) {
+        SEC = 0; MIN = 0; HOUR = 0;
+    }
+
+    AMR  = 0xFF;                    // Alarms masked
+    CIIR = (1 << 0);                // Interrupt on every seconds increment
+    ILR  = 0x03;                    // Clear pending flags
+
+    VIC_Install(VIC_SLOT_RTC, VIC_CH_RTC, (unsigned long)RTC_ISR);
+
+    CCR = (1 << 0);                 // CLKEN = 1, CLKSRC = 0 (PCLK prescaler)
+}
+
+uint32_t RTC_GetSeconds(void)
+{
+    return rtc_seconds;             // 32-bit read is atomic on ARM7
+}
+
+void RTC_GetTime(RTC_Time *t)
+{
+    uint32_t ct = CTIME0;           // Consolidated: SEC[5:0] MIN[13:8] HOUR[20:16]
+
+    t->sec  = ct & 0x3F;
+    t->min  = (ct >> 8) & 0x3F;
+    t->hour = (ct >> 16) & 0x1F;
+}
@@ -0,0 +1,17 @@
+#ifndef RTC_DRIVER_H
+#define RTC_DRIVER_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+} RTC_Time;
+
+void RTC_Init(void);
+uint32_t RTC_GetSeconds(void);      // Seconds since RTC_Init (1Hz interrupt)
+void RTC_GetTime(RTC_Time *t);      // Time of day from CTIME0 (single read)
+
+#endif
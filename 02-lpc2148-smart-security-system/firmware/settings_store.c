@@ -0,0 +1,227 @@
+/*
+ * File        : settings_store.c
+ * Description : Wear-levelled key/value settings in on-chip flash (IAP).
+ *
+ * LAYOUT:
+ * Two 4KB sectors (25 and 26, 0x7B000 - 0x7CFFF) are reserved for settings
+ * (see iap_flash.h). Each sector holds up to 256 fixed 16-byte records
+ * (one ECC line each):
+ *
+ *   [key:1][len:1][seq:2][value:10][crc16:2]
+ *
+ * A change appends one record to the active sector; nothing is erased.
+ * When the active sector is full, the newest value of every key is copied
+ * into the other sector (compaction) and that becomes active. The old
+ * sector is erased later from Settings_Service(), so a write never costs
+ * more than one 256-byte page program (~1ms) in the normal case.
+ *
+ * ECC: the flash keeps one ECC word per 16-byte line, and a programmed
+ * line must never be programmed again. IAP writes whole 256-byte pages,
+ * so an append stages a page of 0xFF with only the new record in it:
+ * all-0xFF lines are left untouched by the program cycle.
+ *
+ * ERASE BUDGET: a sector erase is a single IAP call of up to 400ms with
+ * every VIC source masked (no UART RX, no tick). It cannot be split, so
+ * Settings_Service() only starts it when the menu loop is idle, the
+ * console RX ring is empty and no byte has arrived for
+ * SETTINGS_ERASE_QUIET_MS. A host that starts sending during the erase
+ * still loses everything beyond the 16-byte RX FIFO. Compaction erases
+ * inline only if the deferred erase never found a quiet window.
+ *
+ * Boot reads the first record of each sector to pick the one with the
+ * newest sequence number, then scans that sector once, keeping the last
+ * valid record per key. Torn writes fail the CRC and are skipped.
+ *
+ * Flash access goes through iap_flash.c, which masks interrupts
+ * around every IAP call.
+ */
+
+#include <LPC214X.h>
+#include <string.h>
+#include "settings_store.h"
+#include "crc16.h"
+#include "iap_flash.h"
+#include "uart_driver.h"
+
+#define SETTINGS_SECTOR_SIZE  FLASH_SECTOR_SIZE
+#define SETTINGS_PAGE_SIZE    FLASH_PAGE_SIZE
+#define SETTINGS_REC_SIZE     16
+#define SETTINGS_REC_COUNT    (SETTINGS_SECTOR_SIZE / SETTINGS_REC_SIZE)
+#define SETTINGS_REC_PER_PAGE (SETTINGS_PAGE_SIZE / SETTINGS_REC_SIZE)
+#define SETTINGS_KEY_BLANK    0xFF
+#define SETTINGS_ERASE_QUIET_MS 2000  // RX silence before a deferred erase
+
+typedef struct {
+    uint8_t  key;
+    uint8_t  len;
+    uint16_t seq;
+    uint8_t  value[SETTING_VALUE_MAX];
+    uint16_t crc;
+} Settings_Record;
+
+static const uint8_t  settings_sector[2] = { FLASH_SETTINGS_SECTOR, FLASH_SETTINGS_SECTOR + 1 };
+static const uint32_t settings_base[2]   = { FLASH_SETTINGS_BASE,
+                                             FLASH_SETTINGS_BASE + FLASH_SECTOR_SIZE };
+
+// RAM cache of the newest value per key (len 0 = not stored)
+static struct {
+    uint8_t len;
+    uint8_t value[SETTING_VALUE_MAX];
+} cache[SETTING_KEY_COUNT];
+
+static uint8_t  active = 0;           // Active sector index (0/1)
+static uint16_t next_slot = 0;        // First blank record in active sector
+static uint16_t seq_counter = 0;      // Sequence of the newest record
+static uint8_t  other_dirty = 0;      // Inactive sector still needs erasing
+
+// IAP requires a word-aligned RAM source buffer
+static unsigned long page_buf[SETTINGS_PAGE_SIZE / 4];
+
+static const Settings_Record *Settings_Slot(uint8_t sector, uint16_t slot)
+{
+    return (const Settings_Record *)IAP_FLASH_PTR(settings_base[sector] + slot * SETTINGS_REC_SIZE);
+}
+
+static uint16_t Settings_RecordCrc(const Settings_Record *rec)
+{
+    return CRC16_Update(CRC16_INIT, (const uint8_t *)rec, SETTINGS_REC_SIZE - 2);
+}
+
+static uint8_t Settings_RecordValid(const Settings_Record *rec)
+{
+    return rec->key != SETTINGS_KEY_BLANK &&
+           rec->key < SETTING_KEY_COUNT &&
+           rec->len <= SETTING_VALUE_MAX &&
+           rec->crc == Settings_RecordCrc(rec);
+}
+
+static uint8_t Settings_Erase(uint8_t sector)
+{
+    return IAP_EraseSector(settings_sector[sector]);
+}
+
+static uint8_t Settings_ProgramPage(uint8_t sector, uint16_t page)
+{
+    return IAP_ProgramPage(settings_sector[sector],
+                           settings_base[sector] + page * SETTINGS_PAGE_SIZE, page_buf);
+}
+
+static void Settings_BuildRecord(Settings_Record *rec, uint8_t key)
+{
+    memset(rec, 0xFF, SETTINGS_REC_SIZE);
+    rec->key = key;
+    rec->len = cache[key].len;
+    rec->seq = ++seq_counter;
+    memcpy(rec->value, cache[key].value, cache[key].len);
+    rec->crc = Settings_RecordCrc(rec);
+}
+
+static uint8_t Settings_Append(uint8_t key)
+{
+    uint16_t page = next_slot / SETTINGS_REC_PER_PAGE;
+    Settings_Record *rec;
+
+    // Only the new record's line is programmed: every other line of the
+    // page stays 0xFF, which leaves programmed lines (and their ECC) alone
+    memset(page_buf, 0xFF, SETTINGS_PAGE_SIZE);
+    rec = (Settings_Record *)page_buf + (next_slot % SETTINGS_REC_PER_PAGE);
+    Settings_BuildRecord(rec, key);
+
+    if(!Settings_ProgramPage(active, page)) return 0;
+
+    next_slot++;
+    return 1;
+}
+
+static uint8_t Settings_Compact(void)
+{
+    uint8_t target = active ^ 1;
+    uint8_t key;
+    uint16_t count = 0;
+
+    // Normally already erased by Settings_Service()
+    if(other_dirty) {
+        if(!Settings_Erase(target)) return 0;
+        other_dirty = 0;
+    }
+
+    // All live keys fit in one page (SETTING_KEY_COUNT <= 16)
+    memset(page_buf, 0xFF, SETTINGS_PAGE_SIZE);
+    for(key = 1; key < SETTING_KEY_COUNT; key++) {
+        if(cache[key].len == 0) continue;
+        Settings_BuildRecord((Settings_Record *)page_buf + count, key);
+        count++;
+    }
+
+    if(!Settings_ProgramPage(target, 0)) return 0;
+
+    active      = target;
+    next_slot   = count;
+    other_dirty = 1;
+    return 1;
+}
+
+void Settings_Load(void)
+{
+    const Settings_Record *head0 = Settings_Slot(0, 0);
+    const Settings_Record *head1 = Settings_Slot(1, 0);
+    const Settings_Record *rec;
+    uint8_t valid0 = Settings_RecordValid(head0);
+    uint8_t valid1 = Settings_RecordValid(head1);
+    uint16_t slot;
+
+    memset(cache, 0, sizeof(cache));
+
+    // 1. Pick the sector whose first record is newest (wrap-safe compare)
+    if(valid0 && valid1) active = ((int16_t)(head1->seq - head0->seq) > 0) ? 1 : 0;
+    else active = valid1 ? 1 : 0;
+
+    if(!valid0 && !valid1 && head0->key != SETTINGS_KEY_BLANK) {
+        Settings_Erase(0);  // Unformatted / corrupt area
+    }
+
+    // 2. Single scan: later records override earlier ones
+    for(slot = 0; slot < SETTINGS_REC_COUNT; slot++)
+    {
+        rec = Settings_Slot(active, slot);
+        if(rec->key == SETTINGS_KEY_BLANK) break;
+        if(!Settings_RecordValid(rec)) continue;   // Torn write
+
+        cache[rec->key].len = rec->len;
+        memcpy(cache[rec->key].value, rec->value, rec->len);
+        seq_counter = rec->seq;
+    }
+    next_slot = slot;
+
+    // 3. Inactive sector holds stale data until erased
+    other_dirty = (Settings_Slot(active ^ 1, 0)->key != SETTINGS_KEY_BLANK);
+}
+
+uint8_t Settings_Get(uint8_t key, void *value, uint8_t len)
+{
+    if(key == 0 || key >= SETTING_KEY_COUNT || cache[key].len == 0) return 0;
+    if(len > cache[key].len) len = cache[key].len;
+    memcpy(value, cache[key].value, len);
+    return 1;
+}
+
+uint8_t Settings_Set(uint8_t key, const void *value, uint8_t len)
+{
+    if(key == 0 || key >= SETTING_KEY_COUNT || len == 0 || len > SETTING_VALUE_MAX) return 0;
+
+    // Unchanged value: no flash wear
+    if(cache[key].len == len && memcmp(cache[key].value, value, len) == 0) return 1;
+
+    cache[key].len = len;
+    memcpy(cache[key].value, value, len);
+
+    if(next_slot >= SETTINGS_REC_COUNT) return Settings_Compact();
+    return Settings_Append(key);
+}
+
+void Settings_Service(void)
+{
+    // Masks every IRQ for up to 400ms: only while the link is quiet
+    if(!other_dirty || !UART_RxIdle(SETTINGS_ERASE_QUIET_MS)) return;
+    if(Settings_Erase(active ^ 1)) other_dirty = 0;
+}
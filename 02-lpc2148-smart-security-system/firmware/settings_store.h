@@ -0,0 +1,21 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- Setting Keys ---
+#define SETTING_PASSWORD     0x01   // char[10], NUL terminated
+#define SETTING_THRESHOLD    0x02   // uint8_t, C
+#define SETTING_CAL_GAIN     0x03   // int16_t, Q12
+#define SETTING_CAL_OFFSET   0x04   // int16_t, 0.1 C
+#define SETTING_KEY_COUNT    5      // Keys are 1 .. SETTING_KEY_COUNT-1
+
+#define SETTING_VALUE_MAX    10     // Max value bytes per record
+
+void Settings_Load(void);                                       // Boot: scan flash once
+uint8_t Settings_Get(uint8_t key, void *value, uint8_t len);    // 1 = found
+uint8_t Settings_Set(uint8_t key, const void *value, uint8_t len); // 1 = stored
+void Settings_Service(void);                                    // Idle: deferred erase (RX quiet)
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * File: smart_security.c
- * Description: Main application with PWM Motor Control & Stopwatch Timer.
+ * Description: Main application with PI/PWM Fan Control & RTC Alert Stopwatch.
  * Author: Vishnu Rach K R
  *
  * SIMULATION NOTE:
@@ -8,6 +8,8 @@
  * visually present in the simulation window but disconnected from the MCU 
  * to prevent instability caused by mixed-signal conflicts (ADC/PWM vs LCD).
  * The firmware logic remains fully functional for hardware deployment.
+ * Set TEMP_SIM_KEYPAD to 0 on hardware to read the calibrated LM35 value
+ * from the burst-mode ADC instead of the keypad +/- simulation.
  */
 
 #include <LPC214X.h>
@@ -19,11 +21,27 @@
 #include "uart_driver.h"
 #include "adc_driver.h"
 #include "motor_driver.h" 
+#include "fan_control.h"
+#include "rtc_driver.h"
+#include "settings_store.h"
+#include "event_log.h"
+#include "perf_probe.h"
+#include "gpio_bench.h"
+#include "spi_flash.h"
+#include "uart_protocol.h"
+#include "vic.h"
+
+// 1 = Keypad +/- simulates temperature (Proteus), 0 = LM35 via ADC
+#ifndef TEMP_SIM_KEYPAD
+#define TEMP_SIM_KEYPAD   1
+#endif
 
 // --- Global System Variables ---
 char current_password[10] = "1234";
 uint8_t current_state = 0;
 uint8_t temp_threshold = 35; 
+int16_t adc_cal_gain   = ADC_CAL_GAIN_UNITY;
+int16_t adc_cal_offset = ADC_CAL_OFFSET_ZERO;
 
 void Run_Settings_Mode(void)
 {
@@ -42,6 +60,8 @@ void Run_Settings_Mode(void)
         do {
             key = KEYPAD_Read();
             if(key == 'C') return; 
+            Protocol_Service();
+            cpu_idle();
         } while(key != '1' && key != '2');
         
         if(key == '1')
@@ -60,7 +80,11 @@ void Run_Settings_Mode(void)
                 UART_SendString("\r\nEnter New Password: ");
                 input_str = UART_ReceiveString();
                 
-                strcpy(current_password, input_str);
+                // Max 9 chars (+NUL) fits one settings record
+                strncpy(current_password, input_str, sizeof(current_password) - 1);
+                current_password[sizeof(current_password) - 1] = '\0';
+                Settings_Set(SETTING_PASSWORD, current_password, strlen(current_password) + 1);
+                EventLog_Add(EVT_PASSWORD_CHANGE, ADC_GetTemperature());
                 
                 UART_SendString("\r\nPassword Changed Successfully!\r\n");
                 LCD_SendCommand(LCD_CMD_ROW_2);
@@ -97,65 +121,129 @@ void Run_Settings_Mode(void)
                 else if(key == '=') {
                     LCD_SendCommand(LCD_CMD_CLEAR);
                     LCD_SendString("Limit Saved.");
+                    Settings_Set(SETTING_THRESHOLD, &temp_threshold, 1);
+                    EventLog_Add(EVT_THRESHOLD_SET, ADC_GetTemperature());
                     delayms(1000);
                     break; 
                 }
                 else if(key == 'C') break; 
+                else { Protocol_Service(); cpu_idle(); }
             }
         }
     }
 }
 
+/**
+ * @brief Restores persisted settings; defaults stay for keys never saved.
+ */
+static void Load_Settings(void)
+{
+    Settings_Load();
+    Settings_Get(SETTING_PASSWORD, current_password, sizeof(current_password));
+    current_password[sizeof(current_password) - 1] = '\0';
+    Settings_Get(SETTING_THRESHOLD, &temp_threshold, 1);
+    Settings_Get(SETTING_CAL_GAIN, &adc_cal_gain, 2);
+    Settings_Get(SETTING_CAL_OFFSET, &adc_cal_offset, 2);
+}
+
+/**
+ * @brief Prints "[hh:mm:ss] <msg>" using the RTC time of day.
+ */
+static void Alert_LogEvent(char *msg, int16_t temp_val)
+{
+    RTC_Time now;
+    char buf[48];
+    char temp[ADC_TEMP_TEXT];
+
+    RTC_GetTime(&now);
+    sprintf(buf, "\r\n[%02d:%02d:%02d] %s T=%s C\r\n", now.hour, now.min, now.sec,
+            msg, ADC_FormatTemp(temp, temp_val));
+    UART_SendString(buf);
+}
+
+/**
+ * @brief Redraws a terminal field, sending only the characters that changed.
+ *        Backspaces to the first differing character and rewrites the tail.
+ */
+static void Alert_UpdateField(char *shown, char *next)
+{
+    int k = 0, i;
+
+    while(shown[k] != '\0' && shown[k] == next[k]) k++;
+    for(i = k; shown[i] != '\0'; i++) UART_SendChar('\b');
+    UART_SendString(&next[k]);
+    strcpy(shown, next);
+}
+
 /**
  * @brief Monitor Mode: Controls Fan (Motor) based on Temperature.
  */
 void Run_Monitor_Mode(void)
 {
-    unsigned int temp_val = 25; 
+    int16_t temp_val = 250;      // Temperature in 0.1 C
+    int16_t limit;               // Threshold in 0.1 C
     char buffer[32];   
+    char temp[ADC_TEMP_TEXT];
     char key;
     uint8_t update_screen = 1;
+    uint16_t duty;
+    uint8_t fan_pct = 0;         // Fan speed shown on LCD (%)
     
-    // Stopwatch Vars
-    char timer_arr[20] = {'\0'};
-    int i, s = 0, m = 0, h = 0;
-    int tick_count = 0; 
+    // Stopwatch Vars (RTC timebase)
+    char timer_arr[16] = {'\0'};   // Duration currently shown on terminal
+    char next_arr[16];
+    uint8_t alert_active = 0;
+    uint32_t alert_start = 0;
+    uint32_t elapsed, last_elapsed = 0;
 
     LCD_SendCommand(LCD_CMD_CLEAR);
     LCD_SendString("Monitor Active");
     delayms(1000);
 
     UART_SendString("\r\n--- MONITOR START ---\r\n");
+    FanControl_Reset();
 
     while(1)
     {
-        // 1. Simulate Temp Input (Using Keypad)
+        PERF_MARK(PERF_MONITOR_LOOP);
+        limit = (int16_t)temp_threshold * 10;
+
+        // 1. Temperature Input
         key = KEYPAD_Read();
-        if(key == '+') { if(temp_val < 99) temp_val++; update_screen = 1; }
-        else if(key == '-') { if(temp_val > 0) temp_val--; update_screen = 1; }
-        else if(key == 'C') { 
+#if TEMP_SIM_KEYPAD
+        // Simulated (Using Keypad), 1 C per press
+        if(key == '+') { if(temp_val < 990) temp_val += 10; update_screen = 1; }
+        else if(key == '-') { if(temp_val > 0) temp_val -= 10; update_screen = 1; }
+#else
+        // Hottest zone of the latest scan, no conversion wait
+        {
+            int16_t t = ADC_GetTemperature();
+            if(t != temp_val) { temp_val = t; update_screen = 1; }
+        }
+#endif
+        if(key == 'C') { 
             Motor_SetState(0); // SAFETY: Turn off motor before exiting
+            Protocol_SetStatus(temp_val, 0);
             return; 
         }
 
-        // 2. Logic: Motor Control (PWM)
-        if(temp_val > temp_threshold) {
-            Motor_SetState(1); // TURN MOTOR ON (PWM Active)
-        } else {
-            Motor_SetState(0); // TURN MOTOR OFF
-        }
+        // 2. Logic: Motor Control (PI -> PWM duty, ramped in PWM ISR)
+        duty = FanControl_Update(temp_val, limit);
+        Motor_SetDuty(duty);
+        if(duty / 10 != fan_pct) { fan_pct = duty / 10; update_screen = 1; }
 
         // 3. Screen Update
         if(update_screen)
         {
             LCD_SendCommand(LCD_CMD_CLEAR);
             LCD_SendString("Temp: ");
-            sprintf(buffer, "%d C", temp_val); 
+            sprintf(buffer, "%s C", ADC_FormatTemp(temp, temp_val));
             LCD_SendString(buffer);
             
             LCD_SendCommand(LCD_CMD_ROW_2);
-            if(temp_val > temp_threshold) { 
-                LCD_SendString("FAN: ON       ");
+            if(fan_pct > 0) { 
+                sprintf(buffer, "FAN: %3d%%      ", fan_pct);
+                LCD_SendString(buffer);
             } else {
                 LCD_SendString("FAN: OFF      ");
             }
@@ -163,44 +251,91 @@ void Run_Monitor_Mode(void)
         }
 
         // 4. Stopwatch Logic (Only counts when Over-Temp)
-        if(temp_val > temp_threshold)
+        if(temp_val > limit)
         {
-            tick_count++;
-            if(tick_count >= 20) // 1 Second (approx)
-            {
-                s++;
-                // Clear previous time on terminal
-                for(i=0; timer_arr[i]!='\0'; i++) UART_SendChar('\b');
-                
-                if(s > 59) { m++; s=0; if(m > 59) { h++; s=0; m=0; } }
-                
-                sprintf(timer_arr, "Alert: %d:%d:%d", h, m, s);
+            if(!alert_active) {
+                alert_active = 1;
+                alert_start  = RTC_GetSeconds();
+                last_elapsed = 0;
+                Alert_LogEvent("ALERT START", temp_val);
+                EventLog_Add(EVT_ALERT_START, temp_val);
+                UART_SendString("Alert: ");
+                strcpy(timer_arr, "00:00:00");
                 UART_SendString(timer_arr);
-                
-                tick_count = 0; 
+            }
+
+            elapsed = RTC_GetSeconds() - alert_start;
+            if(elapsed != last_elapsed)
+            {
+                sprintf(next_arr, "%02lu:%02lu:%02lu", (unsigned long)(elapsed / 3600),
+                        (unsigned long)((elapsed / 60) % 60), (unsigned long)(elapsed % 60));
+                Alert_UpdateField(timer_arr, next_arr);
+                last_elapsed = elapsed;
             }
         }
-        else
+        else if(alert_active)
         {
-            // Reset timer when temp is normal
-            if(s!=0 || m!=0 || h!=0) {
-                UART_SendString("\r\nNormal Temp. Timer Reset.\r\n");
-                s=0; m=0; h=0; timer_arr[0]='\0';
-            }
-            tick_count = 0;
+            // Temperature back to normal: close the alert
+            alert_active = 0;
+            Alert_LogEvent("ALERT END", temp_val);
+            EventLog_Add(EVT_ALERT_END, temp_val);
+            UART_SendString("Duration: ");
+            UART_SendString(timer_arr);
+            UART_SendString("\r\n");
+            timer_arr[0] = '\0';
         }
 
+        // 5. Remote commands (binary protocol)
+        Protocol_SetStatus(temp_val, PROTO_FLAG_MONITOR | (alert_active ? PROTO_FLAG_ALERT : 0));
+        Protocol_Service();
+
         delayms(50); // Loop Pacing
     }
 }
 
+/**
+ * @brief Diagnostic UART commands (menu idle): L = CSV dump,
+ *        B = binary dump, F = flush to flash, G = GPIO benchmark,
+ *        S = SPI flash benchmark, V = IRQ latency, A = ADC scan,
+ *        P = monitor loop profile, I = toggle Idle power mode.
+ *        Auto-flushes a full page of the event log.
+ */
+void Run_Uart_Command(void)
+{
+    int cmd = UART_PollChar();
+
+    if(cmd == 'L') EventLog_DumpCSV();
+    else if(cmd == 'B') EventLog_DumpBinary();
+    else if(cmd == 'F') {
+        UART_SendString(EventLog_Flush() ? "\r\nLog Flushed.\r\n" : "\r\nFlush Failed.\r\n");
+    }
+    else if(cmd == 'G') GPIO_Benchmark();
+    else if(cmd == 'S') SPIFlash_Benchmark();
+    else if(cmd == 'V') VIC_Report();
+    else if(cmd == 'A') ADC_Report();
+    else if(cmd == 'P') Perf_Report();
+    else if(cmd == 'I') {
+        power_mode(power_get_mode() == POWER_IDLE ? POWER_RUN : POWER_IDLE);
+        UART_SendString(power_get_mode() == POWER_IDLE ? "\r\nPower: IDLE\r\n" : "\r\nPower: RUN\r\n");
+    }
+
+    if(EventLog_Count() >= EVENT_LOG_FLUSH_LVL) EventLog_FlushIdle();
+}
+
 int main(void) 
 {       
     uint8_t menu_stage = 0; 
     char key;
 
     pll();          
+    fast_gpio();      // Before LCD / keypad pin setup
+    Load_Settings();  // Before any IRQ source is enabled
+    tick_init();      // delayms() needs the tick
+    RTC_Init();     
+    EventLog_Init();
+    EventLog_Add(EVT_BOOT, 0);
     UART_Init();    
+    SPIFlash_Init();
     LCD_Init();     
     KEYPAD_Init();  
     ADC_Init();     
@@ -220,9 +355,13 @@ int main(void)
             menu_stage = 2; 
         }
         else if(menu_stage == 2) {
+            Settings_Service(); // Deferred flash erase while idle in menu
+            Protocol_Service();
+            Run_Uart_Command();
             key = KEYPAD_Read();
             if(key == '1') { Run_Monitor_Mode(); menu_stage = 1; }
             else if(key == '2') { Run_Settings_Mode(); menu_stage = 1; }
+            else cpu_idle();  // Sleep until the next tick / IRQ
         }
     }
 }
@@ -0,0 +1,237 @@
+/*
+ * File        : spi_flash.c
+ * Description : 25-series SPI NOR flash block driver on the SSP.
+ *
+ * NOTES:
+ * Every operation is a chip-select transaction on the SSP driver: a
+ * short command header (polled, CS kept asserted) followed by the data
+ * phase, which goes through the interrupt-driven queue once it is at
+ * least SSP_IRQ_MIN bytes long. Reads use FAST_READ (one dummy byte) so
+ * the bus can run at the SSP maximum of PCLK / 2.
+ *
+ * Program and erase return only when the chip reports ready (WIP
+ * clear), so a following read never sees a busy chip. Status polling
+ * waits in Idle mode between polls. Programs are split at 256-byte page
+ * boundaries; like the on-chip flash, bits can only be cleared.
+ */
+
+#include <LPC214X.h>
+#include <stdio.h>
+#include <string.h>
+#include "spi_flash.h"
+#include "ssp_driver.h"
+#include "system_init.h"
+#include "uart_driver.h"
+
+static uint32_t flash_id = 0;
+
+static void SPIFlash_Cmd(const uint8_t *tx, uint8_t *rx, uint16_t len, uint8_t flags)
+{
+    SSP_Xfer x;
+
+    x.cs    = SPIFLASH_CS;
+    x.tx    = tx;
+    x.rx    = rx;
+    x.len   = len;
+    x.flags = flags;
+    SSP_Run(&x);
+}
+
+static void SPIFlash_Header(uint8_t *hdr, uint8_t cmd, uint32_t addr)
+{
+    hdr[0] = cmd;
+    hdr[1] = (uint8_t)(addr >> 16);
+    hdr[2] = (uint8_t)(addr >> 8);
+    hdr[3] = (uint8_t)addr;
+    hdr[4] = 0xFF;                      // FAST_READ dummy byte
+}
+
+static uint8_t SPIFlash_WaitReady(uint16_t timeout_ms)
+{
+    uint8_t cmd[2], sr[2];
+    uint32_t start = sys_ticks;
+
+    cmd[0] = SPIFLASH_CMD_RDSR;
+    cmd[1] = 0xFF;
+
+    while(1)
+    {
+        SPIFlash_Cmd(cmd, sr, 2, 0);
+        if(!(sr[1] & SPIFLASH_SR_WIP)) return 1;
+        if((uint32_t)(sys_ticks - start) > timeout_ms) return 0;
+        cpu_idle();
+    }
+}
+
+static void SPIFlash_WriteEnable(void)
+{
+    uint8_t cmd = SPIFLASH_CMD_WREN;
+
+    SPIFlash_Cmd(&cmd, 0, 1, 0);
+}
+
+uint32_t SPIFlash_Init(void)
+{
+    uint8_t cmd[4], id[4];
+
+    SSP_Init(SPIFLASH_HZ, SSP_MODE0, 8);
+    SSP_CSInit(SPIFLASH_CS);
+
+    memset(cmd, 0xFF, sizeof(cmd));
+    cmd[0] = SPIFLASH_CMD_JEDEC_ID;
+    SPIFlash_Cmd(cmd, id, 4, 0);
+
+    // Manufacturer, memory type, capacity; all 0s / 1s = nothing on the bus
+    flash_id = ((uint32_t)id[1] << 16) | ((uint32_t)id[2] << 8) | id[3];
+    if(flash_id == 0xFFFFFF) flash_id = 0;
+    return flash_id;
+}
+
+uint32_t SPIFlash_Size(void)
+{
+    uint8_t cap = flash_id & 0xFF;      // log2(bytes)
+
+    if(!flash_id || cap < 16 || cap > 28) return 0;
+    return 1UL << cap;
+}
+
+uint8_t SPIFlash_Read(uint32_t addr, uint8_t *buf, uint16_t len)
+{
+    uint8_t hdr[5];
+
+    if(!flash_id) return 0;
+
+    SPIFlash_Header(hdr, SPIFLASH_CMD_FAST_READ, addr);
+    SPIFlash_Cmd(hdr, 0, 5, SSP_KEEP_CS);
+    SPIFlash_Cmd(0, buf, len, 0);
+    return 1;
+}
+
+uint8_t SPIFlash_Program(uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    uint8_t hdr[5];
+    uint16_t n;
+
+    if(!flash_id) return 0;
+
+    while(len)
+    {
+        // Stay inside one page: the chip wraps at the page boundary
+        n = SPIFLASH_PAGE_SIZE - (addr & (SPIFLASH_PAGE_SIZE - 1));
+        if(n > len) n = len;
+
+        SPIFlash_WriteEnable();
+        SPIFlash_Header(hdr, SPIFLASH_CMD_PP, addr);
+        SPIFlash_Cmd(hdr, 0, 4, SSP_KEEP_CS);
+        SPIFlash_Cmd(data, 0, n, 0);
+        if(!SPIFlash_WaitReady(SPIFLASH_PP_MS)) return 0;
+
+        addr += n;
+        data += n;
+        len  -= n;
+    }
+    return 1;
+}
+
+uint8_t SPIFlash_EraseSector(uint32_t addr)
+{
+    uint8_t hdr[5];
+
+    if(!flash_id) return 0;
+
+    SPIFlash_WriteEnable();
+    SPIFlash_Header(hdr, SPIFLASH_CMD_SE, addr & ~(SPIFLASH_SECTOR_SIZE - 1UL));
+    SPIFlash_Cmd(hdr, 0, 4, 0);
+    return SPIFlash_WaitReady(SPIFLASH_SE_MS);
+}
+
+// ============================================================
+// Benchmark (UART 'S')
+// ============================================================
+
+static uint8_t bench_buf[SPIFLASH_BENCH_SIZE];
+
+static uint8_t Bench_Pattern(uint16_t i)
+{
+    return (uint8_t)(i * 7 + 3);
+}
+
+static void Bench_Report(char *name, uint32_t cycles, uint32_t busy)
+{
+    char line[64];
+    uint8_t ok = 1;
+    uint16_t i;
+
+    for(i = 0; i < SPIFLASH_BENCH_SIZE; i++) {
+        if(bench_buf[i] != Bench_Pattern(i)) ok = 0;
+    }
+
+    sprintf(line, "%s: %lu cyc, %lu busy, %lu kB/s %s\r\n", name,
+            (unsigned long)cycles, (unsigned long)busy,
+            (unsigned long)((SPIFLASH_BENCH_SIZE * (CCLK_HZ / 1000)) / (cycles ? cycles : 1)),
+            ok ? "OK" : "BAD");
+    UART_SendString(line);
+}
+
+static void Bench_ReadStart(uint32_t addr)
+{
+    uint8_t hdr[5];
+
+    memset(bench_buf, 0, sizeof(bench_buf));
+    SPIFlash_Header(hdr, SPIFLASH_CMD_FAST_READ, addr);
+    SSP_Select(SPIFLASH_CS);
+    SSP_Transfer(hdr, 0, 5);
+}
+
+void SPIFlash_Benchmark(void)
+{
+    char line[48];
+    uint32_t addr, t, idle;
+    uint16_t i;
+    uint8_t ok;
+
+    UART_SendString("\r\n--- SPI FLASH ---\r\n");
+    if(!flash_id) { UART_SendString("No SPI flash.\r\n"); return; }
+
+    sprintf(line, "JEDEC %06lX, %lu KB\r\n", (unsigned long)flash_id, (unsigned long)(SPIFlash_Size() / 1024));
+    UART_SendString(line);
+
+    addr = SPIFLASH_SCRATCH_ADDR;
+
+    t = sys_ticks;
+    ok = SPIFlash_EraseSector(addr);
+    sprintf(line, "Erase 4KB     : %lu ms %s\r\n", (unsigned long)(sys_ticks - t), ok ? "OK" : "FAIL");
+    UART_SendString(line);
+
+    for(i = 0; i < SPIFLASH_BENCH_SIZE; i++) bench_buf[i] = Bench_Pattern(i);
+    t = CYCLES_NOW();
+    ok = SPIFlash_Program(addr, bench_buf, SPIFLASH_BENCH_SIZE);
+    t = CYCLES_NOW() - t;
+    sprintf(line, "Program 1KB   : %lu us %s\r\n", (unsigned long)(t / (CCLK_HZ / 1000000)), ok ? "OK" : "FAIL");
+    UART_SendString(line);
+
+    // 1. One frame per register round trip (no FIFO use)
+    Bench_ReadStart(addr);
+    t = CYCLES_NOW();
+    for(i = 0; i < SPIFLASH_BENCH_SIZE; i++) bench_buf[i] = (uint8_t)SSP_Exchange(0xFF);
+    t = CYCLES_NOW() - t;
+    SSP_Deselect(SPIFLASH_CS);
+    Bench_Report("Read 1 frame  ", t, t);
+
+    // 2. Polled block transfer, FIFO kept full
+    Bench_ReadStart(addr);
+    t = CYCLES_NOW();
+    SSP_Transfer(0, bench_buf, SPIFLASH_BENCH_SIZE);
+    t = CYCLES_NOW() - t;
+    SSP_Deselect(SPIFLASH_CS);
+    Bench_Report("Read FIFO     ", t, t);
+
+    // 3. Driver path: queued, interrupt-driven, Idle mode while waiting
+    memset(bench_buf, 0, sizeof(bench_buf));
+    idle = idle_cycles;
+    t = CYCLES_NOW();
+    SPIFlash_Read(addr, bench_buf, SPIFLASH_BENCH_SIZE);
+    t = CYCLES_NOW() - t;
+    idle = idle_cycles - idle;
+    Bench_Report("Read IRQ      ", t, t - idle);
+}
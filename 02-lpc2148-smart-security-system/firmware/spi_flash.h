@@ -0,0 +1,42 @@
+#ifndef SPI_FLASH_H
+#define SPI_FLASH_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- Wiring / Bus ---
+#define SPIFLASH_CS            (1 << 20)    // P0.20 (SSEL1 pin used as GPIO)
+#define SPIFLASH_HZ            30000000UL   // SSP maximum (PCLK / 2)
+
+// --- Geometry (25-series SPI NOR) ---
+#define SPIFLASH_PAGE_SIZE     256
+#define SPIFLASH_SECTOR_SIZE   4096
+
+// --- Commands ---
+#define SPIFLASH_CMD_WREN      0x06
+#define SPIFLASH_CMD_RDSR      0x05
+#define SPIFLASH_CMD_PP        0x02         // Page program
+#define SPIFLASH_CMD_FAST_READ 0x0B         // Address + 1 dummy byte
+#define SPIFLASH_CMD_SE        0x20         // 4KB sector erase
+#define SPIFLASH_CMD_JEDEC_ID  0x9F
+
+#define SPIFLASH_SR_WIP        0x01
+
+// --- Timeouts (worst case, ms) ---
+#define SPIFLASH_PP_MS         5
+#define SPIFLASH_SE_MS         400
+
+// --- Reserved scratch sector ---
+// The last 4KB sector belongs to SPIFlash_Benchmark(): every 'S' run erases
+// and reprograms it without asking. Keep application data below it.
+#define SPIFLASH_SCRATCH_ADDR  (SPIFlash_Size() - SPIFLASH_SECTOR_SIZE)
+#define SPIFLASH_BENCH_SIZE    1024
+
+uint32_t SPIFlash_Init(void);               // JEDEC ID, 0 = no chip
+uint32_t SPIFlash_Size(void);               // Bytes (from the JEDEC ID)
+uint8_t SPIFlash_Read(uint32_t addr, uint8_t *buf, uint16_t len);              // 1 = OK
+uint8_t SPIFlash_Program(uint32_t addr, const uint8_t *data, uint16_t len);    // Any length
+uint8_t SPIFlash_EraseSector(uint32_t addr);
+void SPIFlash_Benchmark(void);              // UART report, overwrites the scratch sector
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * File        : ssp_driver.c
+ * Description : SSP (SPI1) master driver: FIFO block transfers, queued
+ *               interrupt-driven transactions, software chip selects.
+ *
+ * NOTES:
+ * P0.17 SCK1, P0.18 MISO1, P0.19 MOSI1. Chip selects are plain GPIO
+ * outputs on port 0 (driven through FIO), so any number of devices can
+ * share the bus and a CS can stay asserted across several transfers.
+ *
+ * Block transfers keep up to SSP_FIFO_DEPTH frames in flight: the TX
+ * FIFO is topped up while the RX FIFO is drained, so the bus never waits
+ * for a register round trip and the RX FIFO cannot overrun.
+ *
+ * Queued transfers are driven by the RX half-full and RX timeout
+ * interrupts, each one draining the RX FIFO and refilling TX, then
+ * starting the next queued transaction. Queue from the main loop only.
+ */
+
+#include <LPC214X.h>
+#include "ssp_driver.h"
+#include "vic.h"
+
+// SSPCR1 / SSPSR / SSPIMSC bits
+#define SSP_CR1_SSE       (1 << 1)
+#define SSP_SR_RNE        (1 << 2)
+#define SSP_SR_BSY        (1 << 4)
+#define SSP_INT_RT        (1 << 1)      // RX timeout
+#define SSP_INT_RX        (1 << 2)      // RX FIFO half full
+
+static SSP_Xfer *q_head = 0, *q_tail = 0;
+static uint16_t q_sent, q_recv;         // Progress of q_head
+
+// CS writes must reach the pin even inside an LCD masked store
+void SSP_Select(uint32_t cs)
+{
+    unsigned long mask = FIO0MASK;
+
+    FIO0MASK = 0;
+    FIO0CLR = cs;
+    FIO0MASK = mask;
+}
+
+void SSP_Deselect(uint32_t cs)
+{
+    unsigned long mask = FIO0MASK;
+
+    FIO0MASK = 0;
+    FIO0SET = cs;
+    FIO0MASK = mask;
+}
+
+void SSP_CSInit(uint32_t cs)
+{
+    FIO0DIR |= cs;
+    SSP_Deselect(cs);
+}
+
+static void SSP_Fill(SSP_Xfer *x)
+{
+    while(q_sent < x->len && (uint16_t)(q_sent - q_recv) < SSP_FIFO_DEPTH) {
+        SSPDR = x->tx ? x->tx[q_sent] : 0xFF;
+        q_sent++;
+    }
+}
+
+static void SSP_Start(SSP_Xfer *x)
+{
+    q_sent = 0;
+    q_recv = 0;
+    if(x->cs) SSP_Select(x->cs);
+    SSP_Fill(x);
+}
+
+void SSP_ISR(void) __irq
+{
+    SSP_Xfer *x = q_head;
+    uint8_t b;
+
+    VIC_NEST_ENTER;                   // Tick / UART may preempt
+    SSPICR = SSP_INT_RT;
+
+    while(x && (SSPSR & SSP_SR_RNE)) {
+        b = SSPDR;
+        if(x->rx) x->rx[q_recv] = b;
+        q_recv++;
+    }
+
+    if(x && q_recv == x->len) {
+        if(x->cs && !(x->flags & SSP_KEEP_CS)) SSP_Deselect(x->cs);
+        q_head = x->next;
+        if(!q_head) q_tail = 0;
+        x->done = 1;
+        x = q_head;
+        if(x) SSP_Start(x);
+        else SSPIMSC = 0;               // Queue empty
+    }
+    else if(x) SSP_Fill(x);
+
+    VIC_NEST_EXIT;
+    VICVectAddr = 0;                    // Acknowledge interrupt
+}
+
+uint32_t SSP_SetClock(uint32_t hz)
+{
+    uint32_t cpsr, scr;
+
+    if(hz > SSP_MAX_HZ) hz = SSP_MAX_HZ;
+    if(hz == 0) hz = 1;
+
+    // Smallest even prescaler that leaves SCR in range: finest steps
+    for(cpsr = 2; ; cpsr += 2) {
+        scr = (PCLK_HZ / cpsr + hz - 1) / hz;       // SCR + 1, rate <= hz
+        if(scr <= 256 || cpsr >= 254) break;
+    }
+    if(scr > 256) scr = 256;
+
+    SSPCPSR = cpsr;
+    SSPCR0 = (SSPCR0 & 0xFF) | ((scr - 1) << 8);
+    return PCLK_HZ / (cpsr * scr);
+}
+
+void SSP_Init(uint32_t hz, uint8_t mode, uint8_t bits)
+{
+    PCONP |= (1 << 10);                 // PCSPI1
+
+    // P0.17 SCK1, P0.18 MISO1, P0.19 MOSI1 (PINSEL1 [7:2] = 10 10 10)
+    PINSEL1 &= ~(0x000000FC);
+    PINSEL1 |=  0x000000A8;
+
+    SSPCR1 = 0;                         // Disabled, master
+    SSPCR0 = ((bits - 1) & 0x0F) | (mode & 0xC0);   // SPI frame format
+    SSP_SetClock(hz);
+    SSPIMSC = 0;
+    SSPICR = 0x03;
+
+    VIC_Install(VIC_SLOT_SSP, VIC_CH_SSP, (unsigned long)SSP_ISR);
+
+    SSPCR1 = SSP_CR1_SSE;
+    while(SSPSR & SSP_SR_RNE) (void)SSPDR;
+}
+
+uint16_t SSP_Exchange(uint16_t frame)
+{
+    SSPDR = frame;
+    while(!(SSPSR & SSP_SR_RNE));
+    return SSPDR;
+}
+
+void SSP_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+    uint16_t sent = 0, recv = 0;
+    uint8_t b;
+
+    while(recv < len)
+    {
+        while(sent < len && (uint16_t)(sent - recv) < SSP_FIFO_DEPTH) {
+            SSPDR = tx ? tx[sent] : 0xFF;
+            sent++;
+        }
+        while(SSPSR & SSP_SR_RNE) {
+            b = SSPDR;
+            if(rx) rx[recv] = b;
+            recv++;
+        }
+    }
+}
+
+void SSP_Queue(SSP_Xfer *x)
+{
+    unsigned long lock;
+
+    x->done = 0;
+    x->next = 0;
+
+    lock = VIC_Lock(VIC_BIT(VIC_CH_SSP));
+    if(q_tail) {
+        q_tail->next = x;
+        q_tail = x;
+    } else {
+        q_head = q_tail = x;
+        SSP_Start(x);
+        SSPIMSC = SSP_INT_RX | SSP_INT_RT;
+    }
+    VIC_Unlock(lock);
+}
+
+void SSP_Run(SSP_Xfer *x)
+{
+    // Short transfer on an idle bus: polling beats the interrupt overhead
+    if(!q_head && x->len < SSP_IRQ_MIN)
+    {
+        if(x->cs) SSP_Select(x->cs);
+        SSP_Transfer(x->tx, x->rx, x->len);
+        if(x->cs && !(x->flags & SSP_KEEP_CS)) SSP_Deselect(x->cs);
+        x->done = 1;
+        return;
+    }
+
+    SSP_Queue(x);
+    while(!x->done) cpu_idle();
+}
+
+uint8_t SSP_Busy(void)
+{
+    return q_head != 0 || (SSPSR & SSP_SR_BSY);
+}
@@ -0,0 +1,46 @@
+#ifndef SSP_DRIVER_H
+#define SSP_DRIVER_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+#include "system_init.h"
+
+#define SSP_FIFO_DEPTH    8             // TX and RX FIFO frames
+#define SSP_IRQ_MIN       32            // SSP_Run(): shorter transfers are polled
+#define SSP_MAX_HZ        (PCLK_HZ / 2) // Master mode limit
+
+// --- Frame Format (SSPCR0 CPOL / CPHA) ---
+#define SSP_MODE0         0x00          // CPOL=0 CPHA=0
+#define SSP_MODE1         0x80          // CPOL=0 CPHA=1
+#define SSP_MODE2         0x40          // CPOL=1 CPHA=0
+#define SSP_MODE3         0xC0          // CPOL=1 CPHA=1
+
+// --- Transaction Flags ---
+#define SSP_KEEP_CS       0x01          // Leave CS asserted (command + data phases)
+
+// One chip-select transaction. Queued transactions run back to back from
+// the SSP interrupt; the caller keeps the struct and buffers alive until
+// 'done' is set.
+typedef struct SSP_Xfer {
+    uint32_t cs;                        // P0 pin mask, active low (0 = none)
+    const uint8_t *tx;                  // 0 -> send 0xFF
+    uint8_t *rx;                        // 0 -> discard
+    uint16_t len;                       // Frames (> 0)
+    uint8_t flags;
+    volatile uint8_t done;
+    struct SSP_Xfer *next;
+} SSP_Xfer;
+
+void SSP_Init(uint32_t hz, uint8_t mode, uint8_t bits);    // bits: 4-16
+uint32_t SSP_SetClock(uint32_t hz);     // Returns the rate actually set
+void SSP_CSInit(uint32_t cs);
+void SSP_Select(uint32_t cs);
+void SSP_Deselect(uint32_t cs);
+
+uint16_t SSP_Exchange(uint16_t frame);  // Single frame, any frame size
+void SSP_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t len);   // Polled, <= 8-bit frames
+void SSP_Queue(SSP_Xfer *x);            // Interrupt-driven, returns at once
+void SSP_Run(SSP_Xfer *x);              // Blocking (Idle mode while queued)
+uint8_t SSP_Busy(void);
+
+#endif
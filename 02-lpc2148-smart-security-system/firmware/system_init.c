@@ -1,16 +1,35 @@
 /*
  * File        : system_init.c
- * Description : System clock and timer initialization.
+ * Description : System clock, MAM, tick timer and power mode.
  *
  * NOTE:
- * Timer0-based delays are used instead of software loops to provide
- * predictable timing at 60 MHz system clock.
+ * Timer0 runs a 1ms system tick; delays count ticks instead of spinning
+ * in software loops, giving predictable timing at 60 MHz system clock.
+ * Between ticks the CPU can sit in Idle mode (POWER_IDLE): the core
+ * clock stops while timers, UART, ADC and RTC keep running, and any
+ * enabled interrupt (tick, UART, ADC, SSP, PWM, RTC) wakes it. The
+ * keypad is polled after each wake, so a press is seen within one tick.
+ * The tick owns the highest VIC slot (vic.h) and its entry latency is
+ * sampled on every interrupt.
+ *
+ * Timer1 free-runs at PCLK (= CCLK) as the cycle counter for
+ * benchmarks and the monitor loop profile (perf_probe.c).
+ *
+ * Ports 0 and 1 run in fast GPIO mode (FIOxxx on the local bus). The
+ * legacy IOxxx registers no longer drive the pins once fast_gpio() has
+ * run, so every driver must use FIO0xxx / FIO1xxx.
  */
 
 
 #include <LPC214X.h>
 #include <stdint.h>
 #include "system_init.h"
+#include "vic.h"
+
+volatile uint32_t sys_ticks = 0;
+volatile uint32_t idle_cycles = 0;  // CCLK cycles spent in Idle mode
+
+static uint8_t power = PERF_PROFILE ? POWER_IDLE : POWER_RUN;
 
 void pll(void)
 {
@@ -30,17 +49,91 @@ void pll(void)
     PLL0FEED = 0x55;
     
     VPBDIV = 0x01;   // PCLK = CCLK = 60MHz
+
+#if PERF_PROFILE
+    // MAM: without it every flash fetch stalls for the full access time.
+    // MAMTIM may only change while the MAM is off.
+    MAMCR  = 0x00;
+    MAMTIM = MAM_FETCH_CLK;
+    MAMCR  = MAM_MODE;
+#endif
+}
+
+void fast_gpio(void)
+{
+    // Single-cycle local bus access instead of APB wait states
+    SCS |= SCS_GPIO0M | SCS_GPIO1M;
+
+    // All pins writable/readable; drivers mask per access where needed
+    FIO0MASK = 0;
+    FIO1MASK = 0;
+}
+
+void Tick_ISR(void) __irq
+{
+    // TC restarted at the MR0 match: its value now is the entry latency
+    VIC_LatencySample(VIC_PROBE_TICK, T0TC);
+#if VIC_PROBE_PIN
+    FIO0SET = VIC_PROBE_PIN;
+#endif
+
+    sys_ticks++;
+    T0IR = (1 << 0);                // Clear MR0 interrupt
+
+#if VIC_PROBE_PIN
+    FIO0CLR = VIC_PROBE_PIN;
+#endif
+    VICVectAddr = 0;                // Acknowledge interrupt
+}
+
+void tick_init(void)
+{
+    // Timer0: 1ms tick, interrupt + reset on MR0
+    T0TCR  = 0x02;
+    T0CTCR = 0x00;                  // Timer Mode
+    T0PR   = 0;
+    T0MR0  = (PCLK_HZ / TICK_HZ) - 1;
+    T0MCR  = 0x03;
+
+    // Timer1: free-running cycle counter
+    T1TCR  = 0x02;
+    T1CTCR = 0x00;
+    T1PR   = 0;
+    T1MCR  = 0x00;
+
+    VIC_Install(VIC_SLOT_TICK, VIC_CH_TIMER0, (unsigned long)Tick_ISR);
+
+    T0TCR  = 0x01;
+    T1TCR  = 0x01;
+}
+
+void power_mode(uint8_t mode)
+{
+    power = mode;
+}
+
+uint8_t power_get_mode(void)
+{
+    return power;
+}
+
+void cpu_idle(void)
+{
+    uint32_t t = CYCLES_NOW();
+
+    if(power == POWER_IDLE)
+    {
+        // Core stops here until the next IRQ. An IRQ landing just before
+        // this store is only noticed at the following one (<= 1 tick).
+        PCON = PCON_IDL;
+        idle_cycles += CYCLES_NOW() - t;
+    }
 }
 
 void delayms(uint16_t del)          
 {
-    // Timer0 configuration for Millisecond delay
-    T0CTCR = 0x00;   // Timer Mode
-    T0PR   = 59999;  // Prescaler: 60000 ticks = 1ms (@60MHz)
-    T0TC   = 0;      // Reset Counter
-    T0TCR  = 0x01;   // Enable Timer
-    
-    while(T0TC < del); // Block until count reached
-    
-    T0TCR  = 0x00;   // Disable Timer
+    uint32_t start = sys_ticks;
+
+    // > del full ticks: the partial tick at the start is never counted
+    while((uint32_t)(sys_ticks - start) <= del) cpu_idle();
 }
@@ -11,8 +11,45 @@
 extern char current_password[10];
 extern uint8_t current_state;
 extern uint8_t temp_threshold;
+extern int16_t adc_cal_gain;     // LM35 gain in Q12 (4096 = 1.000)
+extern int16_t adc_cal_offset;   // LM35 offset in 0.1 C
+
+// 1 = performance profile (MAM fully on, Idle mode between events)
+// 0 = MAM off, busy-wait delays (baseline for before/after benchmarks)
+#ifndef PERF_PROFILE
+#define PERF_PROFILE  1
+#endif
+
+// --- Clocks (12MHz crystal, PLL x5) ---
+#define CCLK_HZ       60000000UL
+#define PCLK_HZ       CCLK_HZ       // VPBDIV = 1
+#define TICK_HZ       1000          // Timer0 system tick
+
+// MAM fully enabled; 3 CCLK flash fetch cycles for CCLK above 40MHz
+#define MAM_MODE      2
+#define MAM_FETCH_CLK 3
+
+// SCS bits: route GPIO ports to the local bus (FIOxxx registers)
+#define SCS_GPIO0M    (1 << 0)
+#define SCS_GPIO1M    (1 << 1)
+
+// --- Power Modes ---
+#define PCON_IDL      (1 << 0)
+#define POWER_RUN     0             // Busy-wait between events
+#define POWER_IDLE    1             // Idle mode (core clock off) until next IRQ
+
+// CCLK cycle counter (Timer1 free-running at PCLK = CCLK)
+#define CYCLES_NOW()  (T1TC)
+
+extern volatile uint32_t sys_ticks;
+extern volatile uint32_t idle_cycles;
 
 void pll(void);
+void fast_gpio(void);
+void tick_init(void);               // Timer0 tick + Timer1 cycle counter
+void power_mode(uint8_t mode);
+uint8_t power_get_mode(void);
+void cpu_idle(void);                // Wait for the next interrupt (POWER_IDLE)
 void delayms(uint16_t del);
 
 
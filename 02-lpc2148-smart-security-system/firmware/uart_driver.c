@@ -1,6 +1,17 @@
 /*
  * File        : uart_driver.c
- * Description : UART0 driver (9600 baud).
+ * Description : UART1 driver (9600 baud), interrupt-driven RX/TX.
+ *
+ * NOTES:
+ * The UART1 ISR drains the RX FIFO on every character (trigger level 1
+ * and the character timeout) and refills the TX FIFO on THRE, 16 bytes
+ * at a time. Each received byte is first offered to the binary command
+ * parser (uart_protocol.c); bytes it does not claim go to the text ring
+ * read by the console functions below.
+ *
+ * UART_SendChar() only queues: it blocks (in Idle mode) only when the TX
+ * ring is full, so text output no longer stalls the control loops.
+ * Never call it from an ISR or with the UART interrupt masked.
  */
 
 #include <LPC214X.h>
@@ -8,6 +19,60 @@
 #include <stdio.h>
 #include "uart_driver.h"
 #include "system_init.h" // Provides access to current_password
+#include "event_log.h"
+#include "uart_protocol.h"
+#include "vic.h"
+
+#define UART_TX_MASK       (UART_TX_SIZE - 1)
+#define UART_RX_MASK       (UART_RX_SIZE - 1)
+
+static uint8_t tx_buf[UART_TX_SIZE];
+static volatile uint16_t tx_head = 0, tx_tail = 0;
+static volatile uint8_t  tx_busy = 0;       // THR/FIFO owned by the ISR
+
+static uint8_t rx_buf[UART_RX_SIZE];
+static volatile uint16_t rx_head = 0, rx_tail = 0;
+static volatile uint32_t rx_tick = 0;       // sys_ticks of the last RX byte
+
+void UART_ISR(void) __irq
+{
+    uint8_t iir, b, n;
+
+    VIC_NEST_ENTER;                           // Tick may preempt
+
+    while(((iir = U1IIR) & 0x01) == 0)          // Interrupt pending
+    {
+        switch(iir & 0x0E)
+        {
+            case 0x04:                          // RX data available
+            case 0x0C:                          // Character timeout
+                while(U1LSR & 0x01) {
+                    b = U1RBR;
+                    rx_tick = sys_ticks;
+                    if(Protocol_RxByte(b)) continue;
+                    if(((rx_head + 1) & UART_RX_MASK) != rx_tail) {
+                        rx_buf[rx_head] = b;
+                        rx_head = (rx_head + 1) & UART_RX_MASK;
+                    }
+                }
+                break;
+
+            case 0x02:                          // THR empty: refill FIFO
+                for(n = 0; n < 16 && tx_tail != tx_head; n++) {
+                    U1THR = tx_buf[tx_tail];
+                    tx_tail = (tx_tail + 1) & UART_TX_MASK;
+                }
+                if(n == 0) tx_busy = 0;
+                break;
+
+            default:                            // RX line status: clear
+                (void)U1LSR;
+                break;
+        }
+    }
+    VIC_NEST_EXIT;
+    VICVectAddr = 0;                            // Acknowledge interrupt
+}
 
 void UART_Init(void)
 {
@@ -20,13 +85,29 @@ void UART_Init(void)
     U1DLL = 0x87;  // Baud Rate: 9600 @ 60MHz PCLK
     U1DLM = 0x01;  
     U1LCR = 0x03;  // Disable DLAB
-    U1FCR = 0x07;  // Enable FIFO
+    U1FCR = 0x07;  // Enable + reset FIFOs, RX trigger 1 byte
+
+    VIC_Install(VIC_SLOT_UART, VIC_CH_UART1, (unsigned long)UART_ISR);
+
+    U1IER = 0x07;  // RX data, THRE, RX line status interrupts
 }
 
 void UART_SendChar(char a)
 {
-    U1THR = a; 
-    while((U1LSR & (1<<5)) == 0); // Wait for THR empty
+    unsigned long lock;
+
+    // Wait for ring space; the THRE interrupt wakes us
+    while(((tx_head + 1) & UART_TX_MASK) == tx_tail) cpu_idle();
+
+    lock = VIC_Lock(VIC_BIT(VIC_CH_UART1));
+    if(!tx_busy) {
+        U1THR = a;                  // TX idle: start directly, THRE refills
+        tx_busy = 1;
+    } else {
+        tx_buf[tx_head] = a;
+        tx_head = (tx_head + 1) & UART_TX_MASK;
+    }
+    VIC_Unlock(lock);
 }
 
 void UART_SendString(char *str)
@@ -42,9 +123,10 @@ char* UART_ReceiveString(void)
 
     while(1)
     { 
-        // Wait for Data Ready
-        while((U1LSR & 0x01) == 0);  
-        received_char = U1RBR; 
+        // Wait for a console byte; remote frames are served meanwhile
+        while(rx_tail == rx_head) { Protocol_Service(); cpu_idle(); }
+        received_char = rx_buf[rx_tail];
+        rx_tail = (rx_tail + 1) & UART_RX_MASK;
         
         // Handle Backspace (\b)
         if(received_char == '\b') {
@@ -75,6 +157,23 @@ char* UART_ReceiveString(void)
     return input;
 }
 
+int UART_PollChar(void)
+{
+    int c;
+
+    if(rx_tail == rx_head) return -1;   // No Data Ready
+    c = rx_buf[rx_tail];
+    rx_tail = (rx_tail + 1) & UART_RX_MASK;
+    return c;
+}
+
+uint8_t UART_RxIdle(uint32_t quiet_ms)
+{
+    // Nothing buffered, nothing in the FIFO and the line silent for quiet_ms
+    if(rx_tail != rx_head || (U1LSR & 0x01)) return 0;
+    return (sys_ticks - rx_tick) >= quiet_ms;
+}
+
 void UART_CheckPassword(void)
 {
     char *input;
@@ -89,16 +188,19 @@ void UART_CheckPassword(void)
         
         if(strcmp(input, current_password) == 0) {
             UART_SendString("\r\nAccess Granted\r\n");
+            EventLog_Add(EVT_ACCESS_OK, 0);
             current_state = 1;
             return;
         } else {
             UART_SendString("\r\nIncorrect Password.\r\n");
+            EventLog_Add(EVT_ACCESS_FAIL, 0);
             count++;
         }
         
         // Lockout Logic (3 attempts)
         if(count >= 3) {
             UART_SendString("System Locked. Wait...\r\n");
+            EventLog_Add(EVT_LOCKOUT, 0);
             for(i = 3; i > 0; i--) {
                 sprintf(arr, "%d.. ", i);
                 UART_SendString(arr);
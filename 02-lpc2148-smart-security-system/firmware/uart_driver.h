@@ -6,10 +6,15 @@
 #include <stdint.h>
 #include "system_init.h"
 
+#define UART_TX_SIZE   256          // TX ring (power of 2)
+#define UART_RX_SIZE   64           // Console RX ring (power of 2)
+
 void UART_Init(void);
 void UART_SendChar(char a);
 void UART_SendString(char *str);
 char* UART_ReceiveString(void);
+int UART_PollChar(void);            // -1 if no data (non-blocking)
+uint8_t UART_RxIdle(uint32_t quiet_ms); // 1 = RX empty, no byte for quiet_ms
 void UART_CheckPassword(void);
 
 #endif
@@ -0,0 +1,285 @@
+/*
+ * File        : uart_protocol.c
+ * Description : Framed binary command protocol on UART1 (remote config).
+ *
+ * NOTES:
+ * The UART ISR hands every byte to Protocol_RxByte(). Outside a frame
+ * only PROTO_SOF is claimed, so the text console keeps working on the
+ * same port. Inside a frame the parser just stores bytes (no CRC work in
+ * the ISR); a gap of PROTO_BYTE_TIMEOUT ms resynchronises it. A frame
+ * that arrives while the previous one is still pending is dropped.
+ *
+ * Protocol_Service() runs from the menu, Monitor Mode and console wait
+ * loops: it checks the CRC, executes the command and queues the response
+ * on the interrupt-driven TX ring, so a poll costs the control loop well
+ * under a millisecond. Frames with a bad CRC get no response.
+ *
+ * Every command except PING/AUTH needs a prior successful AUTH. The
+ * session expires after PROTO_SESSION_S seconds without a command. Three
+ * failed AUTHs lock the remote session for PROTO_LOCKOUT_S seconds.
+ */
+
+#include <LPC214X.h>
+#include <string.h>
+#include "uart_protocol.h"
+#include "uart_driver.h"
+#include "system_init.h"
+#include "settings_store.h"
+#include "event_log.h"
+#include "motor_driver.h"
+#include "rtc_driver.h"
+#include "adc_driver.h"
+#include "crc16.h"
+
+#define PROTO_MAX_FAILS      3
+#define PROTO_LOCKOUT_S      3
+#define PROTO_SESSION_S      60     // Idle seconds before AUTH is needed again
+
+enum { RX_SOF = 0, RX_LEN, RX_CMD, RX_PAYLOAD, RX_CRC_LO, RX_CRC_HI };
+
+// --- ISR-owned parser state ---
+static uint8_t  rx_state = RX_SOF;
+static uint8_t  rx_len, rx_pos;
+static uint8_t  rx_drop;
+static uint32_t rx_tick;
+
+// --- Frame handed to main context (valid while frame_ready) ---
+static volatile uint8_t frame_ready = 0;
+static uint8_t  frame_len, frame_cmd;
+static uint8_t  frame_payload[PROTO_MAX_PAYLOAD];
+static uint16_t frame_crc;
+
+// --- Session / status ---
+static uint8_t  authed = 0;
+static uint8_t  auth_fails = 0;
+static uint32_t lock_until = 0;
+static uint32_t last_cmd = 0;           // RTC seconds of the last authed command
+static int16_t  status_temp = 0;
+static uint8_t  status_flags = 0;
+
+static uint8_t resp[PROTO_MAX_PAYLOAD];
+
+uint8_t Protocol_RxByte(uint8_t b)
+{
+    uint32_t now = sys_ticks;
+
+    if(rx_state != RX_SOF && now - rx_tick > PROTO_BYTE_TIMEOUT) rx_state = RX_SOF;
+    rx_tick = now;
+
+    switch(rx_state)
+    {
+        case RX_SOF:
+            if(b != PROTO_SOF) return 0;            // Console byte
+            rx_drop = frame_ready;                  // Previous frame not served yet
+            rx_state = RX_LEN;
+            break;
+
+        case RX_LEN:
+            if(b > PROTO_MAX_PAYLOAD) { rx_state = RX_SOF; break; }
+            rx_len = b;
+            rx_pos = 0;
+            if(!rx_drop) frame_len = b;
+            rx_state = RX_CMD;
+            break;
+
+        case RX_CMD:
+            if(!rx_drop) frame_cmd = b;
+            rx_state = rx_len ? RX_PAYLOAD : RX_CRC_LO;
+            break;
+
+        case RX_PAYLOAD:
+            if(!rx_drop) frame_payload[rx_pos] = b;
+            if(++rx_pos >= rx_len) rx_state = RX_CRC_LO;
+            break;
+
+        case RX_CRC_LO:
+            if(!rx_drop) frame_crc = b;
+            rx_state = RX_CRC_HI;
+            break;
+
+        case RX_CRC_HI:
+            if(!rx_drop) {
+                frame_crc |= (uint16_t)b << 8;
+                frame_ready = 1;
+            }
+            rx_state = RX_SOF;
+            break;
+    }
+    return 1;
+}
+
+void Protocol_SetStatus(int16_t temp, uint8_t flags)
+{
+    status_temp = temp;
+    status_flags = flags;
+}
+
+static void Protocol_Send(uint8_t cmd, uint8_t len)
+{
+    uint8_t hdr[2];
+    uint16_t crc;
+    uint8_t i;
+
+    hdr[0] = len;
+    hdr[1] = cmd | PROTO_RESPONSE;
+    crc = CRC16_Update(CRC16_INIT, hdr, 2);
+    crc = CRC16_Update(crc, resp, len);
+
+    UART_SendChar(PROTO_SOF);
+    UART_SendChar(hdr[0]);
+    UART_SendChar(hdr[1]);
+    for(i = 0; i < len; i++) UART_SendChar(resp[i]);
+    UART_SendChar(crc & 0xFF);
+    UART_SendChar(crc >> 8);
+}
+
+static uint8_t Protocol_Auth(const uint8_t *pw, uint8_t len)
+{
+    if(RTC_GetSeconds() < lock_until) return PROTO_ERR_LOCKED;
+
+    if(len == strlen(current_password) && memcmp(pw, current_password, len) == 0) {
+        authed = 1;
+        auth_fails = 0;
+        last_cmd = RTC_GetSeconds();
+        EventLog_Add(EVT_ACCESS_OK, 0);
+        return PROTO_OK;
+    }
+
+    authed = 0;
+    EventLog_Add(EVT_ACCESS_FAIL, 0);
+    if(++auth_fails >= PROTO_MAX_FAILS) {
+        auth_fails = 0;
+        lock_until = RTC_GetSeconds() + PROTO_LOCKOUT_S;
+        EventLog_Add(EVT_LOCKOUT, 0);
+    }
+    return PROTO_ERR_AUTH;
+}
+
+static uint8_t Protocol_SetPassword(const uint8_t *p, uint8_t len)
+{
+    const uint8_t *sep = memchr(p, 0, len);
+    uint8_t old_len, new_len;
+
+    if(!sep) return PROTO_ERR_LEN;
+    old_len = sep - p;
+    new_len = len - old_len - 1;
+    if(old_len != strlen(current_password) || memcmp(p, current_password, old_len) != 0) return PROTO_ERR_AUTH;
+    if(new_len == 0 || new_len > sizeof(current_password) - 1 || memchr(sep + 1, 0, new_len)) return PROTO_ERR_VALUE;
+
+    memcpy(current_password, sep + 1, new_len);
+    current_password[new_len] = '\0';
+    if(!Settings_Set(SETTING_PASSWORD, current_password, new_len + 1)) return PROTO_ERR_FLASH;
+    EventLog_Add(EVT_PASSWORD_CHANGE, ADC_GetTemperature());
+    return PROTO_OK;
+}
+
+static uint8_t Protocol_SetCal(const uint8_t *p, uint8_t len)
+{
+    int16_t gain, offset;
+
+    if(len != 4) return PROTO_ERR_LEN;
+    gain   = (int16_t)(p[0] | ((uint16_t)p[1] << 8));
+    offset = (int16_t)(p[2] | ((uint16_t)p[3] << 8));
+    if(gain < ADC_CAL_GAIN_MIN || gain > ADC_CAL_GAIN_MAX ||
+       offset < -ADC_CAL_OFFSET_MAX || offset > ADC_CAL_OFFSET_MAX) return PROTO_ERR_VALUE;
+
+    // Live only once both are stored
+    if(!Settings_Set(SETTING_CAL_GAIN, &gain, 2) ||
+       !Settings_Set(SETTING_CAL_OFFSET, &offset, 2)) return PROTO_ERR_FLASH;
+    adc_cal_gain   = gain;          // 16-bit stores: ADC readers see old or new
+    adc_cal_offset = offset;
+    return PROTO_OK;
+}
+
+// Fills resp[1..] and returns the data length (resp[0] = status)
+static uint8_t Protocol_Execute(uint8_t cmd, const uint8_t *p, uint8_t len)
+{
+    Event_Record recs[PROTO_LOG_CHUNK];
+    uint16_t first, total, n, duty;
+    int16_t temp;
+    uint32_t up;
+
+    if(cmd == CMD_PING) { resp[1] = PROTO_VERSION; resp[0] = PROTO_OK; return 1; }
+    if(cmd == CMD_AUTH) { resp[0] = Protocol_Auth(p, len); return 0; }
+
+    // Idle session expires (same RTC seconds base as lock_until)
+    if(authed && RTC_GetSeconds() - last_cmd > PROTO_SESSION_S) authed = 0;
+    if(!authed)         { resp[0] = PROTO_ERR_AUTH; return 0; }
+    last_cmd = RTC_GetSeconds();
+
+    resp[0] = PROTO_OK;
+    switch(cmd)
+    {
+        case CMD_GET_THRESHOLD:
+            resp[1] = temp_threshold;
+            return 1;
+
+        case CMD_SET_THRESHOLD:
+            if(len != 1) { resp[0] = PROTO_ERR_LEN; return 0; }
+            if(p[0] > 99) { resp[0] = PROTO_ERR_VALUE; return 0; }
+            // Live only once stored
+            if(!Settings_Set(SETTING_THRESHOLD, &p[0], 1)) { resp[0] = PROTO_ERR_FLASH; return 0; }
+            temp_threshold = p[0];
+            EventLog_Add(EVT_THRESHOLD_SET, ADC_GetTemperature());
+            return 0;
+
+        case CMD_SET_PASSWORD:
+            resp[0] = Protocol_SetPassword(p, len);
+            return 0;
+
+        case CMD_GET_CAL:
+            resp[1] = adc_cal_gain & 0xFF;    resp[2] = (uint16_t)adc_cal_gain >> 8;
+            resp[3] = adc_cal_offset & 0xFF;  resp[4] = (uint16_t)adc_cal_offset >> 8;
+            return 4;
+
+        case CMD_SET_CAL:
+            resp[0] = Protocol_SetCal(p, len);
+            return 0;
+
+        case CMD_GET_STATUS:
+            // Monitor Mode refreshes its reading every loop (it may be keypad
+            // simulated); anywhere else the last scan is read now
+            temp = (status_flags & PROTO_FLAG_MONITOR) ? status_temp : ADC_GetTemperature();
+            duty = Motor_GetDuty();
+            up = RTC_GetSeconds();
+            resp[1] = temp & 0xFF;         resp[2] = (uint16_t)temp >> 8;
+            resp[3] = duty & 0xFF;         resp[4] = duty >> 8;
+            resp[5] = temp_threshold;
+            resp[6] = status_flags | (current_state ? PROTO_FLAG_UNLOCKED : 0);
+            resp[7] = up & 0xFF; resp[8] = (up >> 8) & 0xFF; resp[9] = (up >> 16) & 0xFF; resp[10] = up >> 24;
+            return 10;
+
+        case CMD_LOG_READ:
+            if(len != 2) { resp[0] = PROTO_ERR_LEN; return 0; }
+            first = p[0] | ((uint16_t)p[1] << 8);
+            n = EventLog_Read(first, recs, PROTO_LOG_CHUNK, &total);
+            memcpy(&resp[4], recs, n * sizeof(Event_Record));   // resp is not word aligned
+            resp[1] = total & 0xFF; resp[2] = total >> 8;
+            resp[3] = (uint8_t)n;
+            return 3 + n * sizeof(Event_Record);
+
+        default:
+            resp[0] = PROTO_ERR_CMD;
+            return 0;
+    }
+}
+
+void Protocol_Service(void)
+{
+    uint8_t hdr[2];
+    uint16_t crc;
+    uint8_t len;
+
+    if(!frame_ready) return;
+
+    hdr[0] = frame_len;
+    hdr[1] = frame_cmd;
+    crc = CRC16_Update(CRC16_INIT, hdr, 2);
+    crc = CRC16_Update(crc, frame_payload, frame_len);
+
+    if(crc == frame_crc) {
+        len = Protocol_Execute(frame_cmd, frame_payload, frame_len);
+        Protocol_Send(frame_cmd, len + 1);
+    }
+    frame_ready = 0;                    // Parser may fill the buffer again
+}
@@ -0,0 +1,45 @@
+#ifndef UART_PROTOCOL_H
+#define UART_PROTOCOL_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- Frame: SOF | LEN | CMD | PAYLOAD[LEN] | CRC16 (LE, over LEN..PAYLOAD) ---
+#define PROTO_SOF            0xA5   // Never produced by the text console
+#define PROTO_MAX_PAYLOAD    160
+#define PROTO_BYTE_TIMEOUT   20     // ms between bytes before a frame is dropped
+#define PROTO_RESPONSE       0x80   // Response CMD = request CMD | 0x80
+
+// --- Commands (all multi-byte fields little-endian) ---
+#define CMD_PING             0x01   // -> version
+#define CMD_AUTH             0x02   // password -> (opens the remote session)
+#define CMD_GET_THRESHOLD    0x10   // -> threshold C
+#define CMD_SET_THRESHOLD    0x11   // threshold C (0-99) -> persisted
+#define CMD_SET_PASSWORD     0x12   // old NUL new (1-9 chars) -> persisted
+#define CMD_GET_CAL          0x13   // -> gain(Q12) offset(0.1C)
+#define CMD_SET_CAL          0x14   // gain(Q12) offset(0.1C) -> persisted
+#define CMD_GET_STATUS       0x20   // -> temp(0.1C) duty(0.1%) threshold flags uptime(s)
+#define CMD_LOG_READ         0x30   // first -> total n records[n]
+
+// --- Response Status (first payload byte) ---
+#define PROTO_OK             0x00
+#define PROTO_ERR_CMD        0x01
+#define PROTO_ERR_LEN        0x02
+#define PROTO_ERR_AUTH       0x03   // Not authenticated / wrong password
+#define PROTO_ERR_VALUE      0x04
+#define PROTO_ERR_FLASH      0x05
+#define PROTO_ERR_LOCKED     0x06   // Too many failed AUTH attempts, retry later
+
+// --- Status Flags (CMD_GET_STATUS) ---
+#define PROTO_FLAG_MONITOR   0x01
+#define PROTO_FLAG_ALERT     0x02
+#define PROTO_FLAG_UNLOCKED  0x04   // Text console unlocked
+
+#define PROTO_VERSION        1
+#define PROTO_LOG_CHUNK      12     // Records per CMD_LOG_READ response (12 x 12 bytes)
+
+uint8_t Protocol_RxByte(uint8_t b);                 // UART ISR: 1 = byte consumed
+void Protocol_Service(void);                        // Main context: handle a frame
+void Protocol_SetStatus(int16_t temp, uint8_t flags);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef VIC_H
+#define VIC_H
+
+#include <LPC214X.h>
+#include <stdint.h>
+
+// --- VIC Channels (interrupt sources) ---
+#define VIC_CH_TIMER0     4
+#define VIC_CH_UART1      7
+#define VIC_CH_PWM        8
+#define VIC_CH_SSP        11
+#define VIC_CH_RTC        13
+#define VIC_CH_AD0        18
+
+#define VIC_BIT(ch)       (1UL << (ch))
+#define VIC_ALL           0xFFFFFFFFUL
+
+// --- Priority Plan: vectored slot = priority (0 = highest) ---
+// The keypad has no interrupt source (P1 has no EINT pins): it is scanned
+// from the main loops, below every ISR.
+#define VIC_SLOT_TICK     0         // 1ms timebase for every delay / timeout
+#define VIC_SLOT_UART     1         // 16-byte RX FIFO: ~16ms of slack at 9600
+#define VIC_SLOT_ADC      2         // Must pick the next channels within 2ms
+#define VIC_SLOT_SSP      3         // Queued transfers only stall the bus
+#define VIC_SLOT_PWM      4         // Fan soft-start step, one per 40us period
+#define VIC_SLOT_RTC      5         // 1Hz, tolerates almost a second
+
+// --- Nested ISRs (ARM7) ---
+// VIC_NEST_ENTER re-enables IRQs in System mode after saving SPSR_irq,
+// so a higher slot (the tick) can preempt the rest of the handler; the
+// VIC keeps this and lower slots masked until VICVectAddr is written.
+// Put VIC_NEST_EXIT before the VICVectAddr acknowledge. Used by the
+// handlers that loop over a FIFO (UART, SSP); short ones such as the
+// ADC pair handler would spend more on the wrapper than they hold the
+// tick off. Needs System-mode stack for the nested frames. The host
+// simulator supplies its own versions.
+#ifndef VIC_NEST_ENTER
+#define VIC_NEST_ENTER                                                       \
+    __asm { MRS   LR, SPSR      }       /* Copy SPSR_irq to LR          */  \
+    __asm { STMFD SP!, {LR}     }       /* Save SPSR_irq                */  \
+    __asm { MSR   CPSR_c, #0x1F }       /* System mode, IRQ enabled     */  \
+    __asm { STMFD SP!, {LR}     }       /* Save LR_sys                  */
+
+#define VIC_NEST_EXIT                                                        \
+    __asm { LDMFD SP!, {LR}     }       /* Restore LR_sys               */  \
+    __asm { MSR   CPSR_c, #0x92 }       /* IRQ mode, IRQ disabled       */  \
+    __asm { LDMFD SP!, {LR}     }       /* Saved SPSR_irq to LR         */  \
+    __asm { MSR   SPSR_cxsf, LR }       /* Restore SPSR_irq             */
+#endif
+
+// --- Interrupt Latency Probe ---
+// Sources whose timer restarts at the interrupting match, so the counter
+// read at ISR entry is the latency in PCLK (= CCLK) cycles
+#define VIC_PROBE_TICK    0         // T0TC in Tick_ISR
+#define VIC_PROBE_PWM     1         // PWMTC in PWM_ISR
+#define VIC_PROBE_COUNT   2
+
+// P0 pin mask driven high for the duration of Tick_ISR (scope probe, 0 = off)
+#define VIC_PROBE_PIN     0
+
+void VIC_Install(uint8_t slot, uint8_t channel, unsigned long isr);
+
+// Critical sections: mask sources, returning the ones that were enabled
+unsigned long VIC_Lock(unsigned long mask);
+void VIC_Unlock(unsigned long prev);
+
+void VIC_LatencySample(uint8_t src, uint32_t cycles);
+void VIC_Report(void);              // UART 'V': worst / mean latency, then reset
+
+#endif
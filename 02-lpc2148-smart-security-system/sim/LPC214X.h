@@ -0,0 +1,291 @@
+/*
+ * File        : LPC214X.h (host simulator)
+ * Description : Register model of the LPC2148 for the Linux-hosted build.
+ *
+ * NOTES:
+ * Drop-in replacement for Keil's <LPC214X.h> when the firmware is built by
+ * sim/Makefile. Registers with no side effects are plain variables.
+ * Registers with side effects (GPIO pin/set/clear/mask, PCON, timers, UART, ADC results,
+ * RTC, SSP, VIC enables) expand to *Sim_xxx(): each access first synchronises
+ * the peripheral models to virtual time, applies the previous pending
+ * write and may dispatch interrupts, exactly where a real access would
+ * be observable.
+ */
+
+#ifndef LPC214X_H
+#define LPC214X_H
+
+#include <stdint.h>
+
+#define __irq                       // ARM IRQ attribute: not used on the host
+
+typedef unsigned long sim_reg_t;
+
+// --- Plain Registers ---
+#define SIM_REG(name) extern volatile sim_reg_t sim_##name;
+#include "sim_regs.def"
+#undef SIM_REG
+
+// Vectored slots are arrays so (&VICVectAddr0)[slot] works as on the chip
+extern volatile sim_reg_t sim_VICVectAddrN[16];
+extern volatile sim_reg_t sim_VICVectCntlN[16];
+
+#define PINSEL0          sim_PINSEL0
+#define PINSEL1          sim_PINSEL1
+#define PINSEL2          sim_PINSEL2
+#define IODIR0           sim_IODIR0
+#define IODIR1           sim_IODIR1
+#define FIO0DIR          sim_FIO0DIR
+#define FIO1DIR          sim_FIO1DIR
+#define SCS              sim_SCS
+#define PLL0CON          sim_PLL0CON
+#define PLL0CFG          sim_PLL0CFG
+#define PLL0FEED         sim_PLL0FEED
+#define VPBDIV           sim_VPBDIV
+#define MAMCR            sim_MAMCR
+#define MAMTIM           sim_MAMTIM
+#define PCONP            sim_PCONP
+#define MEMMAP           sim_MEMMAP
+#define EXTINT           sim_EXTINT
+#define EXTMODE          sim_EXTMODE
+#define EXTPOLAR         sim_EXTPOLAR
+#define INTWAKE          sim_INTWAKE
+#define T0IR             sim_T0IR
+#define T0TCR            sim_T0TCR
+#define T0PR             sim_T0PR
+#define T0PC             sim_T0PC
+#define T0MCR            sim_T0MCR
+#define T0MR0            sim_T0MR0
+#define T0MR1            sim_T0MR1
+#define T0MR2            sim_T0MR2
+#define T0MR3            sim_T0MR3
+#define T0CCR            sim_T0CCR
+#define T0CR0            sim_T0CR0
+#define T0EMR            sim_T0EMR
+#define T0CTCR           sim_T0CTCR
+#define T1IR             sim_T1IR
+#define T1TCR            sim_T1TCR
+#define T1PR             sim_T1PR
+#define T1PC             sim_T1PC
+#define T1MCR            sim_T1MCR
+#define T1MR0            sim_T1MR0
+#define T1MR1            sim_T1MR1
+#define T1MR2            sim_T1MR2
+#define T1MR3            sim_T1MR3
+#define T1CCR            sim_T1CCR
+#define T1CR0            sim_T1CR0
+#define T1EMR            sim_T1EMR
+#define T1CTCR           sim_T1CTCR
+#define PWMIR            sim_PWMIR
+#define PWMTCR           sim_PWMTCR
+#define PWMPR            sim_PWMPR
+#define PWMPC            sim_PWMPC
+#define PWMMCR           sim_PWMMCR
+#define PWMMR0           sim_PWMMR0
+#define PWMMR1           sim_PWMMR1
+#define PWMMR2           sim_PWMMR2
+#define PWMMR3           sim_PWMMR3
+#define PWMMR4           sim_PWMMR4
+#define PWMMR5           sim_PWMMR5
+#define PWMMR6           sim_PWMMR6
+#define PWMPCR           sim_PWMPCR
+#define U0RBR            sim_U0RBR
+#define U0THR            sim_U0THR
+#define U0DLL            sim_U0DLL
+#define U0DLM            sim_U0DLM
+#define U0IER            sim_U0IER
+#define U0IIR            sim_U0IIR
+#define U0FCR            sim_U0FCR
+#define U0LCR            sim_U0LCR
+#define U0LSR            sim_U0LSR
+#define U0SCR            sim_U0SCR
+#define U1DLL            sim_U1DLL
+#define U1DLM            sim_U1DLM
+#define U1IER            sim_U1IER
+#define U1FCR            sim_U1FCR
+#define U1LCR            sim_U1LCR
+#define U1MCR            sim_U1MCR
+#define U1MSR            sim_U1MSR
+#define U1SCR            sim_U1SCR
+#define U1TER            sim_U1TER
+#define AD0CR            sim_AD0CR
+#define AD0STAT          sim_AD0STAT
+#define AD0INTEN         sim_AD0INTEN
+#define ADGSR            sim_ADGSR
+#define AD1CR            sim_AD1CR
+#define AD1STAT          sim_AD1STAT
+#define AD1INTEN         sim_AD1INTEN
+#define ILR              sim_ILR
+#define CTC              sim_CTC
+#define CCR              sim_CCR
+#define CIIR             sim_CIIR
+#define AMR              sim_AMR
+#define SEC              sim_SEC
+#define MIN              sim_MIN
+#define HOUR             sim_HOUR
+#define DOM              sim_DOM
+#define DOW              sim_DOW
+#define DOY              sim_DOY
+#define MONTH            sim_MONTH
+#define YEAR             sim_YEAR
+#define PREINT           sim_PREINT
+#define PREFRAC          sim_PREFRAC
+#define VICIntSelect     sim_VICIntSelect
+#define VICSoftInt       sim_VICSoftInt
+#define VICSoftIntClr    sim_VICSoftIntClr
+#define VICProtection    sim_VICProtection
+#define VICVectAddr      sim_VICVectAddr
+#define VICDefVectAddr   sim_VICDefVectAddr
+#define SSPCR0           sim_SSPCR0
+#define SSPCR1           sim_SSPCR1
+#define SSPCPSR          sim_SSPCPSR
+#define SSPIMSC          sim_SSPIMSC
+#define VICVectAddr0     sim_VICVectAddrN[0]
+#define VICVectAddr1     sim_VICVectAddrN[1]
+#define VICVectAddr2     sim_VICVectAddrN[2]
+#define VICVectAddr3     sim_VICVectAddrN[3]
+#define VICVectAddr4     sim_VICVectAddrN[4]
+#define VICVectAddr5     sim_VICVectAddrN[5]
+#define VICVectAddr6     sim_VICVectAddrN[6]
+#define VICVectAddr7     sim_VICVectAddrN[7]
+#define VICVectAddr8     sim_VICVectAddrN[8]
+#define VICVectAddr9     sim_VICVectAddrN[9]
+#define VICVectAddr10    sim_VICVectAddrN[10]
+#define VICVectAddr11    sim_VICVectAddrN[11]
+#define VICVectAddr12    sim_VICVectAddrN[12]
+#define VICVectAddr13    sim_VICVectAddrN[13]
+#define VICVectAddr14    sim_VICVectAddrN[14]
+#define VICVectAddr15    sim_VICVectAddrN[15]
+#define VICVectCntl0     sim_VICVectCntlN[0]
+#define VICVectCntl1     sim_VICVectCntlN[1]
+#define VICVectCntl2     sim_VICVectCntlN[2]
+#define VICVectCntl3     sim_VICVectCntlN[3]
+#define VICVectCntl4     sim_VICVectCntlN[4]
+#define VICVectCntl5     sim_VICVectCntlN[5]
+#define VICVectCntl6     sim_VICVectCntlN[6]
+#define VICVectCntl7     sim_VICVectCntlN[7]
+#define VICVectCntl8     sim_VICVectCntlN[8]
+#define VICVectCntl9     sim_VICVectCntlN[9]
+#define VICVectCntl10    sim_VICVectCntlN[10]
+#define VICVectCntl11    sim_VICVectCntlN[11]
+#define VICVectCntl12    sim_VICVectCntlN[12]
+#define VICVectCntl13    sim_VICVectCntlN[13]
+#define VICVectCntl14    sim_VICVectCntlN[14]
+#define VICVectCntl15    sim_VICVectCntlN[15]
+
+// Aliases
+#define IO0DIR           IODIR0
+#define IO1DIR           IODIR1
+#define PLLCON           PLL0CON
+#define PLLCFG           PLL0CFG
+#define PLLSTAT          PLL0STAT
+#define PLLFEED          PLL0FEED
+
+// --- Registers With Side Effects ---
+volatile sim_reg_t *Sim_AD0DR(int ch);
+volatile sim_reg_t *Sim_AD0GDR(void);
+volatile sim_reg_t *Sim_AD1DR(int ch);
+volatile sim_reg_t *Sim_AD1GDR(void);
+volatile sim_reg_t *Sim_CTIME0(void);
+volatile sim_reg_t *Sim_CTIME1(void);
+volatile sim_reg_t *Sim_FIO0CLR(void);
+volatile sim_reg_t *Sim_FIO0MASK(void);
+volatile sim_reg_t *Sim_FIO0PIN(void);
+volatile sim_reg_t *Sim_FIO0SET(void);
+volatile sim_reg_t *Sim_FIO1CLR(void);
+volatile sim_reg_t *Sim_FIO1MASK(void);
+volatile sim_reg_t *Sim_FIO1PIN(void);
+volatile sim_reg_t *Sim_FIO1SET(void);
+volatile sim_reg_t *Sim_IO0CLR(void);
+volatile sim_reg_t *Sim_IO0PIN(void);
+volatile sim_reg_t *Sim_IO0SET(void);
+volatile sim_reg_t *Sim_IO1CLR(void);
+volatile sim_reg_t *Sim_IO1PIN(void);
+volatile sim_reg_t *Sim_IO1SET(void);
+volatile sim_reg_t *Sim_PCON(void);
+volatile sim_reg_t *Sim_PLL0STAT(void);
+volatile sim_reg_t *Sim_PWMLER(void);
+volatile sim_reg_t *Sim_PWMTC(void);
+volatile sim_reg_t *Sim_SSPDR(void);
+volatile sim_reg_t *Sim_SSPICR(void);
+volatile sim_reg_t *Sim_SSPMIS(void);
+volatile sim_reg_t *Sim_SSPRIS(void);
+volatile sim_reg_t *Sim_SSPSR(void);
+volatile sim_reg_t *Sim_T0TC(void);
+volatile sim_reg_t *Sim_T1TC(void);
+volatile sim_reg_t *Sim_U1IIR(void);
+volatile sim_reg_t *Sim_U1LSR(void);
+volatile sim_reg_t *Sim_U1RBR(void);
+volatile sim_reg_t *Sim_U1THR(void);
+volatile sim_reg_t *Sim_VICIRQStatus(void);
+volatile sim_reg_t *Sim_VICIntEnClr(void);
+volatile sim_reg_t *Sim_VICIntEnable(void);
+volatile sim_reg_t *Sim_VICRawIntr(void);
+
+#define IO0PIN           (*Sim_IO0PIN())
+#define IO0SET           (*Sim_IO0SET())
+#define IO0CLR           (*Sim_IO0CLR())
+#define IO1PIN           (*Sim_IO1PIN())
+#define IO1SET           (*Sim_IO1SET())
+#define IO1CLR           (*Sim_IO1CLR())
+#define FIO0PIN          (*Sim_FIO0PIN())
+#define FIO0SET          (*Sim_FIO0SET())
+#define FIO0CLR          (*Sim_FIO0CLR())
+#define FIO0MASK         (*Sim_FIO0MASK())
+#define FIO1PIN          (*Sim_FIO1PIN())
+#define FIO1SET          (*Sim_FIO1SET())
+#define FIO1CLR          (*Sim_FIO1CLR())
+#define FIO1MASK         (*Sim_FIO1MASK())
+#define PCON             (*Sim_PCON())
+#define PLL0STAT         (*Sim_PLL0STAT())
+#define T0TC             (*Sim_T0TC())
+#define T1TC             (*Sim_T1TC())
+#define PWMTC            (*Sim_PWMTC())
+#define PWMLER           (*Sim_PWMLER())
+#define U1RBR            (*Sim_U1RBR())
+#define U1THR            (*Sim_U1THR())
+#define U1LSR            (*Sim_U1LSR())
+#define U1IIR            (*Sim_U1IIR())
+#define AD0GDR           (*Sim_AD0GDR())
+#define AD0DR0           (*Sim_AD0DR(0))
+#define AD0DR1           (*Sim_AD0DR(1))
+#define AD0DR2           (*Sim_AD0DR(2))
+#define AD0DR3           (*Sim_AD0DR(3))
+#define AD0DR4           (*Sim_AD0DR(4))
+#define AD0DR5           (*Sim_AD0DR(5))
+#define AD0DR6           (*Sim_AD0DR(6))
+#define AD0DR7           (*Sim_AD0DR(7))
+#define AD1GDR           (*Sim_AD1GDR())
+#define AD1DR0           (*Sim_AD1DR(0))
+#define AD1DR1           (*Sim_AD1DR(1))
+#define AD1DR2           (*Sim_AD1DR(2))
+#define AD1DR3           (*Sim_AD1DR(3))
+#define AD1DR4           (*Sim_AD1DR(4))
+#define AD1DR5           (*Sim_AD1DR(5))
+#define AD1DR6           (*Sim_AD1DR(6))
+#define AD1DR7           (*Sim_AD1DR(7))
+#define SSPDR            (*Sim_SSPDR())
+#define SSPSR            (*Sim_SSPSR())
+#define SSPRIS           (*Sim_SSPRIS())
+#define SSPMIS           (*Sim_SSPMIS())
+#define SSPICR           (*Sim_SSPICR())
+#define CTIME0           (*Sim_CTIME0())
+#define CTIME1           (*Sim_CTIME1())
+#define VICIntEnable     (*Sim_VICIntEnable())
+#define VICIntEnClr      (*Sim_VICIntEnClr())
+#define VICIRQStatus     (*Sim_VICIRQStatus())
+#define VICRawIntr       (*Sim_VICRawIntr())
+
+// --- Firmware Hooks (see perf_probe.h, iap_flash.h, vic.h) ---
+void Sim_Mark(uint8_t id);
+void Sim_NestEnter(void);
+void Sim_NestExit(void);
+void Perf_Mark(uint8_t id);
+const void *Sim_FlashPtr(unsigned long addr);
+
+#define PERF_MARK(id)          (Sim_Mark(id), Perf_Mark(id))
+#define IAP_FLASH_PTR(addr)    Sim_FlashPtr(addr)
+#define VIC_NEST_ENTER         Sim_NestEnter()
+#define VIC_NEST_EXIT          Sim_NestExit()
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * File        : sim.h
+ * Description : Internal interface between the simulator modules.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include "LPC214X.h"
+
+// --- Board / Model Constants ---
+#define SIM_XTAL_HZ          12000000UL
+#define SIM_VREF_MV          3300
+#define SIM_PS_PER_SEC       1000000000000ULL
+#define SIM_APB_CYCLES       4          // Legacy APB register access (CCLK)
+#define SIM_FIO_CYCLES       1          // Fast GPIO access on the local bus (CCLK)
+#define SIM_IRQ_CYCLES       40         // IRQ entry + exit overhead (CCLK)
+#define SIM_NEST_CYCLES      8          // VIC_NEST_ENTER / EXIT sequence (each)
+#define SIM_POLL_CYCLES      60         // Cost of one idle poll of a status register
+#define SIM_IDLE_STEP_PS     1000000ULL // Peripheral step while the core is in Idle mode
+#define SIM_FLASH_BASE       0x0007A000UL
+#define SIM_FLASH_SIZE       0x3000UL   // Sectors 24-26
+#define SIM_ERASE_MS         100
+#define SIM_PROGRAM_MS       1
+#define SIM_SPI_CS_PIN       20         // P0.20: SPI NOR chip select (active low)
+#define SIM_SPI_SIZE         0x100000UL // 1MB 25-series NOR (W25Q80 class)
+#define SIM_SPI_JEDEC_ID     0xEF4014UL
+#define SIM_SPI_PP_US        700        // Page program
+#define SIM_SPI_SE_MS        45         // 4KB sector erase
+
+// --- VIC Channels ---
+#define SIM_VIC_TIMER0       4
+#define SIM_VIC_TIMER1       5
+#define SIM_VIC_UART1        7
+#define SIM_VIC_PWM          8
+#define SIM_VIC_SSP          11
+#define SIM_VIC_RTC          13
+#define SIM_VIC_AD0          18
+#define SIM_VIC_AD1          21
+
+// --- Time Accounting Categories ---
+enum {
+    SIM_CAT_BUSY = 0,       // Register accesses in application code
+    SIM_CAT_DELAY,          // Spinning on a timer (delayms)
+    SIM_CAT_UART,           // Spinning on UART status
+    SIM_CAT_IRQ,            // Interrupt handlers incl. entry/exit
+    SIM_CAT_FLASH,          // IAP erase/program (IRQs masked)
+    SIM_CAT_IDLE,           // Core halted in Idle mode (PCON.IDL)
+    SIM_CAT_COUNT
+};
+
+// Virtual time is kept in picoseconds so CCLK/PCLK may change at runtime
+extern uint64_t sim_time_ps;                  // Virtual time since reset
+extern uint64_t sim_cat_ps[SIM_CAT_COUNT];
+extern uint64_t sim_end_ps;                   // Scenario end (0 = none)
+
+#define SIM_MS(ms)           ((uint64_t)(ms) * 1000000000ULL)
+#define SIM_TO_MS(ps)        ((double)(ps) / 1e9)
+#define SIM_TO_US(ps)        ((double)(ps) / 1e6)
+
+uint32_t Sim_CCLK(void);
+uint32_t Sim_PCLK(void);
+void Sim_Advance(uint32_t cycles, int cat);   // CPU cycles at current CCLK
+void Sim_AdvancePs(uint64_t ps, int cat);
+void Sim_Sync(void);
+void Sim_Reset(void);
+
+// --- Stimulus (sim_main.c -> models) ---
+void Sim_KeyPress(char key, uint32_t hold_ms);
+void Sim_UartInput(const char *bytes, int len);
+
+// --- Callbacks (models -> sim_main.c) ---
+void Sim_OnTime(void);                        // Scenario events due
+uint16_t Sim_OnAdcInput(int adc, int ch);     // Millivolts at AD<adc>.<ch>
+void Sim_OnUartOutput(uint8_t byte);
+void Sim_OnLcdWrite(uint8_t rs, uint8_t value);
+void Sim_OnPwmDuty(uint32_t match, uint32_t period);
+void Sim_OnEnd(void);                         // Virtual end time reached
+
+// --- LCD Model State ---
+extern char sim_lcd[2][17];
+
+// --- Flash Stand-In (sim_iap.c) ---
+extern uint8_t sim_flash[SIM_FLASH_SIZE];
+int Sim_FlashLoad(const char *path);
+int Sim_FlashSave(const char *path);
+
+// --- SPI NOR Stand-In (sim_spiflash.c), on the SSP bus ---
+extern uint32_t sim_spi_read, sim_spi_programmed, sim_spi_erased;
+void Sim_SpiSelect(int active);               // CS pin edge
+uint8_t Sim_SpiExchange(uint8_t mosi);        // One full-duplex byte
+int Sim_SpiFlashLoad(const char *path);
+int Sim_SpiFlashSave(const char *path);
+
+#endif
@@ -0,0 +1,1064 @@
+/*
+ * File        : sim_core.c
+ * Description : LPC2148 peripheral models driven by virtual time.
+ *
+ * MODEL:
+ * - Virtual time only advances when the firmware touches a modelled
+ *   register (SIM_APB_CYCLES per access, SIM_POLL_CYCLES for status polls)
+ *   or when a stand-in (IAP) charges time explicitly. Pure computation is
+ *   free in virtual time; sim_main.c reports host CPU time for that.
+ * - Every side-effect access runs Sim_Sync(): apply the previous pending
+ *   write, step Timer0/1, PWM, ADC, RTC and UART1 to "now", feed due
+ *   scenario events, then dispatch VIC interrupts (vectored slots in
+ *   priority order). A handler that opens VIC_NEST_ENTER() can be
+ *   preempted by higher slots at its next register access.
+ * - Interrupt sources are edge-latched into the VIC raw status and cleared
+ *   on dispatch; UART1 RX/THRE are re-evaluated as levels on every step.
+ * - Write-1-to-set/clear registers (IOxSET/IOxCLR, FIOxSET/FIOxCLR,
+ *   VICIntEnable/EnClr, PWMLER, U1THR) and FIOxPIN return a latch that
+ *   is applied at the next access, so only one side-effect register may
+ *   be used per C expression.
+ * - PCON.IDL halts the core: the peripherals are stepped in
+ *   SIM_IDLE_STEP_PS slices until an enabled interrupt is raised.
+ * - SCS selects legacy (IOxxx, APB) or fast (FIOxxx, local bus) GPIO per
+ *   port. Writes through the inactive register set still cost time but
+ *   do not reach the pins, as on the chip.
+ * - AD0 and AD1 share one model: burst scans, software START, and
+ *   hardware START on the external match outputs (EMR) of Timer0/1,
+ *   timed from the match inside the current step.
+ * - SSP shifts one frame per CPSDVSR * (SCR + 1) * bits PCLK ticks
+ *   through the SPI NOR stand-in selected by P0.20. SSPDR reads return
+ *   the frame with SIM_SSP_READ set (the firmware narrows it to the frame
+ *   size), so the latch can tell a read from a write of the same value.
+ */
+
+#include <string.h>
+#include "sim.h"
+
+// --- Plain Register Storage ---
+#define SIM_REG(name) volatile sim_reg_t sim_##name;
+#include "sim_regs.def"
+#undef SIM_REG
+
+uint64_t sim_time_ps = 0;
+uint64_t sim_cat_ps[SIM_CAT_COUNT];
+uint64_t sim_end_ps = 0;
+
+#define SIM_SSP_READ  (1UL << 31)
+
+static int in_isr = 0;
+static int in_sync = 0;
+
+// ============================================================
+// Clocks
+// ============================================================
+
+uint32_t Sim_CCLK(void)
+{
+    if((PLL0CON & 0x03) == 0x03) return SIM_XTAL_HZ * ((PLL0CFG & 0x1F) + 1);
+    return SIM_XTAL_HZ;
+}
+
+uint32_t Sim_PCLK(void)
+{
+    static const uint8_t div[4] = { 4, 1, 2, 4 };
+    return Sim_CCLK() / div[VPBDIV & 0x03];
+}
+
+void Sim_AdvancePs(uint64_t ps, int cat)
+{
+    sim_time_ps += ps;
+    sim_cat_ps[in_isr ? SIM_CAT_IRQ : cat] += ps;
+}
+
+void Sim_Advance(uint32_t cycles, int cat)
+{
+    Sim_AdvancePs((uint64_t)cycles * SIM_PS_PER_SEC / Sim_CCLK(), cat);
+}
+
+// PCLK ticks elapsed since the previous step (rebased on clock changes)
+static uint64_t pclk_base_ps = 0;
+static uint64_t pclk_done = 0;
+static uint32_t pclk_hz = 0;
+
+static uint64_t Sim_PclkTicks(void)
+{
+    uint64_t total;
+
+    if(Sim_PCLK() != pclk_hz) {
+        pclk_hz = Sim_PCLK();
+        pclk_base_ps = sim_time_ps;
+        pclk_done = 0;
+    }
+    total = (uint64_t)((unsigned __int128)(sim_time_ps - pclk_base_ps) * pclk_hz / SIM_PS_PER_SEC);
+    total -= pclk_done;
+    pclk_done += total;
+    return total;
+}
+
+// ============================================================
+// VIC
+// ============================================================
+
+static sim_reg_t vic_raw = 0;
+static sim_reg_t vic_enable = 0;
+
+volatile sim_reg_t sim_VICVectAddrN[16];
+volatile sim_reg_t sim_VICVectCntlN[16];
+
+static void Sim_Raise(int ch)
+{
+    vic_raw |= (1UL << ch);
+}
+
+// Slot of the handler running now (16 = non-vectored, SIM_SLOT_NONE = none)
+#define SIM_SLOT_NONE  17
+
+static int cur_slot = SIM_SLOT_NONE;
+static int nest_open = 0;               // Running handler re-enabled IRQs
+
+static void Sim_Dispatch(void)
+{
+    int guard, slot, ch, prev_slot, prev_nest;
+    sim_reg_t active, fn;
+
+    for(guard = 0; guard < 64; guard++)
+    {
+        active = vic_raw & vic_enable & ~VICIntSelect;
+        if(!active) return;
+
+        // Highest vectored slot first; only above the running handler
+        fn = 0; ch = -1;
+        for(slot = 0; slot < 16 && slot < cur_slot; slot++) {
+            if((sim_VICVectCntlN[slot] & 0x20) && (active & (1UL << (sim_VICVectCntlN[slot] & 0x1F)))) {
+                ch = sim_VICVectCntlN[slot] & 0x1F;
+                fn = sim_VICVectAddrN[slot];
+                break;
+            }
+        }
+        if(ch < 0) {                       // Non-vectored
+            if(cur_slot != SIM_SLOT_NONE) return;
+            for(ch = 0; !(active & (1UL << ch)); ch++);
+            fn = VICDefVectAddr;
+        }
+
+        vic_raw &= ~(1UL << ch);
+        if(!fn) continue;
+
+        prev_slot = cur_slot;
+        prev_nest = nest_open;
+        cur_slot = slot;
+        nest_open = 0;
+        in_isr++;
+        Sim_Advance(SIM_IRQ_CYCLES, SIM_CAT_IRQ);
+        ((void (*)(void))fn)();
+        in_isr--;
+        cur_slot = prev_slot;
+        nest_open = prev_nest;
+    }
+}
+
+// VIC_NEST_ENTER / EXIT: IRQs back on inside a handler, pending higher
+// slots are taken at once
+void Sim_NestEnter(void)
+{
+    Sim_Advance(SIM_NEST_CYCLES, SIM_CAT_IRQ);
+    nest_open = 1;
+    Sim_Sync();
+}
+
+void Sim_NestExit(void)
+{
+    nest_open = 0;
+    Sim_Advance(SIM_NEST_CYCLES, SIM_CAT_IRQ);
+}
+
+// ============================================================
+// Write Latches
+// ============================================================
+
+typedef struct {
+    sim_reg_t value;
+    sim_reg_t preload;
+    void (*apply)(sim_reg_t value);
+    void (*read)(void);                 // Access left the value untouched
+} Sim_Latch;
+
+static Sim_Latch *pending = 0;
+
+static void Sim_ApplyPending(void)
+{
+    Sim_Latch *l = pending;
+
+    pending = 0;
+    if(l && l->value != l->preload) l->apply(l->value);
+    else if(l && l->read) l->read();
+}
+
+// ============================================================
+// GPIO, LCD and Keypad
+// ============================================================
+
+static sim_reg_t io_out[2];
+static int spi_cs = 0;
+
+char sim_lcd[2][17];
+static struct {
+    uint8_t four_bit;
+    uint8_t have_high;
+    uint8_t high;
+    uint8_t addr;
+} lcd;
+
+static struct {
+    int active;
+    int row, col;
+    uint64_t until_ps;
+} key;
+
+static const char keymap[4][4] = {
+    { '7', '8', '9', '/' },
+    { '4', '5', '6', '*' },
+    { '1', '2', '3', '-' },
+    { 'C', '0', '=', '+' }
+};
+
+static void Lcd_Byte(uint8_t rs, uint8_t v)
+{
+    if(rs) {
+        if((v >= 0x20) && (lcd.addr & 0x3F) < 16) sim_lcd[lcd.addr >= 0x40][lcd.addr & 0x3F] = v;
+        lcd.addr++;
+    }
+    else if(v == 0x01) { memset(sim_lcd, ' ', sizeof(sim_lcd)); sim_lcd[0][16] = sim_lcd[1][16] = 0; lcd.addr = 0; }
+    else if(v == 0x02) lcd.addr = 0;
+    else if(v & 0x80)  lcd.addr = v & 0x7F;
+
+    Sim_OnLcdWrite(rs, v);
+}
+
+// HD44780 on P0.0 (RS), P0.2 (EN), P0.4-P0.7 (D4-D7): latch on EN falling edge
+static void Lcd_Port(sim_reg_t old_out, sim_reg_t new_out)
+{
+    uint8_t rs = new_out & 0x01;
+    uint8_t nib = (new_out >> 4) & 0x0F;
+
+    if(!((old_out & (1 << 2)) && !(new_out & (1 << 2)))) return;
+
+    if(!lcd.four_bit) {
+        // 8-bit interface, only D7-D4 wired: function set 0x2x selects 4-bit
+        if(!rs && (nib & 0x0F) == 0x02) { lcd.four_bit = 1; lcd.have_high = 0; }
+        return;
+    }
+    if(!lcd.have_high) { lcd.high = nib; lcd.have_high = 1; return; }
+    lcd.have_high = 0;
+    Lcd_Byte(rs, (lcd.high << 4) | nib);
+}
+
+static int Gpio_Fast(int port)
+{
+    return (SCS >> port) & 1;
+}
+
+static sim_reg_t Gpio_Dir(int port)
+{
+    if(Gpio_Fast(port)) return port ? FIO1DIR : FIO0DIR;
+    return port ? IODIR1 : IODIR0;
+}
+
+static void Gpio_Write(int port, sim_reg_t value)
+{
+    sim_reg_t old = io_out[port];
+
+    io_out[port] = value;
+    if(port == 0) Lcd_Port(old, value);
+
+    // SPI NOR chip select: driven output, low = selected
+    if(port == 0 && ((Gpio_Dir(0) & ~value) >> SIM_SPI_CS_PIN & 1) != spi_cs) {
+        spi_cs = !spi_cs;
+        Sim_SpiSelect(spi_cs);
+    }
+}
+
+static void Gpio_Legacy(int port, sim_reg_t set, sim_reg_t clr)
+{
+    if(!Gpio_Fast(port)) Gpio_Write(port, (io_out[port] | set) & ~clr);
+}
+
+// Fast GPIO: FIOxMASK bits set = pin untouched by PIN/SET/CLR
+static void Gpio_FastWrite(int port, sim_reg_t set, sim_reg_t clr)
+{
+    sim_reg_t keep = port ? sim_FIO1MASK : sim_FIO0MASK;
+
+    if(Gpio_Fast(port)) Gpio_Write(port, (io_out[port] | (set & ~keep)) & ~(clr & ~keep));
+}
+
+static void Apply_IO0SET(sim_reg_t v)  { Gpio_Legacy(0, v, 0); }
+static void Apply_IO0CLR(sim_reg_t v)  { Gpio_Legacy(0, 0, v); }
+static void Apply_IO1SET(sim_reg_t v)  { Gpio_Legacy(1, v, 0); }
+static void Apply_IO1CLR(sim_reg_t v)  { Gpio_Legacy(1, 0, v); }
+static void Apply_FIO0SET(sim_reg_t v) { Gpio_FastWrite(0, v, 0); }
+static void Apply_FIO0CLR(sim_reg_t v) { Gpio_FastWrite(0, 0, v); }
+static void Apply_FIO1SET(sim_reg_t v) { Gpio_FastWrite(1, v, 0); }
+static void Apply_FIO1CLR(sim_reg_t v) { Gpio_FastWrite(1, 0, v); }
+static void Apply_FIO0PIN(sim_reg_t v) { Gpio_FastWrite(0, v, ~v); }
+static void Apply_FIO1PIN(sim_reg_t v) { Gpio_FastWrite(1, v, ~v); }
+
+static Sim_Latch latch_io0set  = { 0, 0, Apply_IO0SET };
+static Sim_Latch latch_io0clr  = { 0, 0, Apply_IO0CLR };
+static Sim_Latch latch_io1set  = { 0, 0, Apply_IO1SET };
+static Sim_Latch latch_io1clr  = { 0, 0, Apply_IO1CLR };
+static Sim_Latch latch_fio0set = { 0, 0, Apply_FIO0SET };
+static Sim_Latch latch_fio0clr = { 0, 0, Apply_FIO0CLR };
+static Sim_Latch latch_fio1set = { 0, 0, Apply_FIO1SET };
+static Sim_Latch latch_fio1clr = { 0, 0, Apply_FIO1CLR };
+static Sim_Latch latch_fio0pin = { 0, 0, Apply_FIO0PIN };
+static Sim_Latch latch_fio1pin = { 0, 0, Apply_FIO1PIN };
+
+static sim_reg_t Gpio_Inputs(int port)
+{
+    sim_reg_t in = 0xFFFFFFFF;              // Pull-ups
+    int pin;
+
+    if(port == 1 && key.active && sim_time_ps < key.until_ps) {
+        pin = 16 + key.row;
+        if((Gpio_Dir(1) & (1UL << pin)) && !(io_out[1] & (1UL << pin))) in &= ~(1UL << (20 + key.col));
+    }
+    return in;
+}
+
+void Sim_KeyPress(char k, uint32_t hold_ms)
+{
+    int r, c;
+
+    for(r = 0; r < 4; r++) {
+        for(c = 0; c < 4; c++) {
+            if(keymap[r][c] == k) {
+                key.active = 1; key.row = r; key.col = c;
+                key.until_ps = sim_time_ps + SIM_MS(hold_ms);
+                return;
+            }
+        }
+    }
+}
+
+// ============================================================
+// Timers (Timer0, Timer1, PWM)
+// ============================================================
+
+typedef struct {
+    volatile sim_reg_t *tcr, *pr, *pc, *mcr, *ir;
+    volatile sim_reg_t *mr[4];
+    sim_reg_t tc;
+    int vic;
+    void (*on_reset)(void);
+    volatile sim_reg_t *emr;            // External match outputs (0 = none)
+    int adc_start[4];                   // ADCR START code per MAT output (0 = none)
+} Sim_Timer;
+
+static void Pwm_OnReset(void);
+static void Adc_MatchEdge(int start, int level, uint64_t before);
+
+static Sim_Timer t0 = { &sim_T0TCR, &sim_T0PR, &sim_T0PC, &sim_T0MCR, &sim_T0IR,
+                        { &sim_T0MR0, &sim_T0MR1, &sim_T0MR2, &sim_T0MR3 }, 0, SIM_VIC_TIMER0, 0,
+                        &sim_T0EMR, { 0, 4, 0, 5 } };
+static Sim_Timer t1 = { &sim_T1TCR, &sim_T1PR, &sim_T1PC, &sim_T1MCR, &sim_T1IR,
+                        { &sim_T1MR0, &sim_T1MR1, &sim_T1MR2, &sim_T1MR3 }, 0, SIM_VIC_TIMER1, 0,
+                        &sim_T1EMR, { 6, 7, 0, 0 } };
+static Sim_Timer pwm = { &sim_PWMTCR, &sim_PWMPR, &sim_PWMPC, &sim_PWMMCR, &sim_PWMIR,
+                         { &sim_PWMMR0, &sim_PWMMR1, &sim_PWMMR2, &sim_PWMMR3 }, 0, SIM_VIC_PWM, Pwm_OnReset,
+                         0, { 0, 0, 0, 0 } };
+
+static sim_reg_t Timer_Emc(Sim_Timer *t, int i)
+{
+    return t->emr ? (*t->emr >> (4 + 2 * i)) & 0x03 : 0;
+}
+
+// EMR action on a match; an edge on MAT0.1/0.3/1.0/1.1 can start the ADCs
+static void Timer_External(Sim_Timer *t, int i, uint64_t before)
+{
+    sim_reg_t emc = Timer_Emc(t, i), old = *t->emr & (1UL << i);
+
+    if(emc == 1) *t->emr &= ~(1UL << i);
+    else if(emc == 2) *t->emr |= (1UL << i);
+    else if(emc == 3) *t->emr ^= (1UL << i);
+
+    if((*t->emr & (1UL << i)) != old && t->adc_start[i])
+        Adc_MatchEdge(t->adc_start[i], (*t->emr >> i) & 1, before);
+}
+
+static void Timer_Step(Sim_Timer *t, uint64_t ticks)
+{
+    uint64_t pre, incs, d, best, first, used = 0;
+    int i, hit;
+
+    if(*t->tcr & 0x02) { t->tc = 0; *t->pc = 0; return; }    // Held in reset
+    if(!(*t->tcr & 0x01) || ticks == 0) return;
+
+    // Prescaler
+    pre = (uint64_t)*t->pr + 1;
+    if(*t->pc + ticks < pre) { *t->pc += ticks; return; }
+    first = pre - *t->pc;                                   // Ticks to the first increment
+    ticks -= first;
+    incs = 1 + ticks / pre;
+    *t->pc = ticks % pre;
+
+    // TC increments, stopping at each enabled match
+    while(incs)
+    {
+        best = incs + 1; hit = -1;
+        for(i = 0; i < 4; i++) {
+            if((!((*t->mcr >> (3 * i)) & 0x07) && !Timer_Emc(t, i)) || *t->mr[i] <= t->tc) continue;
+            d = *t->mr[i] - t->tc;
+            if(d < best) { best = d; hit = i; }
+        }
+        if(hit < 0 || best > incs) { t->tc += incs; return; }
+
+        t->tc += best;
+        incs -= best;
+        used += best;
+        if(Timer_Emc(t, hit)) Timer_External(t, hit, first + (used - 1) * pre);
+        *t->ir |= (1UL << hit);
+        if((*t->mcr >> (3 * hit)) & 0x01) Sim_Raise(t->vic);
+        if((*t->mcr >> (3 * hit)) & 0x02) { t->tc = 0; if(t->on_reset && hit == 0) t->on_reset(); }
+        if((*t->mcr >> (3 * hit)) & 0x04) { *t->tcr &= ~0x01UL; return; }
+
+        // Long idle stretch at a periodic reset: keep only the phase
+        if(t->tc == 0 && *t->mr[hit] && incs > 16 * (uint64_t)*t->mr[hit]) incs %= *t->mr[hit];
+    }
+}
+
+// PWM shadow registers: PWMLER latches MR0/MR5 at the next period start
+static sim_reg_t pwm_ler = 0;
+static sim_reg_t pwm_mr0_active = 0;
+static sim_reg_t pwm_mr5_active = 0;
+
+static void Pwm_OnReset(void)
+{
+    sim_reg_t mr0 = pwm_mr0_active, mr5 = pwm_mr5_active;
+
+    if(pwm_ler & (1 << 0)) mr0 = PWMMR0;
+    if(pwm_ler & (1 << 5)) mr5 = PWMMR5;
+    pwm_ler = 0;
+
+    if(mr0 != pwm_mr0_active || mr5 != pwm_mr5_active) {
+        pwm_mr0_active = mr0;
+        pwm_mr5_active = mr5;
+        if(PWMPCR & (1 << 13)) Sim_OnPwmDuty(mr5, mr0 + 1);   // Period = MR0 + 1 counts
+    }
+}
+
+static void Apply_PWMLER(sim_reg_t v) { pwm_ler |= v; }
+static Sim_Latch latch_pwmler = { 0, 0, Apply_PWMLER };
+
+// ============================================================
+// ADC (AD0, AD1)
+// ============================================================
+
+static struct {
+    int64_t acc;                        // Ticks into the current conversion
+    int ch;
+    int busy;
+    sim_reg_t last_start;
+    sim_reg_t dr[8];
+    sim_reg_t gdr;
+    sim_reg_t scratch;
+} adc[2];
+
+static volatile sim_reg_t *const adc_cr[2]    = { &sim_AD0CR, &sim_AD1CR };
+static volatile sim_reg_t *const adc_inten[2] = { &sim_AD0INTEN, &sim_AD1INTEN };
+static const int adc_vic[2] = { SIM_VIC_AD0, SIM_VIC_AD1 };
+
+static void Adc_Complete(int n, int ch)
+{
+    uint32_t counts = (uint32_t)Sim_OnAdcInput(n, ch) * 1024 / SIM_VREF_MV;
+    sim_reg_t v;
+
+    if(counts > 1023) counts = 1023;
+    v = (counts << 6) | (1UL << 31);
+    if(adc[n].dr[ch] & (1UL << 31)) v |= (1UL << 30);      // OVERRUN
+    adc[n].dr[ch] = v;
+    adc[n].gdr = v | ((sim_reg_t)ch << 24);
+
+    if((*adc_inten[n] & (1UL << ch)) || (*adc_inten[n] & 0x100)) Sim_Raise(adc_vic[n]);
+}
+
+static int Adc_NextChannel(sim_reg_t sel, int ch)
+{
+    int i;
+    for(i = 1; i <= 8; i++) if(sel & (1UL << ((ch + i) & 7))) return (ch + i) & 7;
+    return ch;
+}
+
+// Edge on a MAT output, 'before' ticks into the step that Adc_Step is
+// about to apply: the conversion is timed from the edge, not the step
+static void Adc_MatchEdge(int start, int level, uint64_t before)
+{
+    sim_reg_t cr;
+    int n;
+
+    for(n = 0; n < 2; n++)
+    {
+        cr = *adc_cr[n];
+        if(!(cr & (1UL << 21)) || (cr & (1UL << 16)) || (int)((cr >> 24) & 0x07) != start) continue;
+        if(level == (int)((cr >> 27) & 1)) continue;        // EDGE: 0 rising, 1 falling
+        adc[n].busy = 1;
+        adc[n].acc = -(int64_t)before;
+        adc[n].ch = Adc_NextChannel(cr & 0xFF, 7);
+    }
+}
+
+static void Adc_Step(int n, uint64_t ticks)
+{
+    sim_reg_t cr = *adc_cr[n];
+    sim_reg_t sel = cr & 0xFF;
+    sim_reg_t start = (cr >> 24) & 0x07;
+    int64_t conv = (int64_t)(((cr >> 8) & 0xFF) + 1) * (11 - ((cr >> 17) & 0x07));
+    int burst = (cr >> 16) & 1;
+    int k = 0;
+
+    if(!(cr & (1UL << 21)) || sel == 0) { adc[n].busy = 0; return; }
+
+    if(!burst) {
+        if(start == 1 && adc[n].last_start != 1) {         // Software START
+            adc[n].busy = 1; adc[n].acc = 0; adc[n].ch = Adc_NextChannel(sel, 7);
+        }
+        adc[n].last_start = start;
+        if(!adc[n].busy) return;
+    }
+    else if(!adc[n].busy) {
+        adc[n].busy = 1; adc[n].acc = 0; adc[n].ch = Adc_NextChannel(sel, 7);
+    }
+
+    adc[n].acc += (int64_t)ticks;
+    if(adc[n].acc > conv * 64) adc[n].acc = conv * 8 + adc[n].acc % conv;  // Skip stale scans
+
+    while(adc[n].acc >= conv && k++ < 64)
+    {
+        adc[n].acc -= conv;
+        Adc_Complete(n, adc[n].ch);
+        if(!burst) { adc[n].busy = 0; return; }
+        adc[n].ch = Adc_NextChannel(sel, adc[n].ch);
+    }
+}
+
+// ============================================================
+// RTC
+// ============================================================
+
+static uint64_t rtc_acc = 0;
+
+static void Rtc_Second(void)
+{
+    sim_reg_t inc = 0x01;
+
+    if(++SEC > 59) { SEC = 0; inc |= 0x02;
+        if(++MIN > 59) { MIN = 0; inc |= 0x04;
+            if(++HOUR > 23) { HOUR = 0; inc |= 0x08; DOW = (DOW + 1) % 7; DOM++; DOY++; }
+        }
+    }
+    if(CIIR & inc) { ILR |= 0x01; Sim_Raise(SIM_VIC_RTC); }
+}
+
+static void Rtc_Step(uint64_t ticks)
+{
+    uint64_t period;
+
+    if(!(CCR & 0x01)) return;
+    period = (CCR & 0x10) ? pclk_hz
+                          : ((uint64_t)(PREINT + 1) * 32768 + PREFRAC);
+    if(period == 0) return;
+
+    rtc_acc += ticks;
+    while(rtc_acc >= period) { rtc_acc -= period; Rtc_Second(); }
+}
+
+// ============================================================
+// UART1
+// ============================================================
+
+#define SIM_RX_QUEUE  4096
+
+static struct {
+    uint8_t  rx[16];
+    int      rx_n;
+    uint8_t  tx[16];
+    int      tx_n;
+    uint64_t tx_acc;
+    uint8_t  in[SIM_RX_QUEUE];
+    uint64_t in_ps[SIM_RX_QUEUE];
+    int      in_head, in_tail;
+    uint64_t last_rx_ps;
+    uint8_t  oe;
+    uint8_t  thre_int;
+    sim_reg_t scratch;
+} u1;
+
+static uint64_t Uart_CharTicks(void)
+{
+    uint64_t div = (U1DLM << 8) | U1DLL;
+    return 16 * (div ? div : 1) * 10;                       // 8N1 = 10 bits
+}
+
+static uint64_t Uart_CharPs(void)
+{
+    return Uart_CharTicks() * SIM_PS_PER_SEC / Sim_PCLK();
+}
+
+static int Uart_Trigger(void)
+{
+    static const int level[4] = { 1, 4, 8, 14 };
+    return level[(U1FCR >> 6) & 0x03];
+}
+
+static int Uart_Timeout(void)
+{
+    return u1.rx_n > 0 && sim_time_ps - u1.last_rx_ps >= 4 * Uart_CharPs();
+}
+
+void Sim_UartInput(const char *bytes, int len)
+{
+    uint64_t t = sim_time_ps;
+    int prev = (u1.in_tail + SIM_RX_QUEUE - 1) % SIM_RX_QUEUE;
+
+    if(u1.in_head != u1.in_tail && u1.in_ps[prev] > t) t = u1.in_ps[prev];
+    while(len-- > 0) {
+        t += Uart_CharPs();
+        u1.in[u1.in_tail] = (uint8_t)*bytes++;
+        u1.in_ps[u1.in_tail] = t;
+        u1.in_tail = (u1.in_tail + 1) % SIM_RX_QUEUE;
+    }
+}
+
+static void Uart_Step(uint64_t ticks)
+{
+    uint64_t ct = Uart_CharTicks();
+
+    // TX: drain one character per frame time
+    if(u1.tx_n) {
+        u1.tx_acc += ticks;
+        while(u1.tx_n && u1.tx_acc >= ct) {
+            u1.tx_acc -= ct;
+            Sim_OnUartOutput(u1.tx[0]);
+            memmove(u1.tx, u1.tx + 1, --u1.tx_n);
+        }
+        if(!u1.tx_n) { u1.tx_acc = 0; if(U1IER & 0x02) u1.thre_int = 1; }
+    }
+
+    // RX: scripted bytes arrive at their scheduled time
+    while(u1.in_head != u1.in_tail && u1.in_ps[u1.in_head] <= sim_time_ps) {
+        if(u1.rx_n < 16) u1.rx[u1.rx_n++] = u1.in[u1.in_head];
+        else u1.oe = 1;
+        u1.last_rx_ps = u1.in_ps[u1.in_head];
+        u1.in_head = (u1.in_head + 1) % SIM_RX_QUEUE;
+    }
+
+    if((U1IER & 0x01) && (u1.rx_n >= Uart_Trigger() || Uart_Timeout())) Sim_Raise(SIM_VIC_UART1);
+    if((U1IER & 0x04) && u1.oe) Sim_Raise(SIM_VIC_UART1);
+    if(u1.thre_int) Sim_Raise(SIM_VIC_UART1);
+}
+
+static void Apply_U1THR(sim_reg_t v)
+{
+    if(u1.tx_n < 16) u1.tx[u1.tx_n++] = (uint8_t)v;
+    u1.thre_int = 0;
+}
+static Sim_Latch latch_u1thr = { ~0UL, ~0UL, Apply_U1THR };
+
+// ============================================================
+// SSP (SPI1)
+// ============================================================
+
+static struct {
+    uint16_t tx[8];
+    int      tx_n;
+    uint16_t rx[8];
+    int      rx_n;
+    uint64_t acc;                       // PCLK ticks into the current frame
+    uint64_t last_rx_ps;                // RX timeout reference
+    uint8_t  ror;
+    sim_reg_t scratch;
+} ssp;
+
+static uint64_t Ssp_BitTicks(void)
+{
+    uint64_t cpsr = SSPCPSR & 0xFE;
+
+    return (cpsr ? cpsr : 2) * (((SSPCR0 >> 8) & 0xFF) + 1);
+}
+
+static sim_reg_t Ssp_Raw(void)
+{
+    sim_reg_t ris = ssp.ror ? 0x01 : 0;
+
+    // RX timeout: data waiting, nothing shifting, 32 bit times without a read
+    if(ssp.rx_n && !ssp.tx_n &&
+       sim_time_ps - ssp.last_rx_ps >= 32 * Ssp_BitTicks() * SIM_PS_PER_SEC / Sim_PCLK()) ris |= 0x02;
+    if(ssp.rx_n >= 4) ris |= 0x04;
+    if(ssp.tx_n <= 4) ris |= 0x08;
+    return ris;
+}
+
+static void Ssp_Step(uint64_t ticks)
+{
+    uint64_t frame = Ssp_BitTicks() * ((SSPCR0 & 0x0F) + 1);
+    uint16_t in;
+
+    if(!(SSPCR1 & 0x02)) return;
+
+    if(ssp.tx_n) {
+        ssp.acc += ticks;
+        while(ssp.tx_n && ssp.acc >= frame) {
+            ssp.acc -= frame;
+            in = Sim_SpiExchange((uint8_t)ssp.tx[0]);
+            memmove(ssp.tx, ssp.tx + 1, --ssp.tx_n * sizeof(ssp.tx[0]));
+            if(ssp.rx_n < 8) ssp.rx[ssp.rx_n++] = in;
+            else ssp.ror = 1;
+            ssp.last_rx_ps = sim_time_ps;
+        }
+        if(!ssp.tx_n) ssp.acc = 0;
+    }
+
+    if(Ssp_Raw() & SSPIMSC) Sim_Raise(SIM_VIC_SSP);
+}
+
+static void Apply_SSPDR(sim_reg_t v)
+{
+    if(ssp.tx_n < 8) ssp.tx[ssp.tx_n++] = (uint16_t)v;
+}
+
+static void Read_SSPDR(void)
+{
+    if(ssp.rx_n) memmove(ssp.rx, ssp.rx + 1, --ssp.rx_n * sizeof(ssp.rx[0]));
+    ssp.last_rx_ps = sim_time_ps;
+}
+
+static void Apply_SSPICR(sim_reg_t v)
+{
+    if(v & 0x01) ssp.ror = 0;
+    if(v & 0x02) ssp.last_rx_ps = sim_time_ps;
+}
+
+static Sim_Latch latch_sspdr  = { 0, 0, Apply_SSPDR, Read_SSPDR };
+static Sim_Latch latch_sspicr = { 0, 0, Apply_SSPICR };
+
+// ============================================================
+// Synchronisation
+// ============================================================
+
+static void Sim_Step(void)
+{
+    uint64_t ticks = Sim_PclkTicks();
+
+    if(ticks == 0) return;
+    Timer_Step(&t0, ticks);
+    Timer_Step(&t1, ticks);
+    Timer_Step(&pwm, ticks);
+    Adc_Step(0, ticks);
+    Adc_Step(1, ticks);
+    Rtc_Step(ticks);
+    Uart_Step(ticks);
+    Ssp_Step(ticks);
+}
+
+void Sim_Sync(void)
+{
+    if(in_sync) return;
+    in_sync = 1;
+
+    Sim_ApplyPending();
+    Sim_Step();
+    Sim_OnTime();
+
+    in_sync = 0;
+
+    if(!in_isr || nest_open) Sim_Dispatch();
+    if(sim_end_ps && sim_time_ps >= sim_end_ps && !in_isr) Sim_OnEnd();
+}
+
+static void Sim_Access(uint32_t cycles, int cat)
+{
+    Sim_Advance(cycles, cat);
+    Sim_Sync();
+}
+
+static volatile sim_reg_t *Sim_ArmCycles(Sim_Latch *l, uint32_t cycles)
+{
+    Sim_Access(cycles, SIM_CAT_BUSY);
+    l->value = l->preload;
+    pending = l;
+    return &l->value;
+}
+
+static volatile sim_reg_t *Sim_Arm(Sim_Latch *l)
+{
+    return Sim_ArmCycles(l, SIM_APB_CYCLES);
+}
+
+void Sim_Reset(void)
+{
+    memset(adc, 0, sizeof(adc));
+    memset(&u1, 0, sizeof(u1));
+    memset(&ssp, 0, sizeof(ssp));
+    memset(&lcd, 0, sizeof(lcd));
+    memset(sim_lcd, ' ', sizeof(sim_lcd));
+    sim_lcd[0][16] = sim_lcd[1][16] = 0;
+    AD0INTEN = 0x100;
+    AD1INTEN = 0x100;
+    U1LCR = 0x03;
+    VPBDIV = 0x00;                          // PCLK = CCLK / 4 after reset
+}
+
+// ============================================================
+// Register Accessors (see LPC214X.h)
+// ============================================================
+
+static sim_reg_t scratch;
+
+volatile sim_reg_t *Sim_IO0SET(void) { return Sim_Arm(&latch_io0set); }
+volatile sim_reg_t *Sim_IO0CLR(void) { return Sim_Arm(&latch_io0clr); }
+volatile sim_reg_t *Sim_IO1SET(void) { return Sim_Arm(&latch_io1set); }
+volatile sim_reg_t *Sim_IO1CLR(void) { return Sim_Arm(&latch_io1clr); }
+
+volatile sim_reg_t *Sim_FIO0SET(void) { return Sim_ArmCycles(&latch_fio0set, SIM_FIO_CYCLES); }
+volatile sim_reg_t *Sim_FIO0CLR(void) { return Sim_ArmCycles(&latch_fio0clr, SIM_FIO_CYCLES); }
+volatile sim_reg_t *Sim_FIO1SET(void) { return Sim_ArmCycles(&latch_fio1set, SIM_FIO_CYCLES); }
+volatile sim_reg_t *Sim_FIO1CLR(void) { return Sim_ArmCycles(&latch_fio1clr, SIM_FIO_CYCLES); }
+
+static sim_reg_t Gpio_Pins(int port)
+{
+    sim_reg_t dir = Gpio_Dir(port);
+
+    if(port == 1 && key.active && sim_time_ps >= key.until_ps) key.active = 0;
+    return (io_out[port] & dir) | (Gpio_Inputs(port) & ~dir);
+}
+
+volatile sim_reg_t *Sim_IO0PIN(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = Gpio_Pins(0);
+    return &scratch;
+}
+
+volatile sim_reg_t *Sim_IO1PIN(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = Gpio_Pins(1);
+    return &scratch;
+}
+
+// FIOxPIN reads return 0 in masked bits; a write only changes unmasked pins
+volatile sim_reg_t *Sim_FIO0PIN(void)
+{
+    Sim_ArmCycles(&latch_fio0pin, SIM_FIO_CYCLES);
+    latch_fio0pin.preload = latch_fio0pin.value = Gpio_Pins(0) & ~sim_FIO0MASK;
+    return &latch_fio0pin.value;
+}
+
+volatile sim_reg_t *Sim_FIO1PIN(void)
+{
+    Sim_ArmCycles(&latch_fio1pin, SIM_FIO_CYCLES);
+    latch_fio1pin.preload = latch_fio1pin.value = Gpio_Pins(1) & ~sim_FIO1MASK;
+    return &latch_fio1pin.value;
+}
+
+volatile sim_reg_t *Sim_FIO0MASK(void)
+{
+    Sim_Access(SIM_FIO_CYCLES, SIM_CAT_BUSY);
+    return &sim_FIO0MASK;
+}
+
+volatile sim_reg_t *Sim_FIO1MASK(void)
+{
+    Sim_Access(SIM_FIO_CYCLES, SIM_CAT_BUSY);
+    return &sim_FIO1MASK;
+}
+
+// Idle mode: the core stops, peripherals run until an enabled IRQ is raised
+static void Sim_Idle(void)
+{
+    while(!(vic_raw & vic_enable & ~VICIntSelect))
+    {
+        if(sim_end_ps && sim_time_ps >= sim_end_ps) return;
+        Sim_AdvancePs(SIM_IDLE_STEP_PS, SIM_CAT_IDLE);
+        Sim_Step();
+        Sim_OnTime();
+    }
+}
+
+static void Apply_PCON(sim_reg_t v)
+{
+    sim_PCON = v & ~0x03UL;                 // IDL/PD clear on wake-up
+    if(v & 0x01) Sim_Idle();
+}
+static Sim_Latch latch_pcon = { 0, 0, Apply_PCON };
+
+volatile sim_reg_t *Sim_PCON(void)
+{
+    Sim_Arm(&latch_pcon);
+    latch_pcon.preload = latch_pcon.value = sim_PCON;
+    return &latch_pcon.value;
+}
+
+volatile sim_reg_t *Sim_PLL0STAT(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = (PLL0CFG & 0x7F) | ((PLL0CON & 0x03) << 8) | ((PLL0CON & 0x01) << 10);
+    return &scratch;
+}
+
+// Outside handlers T0TC is only read by delay loops (polls); the tick
+// handler reads it once as the latency probe
+volatile sim_reg_t *Sim_T0TC(void)
+{
+    int poll = (T0TCR & 1) && !in_isr;
+
+    Sim_Access(poll ? SIM_POLL_CYCLES : SIM_APB_CYCLES, poll ? SIM_CAT_DELAY : SIM_CAT_BUSY);
+    return &t0.tc;
+}
+
+// Timer1 is the firmware's free-running cycle counter: reads are busy time
+volatile sim_reg_t *Sim_T1TC(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    return &t1.tc;
+}
+
+volatile sim_reg_t *Sim_PWMTC(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    return &pwm.tc;
+}
+
+volatile sim_reg_t *Sim_PWMLER(void) { return Sim_Arm(&latch_pwmler); }
+volatile sim_reg_t *Sim_U1THR(void)  { return Sim_Arm(&latch_u1thr); }
+
+volatile sim_reg_t *Sim_U1RBR(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    u1.scratch = 0;
+    if(u1.rx_n) {
+        u1.scratch = u1.rx[0];
+        memmove(u1.rx, u1.rx + 1, --u1.rx_n);
+        u1.last_rx_ps = sim_time_ps;        // Reading restarts the CTI timeout
+    }
+    return &u1.scratch;
+}
+
+volatile sim_reg_t *Sim_U1LSR(void)
+{
+    int idle = (u1.rx_n == 0) || (u1.tx_n != 0);
+
+    Sim_Access(idle ? SIM_POLL_CYCLES : SIM_APB_CYCLES, idle ? SIM_CAT_UART : SIM_CAT_BUSY);
+    u1.scratch = (u1.rx_n ? 0x01 : 0) | (u1.oe ? 0x02 : 0) | (u1.tx_n ? 0 : 0x60);
+    u1.oe = 0;
+    return &u1.scratch;
+}
+
+volatile sim_reg_t *Sim_U1IIR(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+
+    if((U1IER & 0x04) && u1.oe)                              u1.scratch = 0x06;
+    else if((U1IER & 0x01) && u1.rx_n >= Uart_Trigger())     u1.scratch = 0x04;
+    else if((U1IER & 0x01) && Uart_Timeout())                u1.scratch = 0x0C;
+    else if(u1.thre_int) { u1.thre_int = 0;                  u1.scratch = 0x02; }
+    else                                                     u1.scratch = 0x01;
+
+    u1.scratch |= 0xC0;                                      // FIFOs enabled
+    return &u1.scratch;
+}
+
+volatile sim_reg_t *Sim_SSPDR(void)
+{
+    Sim_Arm(&latch_sspdr);
+    latch_sspdr.preload = latch_sspdr.value = SIM_SSP_READ | (ssp.rx_n ? ssp.rx[0] : 0);
+    return &latch_sspdr.value;
+}
+
+volatile sim_reg_t *Sim_SSPICR(void) { return Sim_Arm(&latch_sspicr); }
+
+volatile sim_reg_t *Sim_SSPSR(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    ssp.scratch = (ssp.tx_n ? 0 : 0x01) | (ssp.tx_n < 8 ? 0x02 : 0) | (ssp.rx_n ? 0x04 : 0) |
+                  (ssp.rx_n == 8 ? 0x08 : 0) | (ssp.tx_n ? 0x10 : 0);
+    return &ssp.scratch;
+}
+
+volatile sim_reg_t *Sim_SSPRIS(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    ssp.scratch = Ssp_Raw();
+    return &ssp.scratch;
+}
+
+volatile sim_reg_t *Sim_SSPMIS(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    ssp.scratch = Ssp_Raw() & SSPIMSC;
+    return &ssp.scratch;
+}
+
+static volatile sim_reg_t *Adc_GDR(int n)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    adc[n].scratch = adc[n].gdr;
+    adc[n].gdr &= ~(3UL << 30);
+    return &adc[n].scratch;
+}
+
+static volatile sim_reg_t *Adc_DR(int n, int ch)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    adc[n].scratch = adc[n].dr[ch];
+    adc[n].dr[ch] &= ~(3UL << 30);          // Reading clears DONE / OVERRUN
+    return &adc[n].scratch;
+}
+
+volatile sim_reg_t *Sim_AD0GDR(void)   { return Adc_GDR(0); }
+volatile sim_reg_t *Sim_AD1GDR(void)   { return Adc_GDR(1); }
+volatile sim_reg_t *Sim_AD0DR(int ch)  { return Adc_DR(0, ch); }
+volatile sim_reg_t *Sim_AD1DR(int ch)  { return Adc_DR(1, ch); }
+
+volatile sim_reg_t *Sim_CTIME0(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = SEC | (MIN << 8) | (HOUR << 16) | (DOW << 24);
+    return &scratch;
+}
+
+volatile sim_reg_t *Sim_CTIME1(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = DOM | (MONTH << 8) | (YEAR << 16);
+    return &scratch;
+}
+
+static void Apply_VICIntEnable(sim_reg_t v) { vic_enable |= v; }
+static void Apply_VICIntEnClr(sim_reg_t v)  { vic_enable &= ~v; }
+static Sim_Latch latch_vicen  = { 0, 0, Apply_VICIntEnable };
+static Sim_Latch latch_vicclr = { 0, 0, Apply_VICIntEnClr };
+
+volatile sim_reg_t *Sim_VICIntEnable(void)
+{
+    latch_vicen.preload = vic_enable;       // Reads return the enable mask
+    Sim_Arm(&latch_vicen);
+    latch_vicen.preload = latch_vicen.value = vic_enable;
+    return &latch_vicen.value;
+}
+
+volatile sim_reg_t *Sim_VICIntEnClr(void) { return Sim_Arm(&latch_vicclr); }
+
+volatile sim_reg_t *Sim_VICIRQStatus(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = vic_raw & vic_enable & ~VICIntSelect;
+    return &scratch;
+}
+
+volatile sim_reg_t *Sim_VICRawIntr(void)
+{
+    Sim_Access(SIM_APB_CYCLES, SIM_CAT_BUSY);
+    scratch = vic_raw;
+    return &scratch;
+}
@@ -0,0 +1,89 @@
+/*
+ * File        : sim_iap.c
+ * Description : Host stand-in for iap_flash.c (reserved flash sectors 24-26).
+ *
+ * NOTES:
+ * Same API as the firmware IAP wrapper. Programming can only clear bits,
+ * like real flash, so double-writes show up as corrupted records. Each
+ * call masks the VIC and charges the typical erase/program time to
+ * virtual time, so the effect on interrupt latency is visible in reports.
+ * The image can be loaded/saved to a file to emulate power cycles.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+#include "../firmware/iap_flash.h"
+#include "../firmware/vic.h"
+
+uint8_t sim_flash[SIM_FLASH_SIZE];
+
+static uint8_t Sim_SectorRange(uint8_t sector, unsigned long *base)
+{
+    if(sector < 24 || sector > 26) return 0;
+    *base = SIM_FLASH_BASE + (sector - 24) * FLASH_SECTOR_SIZE;
+    return 1;
+}
+
+static void Sim_IapTime(uint32_t ms)
+{
+    unsigned long lock = VIC_Lock(VIC_ALL);
+
+    Sim_AdvancePs(SIM_MS(ms), SIM_CAT_FLASH);
+    VIC_Unlock(lock);
+}
+
+const void *Sim_FlashPtr(unsigned long addr)
+{
+    static const uint32_t blank = 0xFFFFFFFF;
+
+    if(addr < SIM_FLASH_BASE || addr >= SIM_FLASH_BASE + SIM_FLASH_SIZE) return &blank;
+    return &sim_flash[addr - SIM_FLASH_BASE];
+}
+
+uint8_t IAP_EraseSector(uint8_t sector)
+{
+    unsigned long base;
+
+    if(!Sim_SectorRange(sector, &base)) return 0;
+    memset(&sim_flash[base - SIM_FLASH_BASE], 0xFF, FLASH_SECTOR_SIZE);
+    Sim_IapTime(SIM_ERASE_MS);
+    return 1;
+}
+
+uint8_t IAP_ProgramPage(uint8_t sector, uint32_t addr, const unsigned long *buf)
+{
+    unsigned long base;
+    const uint8_t *src = (const uint8_t *)buf;
+    int i;
+
+    if(!Sim_SectorRange(sector, &base)) return 0;
+    if(addr % FLASH_PAGE_SIZE || addr < base || addr >= base + FLASH_SECTOR_SIZE) return 0;
+
+    for(i = 0; i < FLASH_PAGE_SIZE; i++) sim_flash[addr - SIM_FLASH_BASE + i] &= src[i];
+    Sim_IapTime(SIM_PROGRAM_MS);
+    return 1;
+}
+
+int Sim_FlashLoad(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    size_t n;
+
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    if(!f) return 0;
+    n = fread(sim_flash, 1, sizeof(sim_flash), f);
+    fclose(f);
+    return n == sizeof(sim_flash);
+}
+
+int Sim_FlashSave(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    size_t n;
+
+    if(!f) return 0;
+    n = fwrite(sim_flash, 1, sizeof(sim_flash), f);
+    fclose(f);
+    return n == sizeof(sim_flash);
+}
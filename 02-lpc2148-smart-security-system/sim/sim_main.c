@@ -0,0 +1,437 @@
+/*
+ * File        : sim_main.c
+ * Description : Scenario runner and benchmark report for the host simulator.
+ *
+ * USAGE:
+ *   sim_security [-v] [-f flash.bin] [-s spi.bin] scenario.scn
+ *
+ *   -v   Print the UART transcript with virtual timestamps
+ *   -f   Load/save the settings + event log flash image (power cycles)
+ *   -s   Load/save the external SPI NOR flash image
+ *
+ * SCENARIO FORMAT (one event per line, time in virtual ms):
+ *   <ms> temp <C>            LM35 temperature (AD0.1)
+ *   <ms> ramp <C> <dur_ms>   Linear ramp from the current temperature
+ *   <ms> adc <ch> <mV>       Fixed voltage on another AD0 channel
+ *   <ms> ad1 <ch> <mV>       Fixed voltage on an AD1 channel (AD1.3: supply
+ *                            divider, 2500 mV = 5 V until set)
+ *   <ms> key <k> [hold_ms]   Keypad press (default hold 50 ms)
+ *   <ms> uart <text>         Bytes at 9600 baud (\r \n \\ escapes)
+ *   <ms> frame <cmd> [b ..]  Binary protocol request: hex bytes and/or
+ *                            "strings" (\0 escape) as payload, CRC added
+ *   <ms> end                 Stop and print the report
+ *
+ * REPORT:
+ *   - Keypress -> first LCD write latency
+ *   - Fan reaction: hottest LM35 zone above threshold -> PWM5 duty > 0
+ *     latched
+ *   - Protocol: request start -> complete response frame latency
+ *   - SPI NOR traffic (bytes read / programmed, sector erases)
+ *   - Monitor loop period split into busy / delay / UART / IRQ / flash /
+ *     idle virtual time, plus host CPU time per iteration for pure
+ *     computation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "sim.h"
+#include "../firmware/perf_probe.h"
+#include "../firmware/uart_protocol.h"
+#include "../firmware/crc16.h"
+
+int firmware_main(void);
+extern uint8_t temp_threshold;
+
+#define MAX_EVENTS     256
+#define MAX_KEYS       128
+#define MAX_TEXT       200
+#define MAX_REQUESTS   64
+
+typedef struct {
+    uint64_t ps;
+    char     cmd[8];
+    double   a, b;
+    char     text[MAX_TEXT];
+    int      len;
+} Sim_Event;
+
+static Sim_Event events[MAX_EVENTS];
+static int event_count = 0;
+static int event_next = 0;
+static jmp_buf end_jump;
+static int verbose = 0;
+
+// --- Stimulus State ---
+static double temp_from = 25.0, temp_to = 25.0;
+static uint64_t ramp_start = 0, ramp_end = 0;
+static uint16_t adc_mv[2][8] = { { 0 }, { 0, 0, 0, 2500 } };
+
+// --- Measurements ---
+static struct { char key; uint64_t press; uint64_t lcd; } keys[MAX_KEYS];
+static int key_count = 0;
+
+static int over_temp = 0;
+static uint64_t cross_ps = 0;
+static uint64_t fan_reaction_sum = 0, fan_reaction_max = 0;
+static int fan_reactions = 0;
+static uint32_t pwm_match = 0, pwm_period = 1;
+
+static struct {
+    uint64_t last_ps, last_cat[SIM_CAT_COUNT], last_host_ns;
+    uint64_t n, sum_ps, max_ps, cat_ps[SIM_CAT_COUNT], host_ns;
+} loop;
+
+static int uart_bol = 1;
+
+static struct {
+    uint64_t sent[MAX_REQUESTS];
+    int head, tail, requests, responses, bad;
+    uint64_t lat_sum, lat_max;
+    uint8_t buf[PROTO_MAX_PAYLOAD + 5];
+    int pos;
+} proto;
+
+// ============================================================
+// Scenario Parsing
+// ============================================================
+
+static int Sim_ParseText(const char *src, char *dst)
+{
+    int n = 0;
+
+    while(*src && *src != '\n' && n < MAX_TEXT - 1) {
+        if(*src == '\\' && src[1]) {
+            src++;
+            dst[n++] = (*src == 'r') ? '\r' : (*src == 'n') ? '\n' : *src;
+        } else {
+            dst[n++] = *src;
+        }
+        src++;
+    }
+    dst[n] = 0;
+    return n;
+}
+
+// "<cmd> [hex bytes | "string"]..." -> complete protocol frame
+static int Sim_ParseFrame(const char *src, char *dst)
+{
+    uint8_t *f = (uint8_t *)dst;
+    unsigned int v;
+    int n = 3, used;
+    uint16_t crc;
+
+    if(sscanf(src, "%x%n", &v, &used) < 1) return 0;
+    f[2] = (uint8_t)v;
+    src += used;
+
+    while(*src && n < MAX_TEXT - 2) {
+        if(*src == ' ' || *src == '\t' || *src == '\n') { src++; continue; }
+        if(*src == '"') {
+            for(src++; *src && *src != '"' && n < MAX_TEXT - 2; src++) {
+                if(*src == '\\' && src[1] == '0') { f[n++] = 0; src++; }
+                else f[n++] = (uint8_t)*src;
+            }
+            if(*src) src++;
+        }
+        else if(sscanf(src, "%2x%n", &v, &used) == 1) { f[n++] = (uint8_t)v; src += used; }
+        else break;
+    }
+
+    f[0] = PROTO_SOF;
+    f[1] = (uint8_t)(n - 3);
+    crc = CRC16_Update(CRC16_INIT, f + 1, n - 1);
+    f[n++] = crc & 0xFF;
+    f[n++] = crc >> 8;
+    return n;
+}
+
+static int Sim_LoadScenario(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256], *p;
+    double ms;
+    int off;
+    Sim_Event *e;
+
+    if(!f) { perror(path); return 0; }
+
+    while(fgets(line, sizeof(line), f) && event_count < MAX_EVENTS)
+    {
+        p = line + strspn(line, " \t");
+        if(*p == '#' || *p == '\n' || *p == 0) continue;
+
+        e = &events[event_count];
+        memset(e, 0, sizeof(*e));
+        if(sscanf(p, "%lf %7s %n", &ms, e->cmd, &off) < 2) {
+            fprintf(stderr, "%s: bad line: %s", path, line);
+            fclose(f);
+            return 0;
+        }
+        e->ps = (uint64_t)(ms * 1e9);
+        if(strcmp(e->cmd, "uart") == 0) e->len = Sim_ParseText(p + off, e->text);
+        else if(strcmp(e->cmd, "key") == 0) { e->text[0] = p[off]; e->a = 50; sscanf(p + off + 1, "%lf", &e->a); }
+        else if(strcmp(e->cmd, "frame") == 0) e->len = Sim_ParseFrame(p + off, e->text);
+        else sscanf(p + off, "%lf %lf", &e->a, &e->b);
+        event_count++;
+    }
+    fclose(f);
+    return 1;
+}
+
+// ============================================================
+// Model Callbacks
+// ============================================================
+
+static double Sim_Temperature(void)
+{
+    if(sim_time_ps >= ramp_end) return temp_to;
+    if(sim_time_ps <= ramp_start) return temp_from;
+    return temp_from + (temp_to - temp_from) *
+           (double)(sim_time_ps - ramp_start) / (double)(ramp_end - ramp_start);
+}
+
+// LM35 zones as wired in adc_driver.h: AD0.1 (modelled), AD0.2, AD1.2
+static double Sim_Hottest(void)
+{
+    double t = Sim_Temperature();
+
+    if(adc_mv[0][2] / 10.0 > t) t = adc_mv[0][2] / 10.0;
+    if(adc_mv[1][2] / 10.0 > t) t = adc_mv[1][2] / 10.0;
+    return t;
+}
+
+void Sim_OnTime(void)
+{
+    Sim_Event *e;
+    int hot;
+
+    while(event_next < event_count && events[event_next].ps <= sim_time_ps)
+    {
+        e = &events[event_next++];
+        if(strcmp(e->cmd, "temp") == 0) {
+            temp_from = temp_to = e->a; ramp_start = ramp_end = sim_time_ps;
+        }
+        else if(strcmp(e->cmd, "ramp") == 0) {
+            temp_from = Sim_Temperature(); temp_to = e->a;
+            ramp_start = sim_time_ps; ramp_end = sim_time_ps + SIM_MS(e->b);
+        }
+        else if(strcmp(e->cmd, "adc") == 0) adc_mv[0][(int)e->a & 7] = (uint16_t)e->b;
+        else if(strcmp(e->cmd, "ad1") == 0) adc_mv[1][(int)e->a & 7] = (uint16_t)e->b;
+        else if(strcmp(e->cmd, "uart") == 0) Sim_UartInput(e->text, e->len);
+        else if(strcmp(e->cmd, "frame") == 0) {
+            Sim_UartInput(e->text, e->len);
+            proto.sent[proto.tail] = sim_time_ps;
+            proto.tail = (proto.tail + 1) % MAX_REQUESTS;
+            proto.requests++;
+        }
+        else if(strcmp(e->cmd, "key") == 0) {
+            Sim_KeyPress(e->text[0], (uint32_t)e->a);
+            if(key_count < MAX_KEYS) {
+                keys[key_count].key = e->text[0];
+                keys[key_count].press = sim_time_ps;
+                keys[key_count].lcd = 0;
+                key_count++;
+            }
+        }
+        else if(strcmp(e->cmd, "end") == 0) sim_end_ps = sim_time_ps;
+    }
+
+    // Over-temperature edge for fan reaction timing
+    hot = Sim_Hottest() * 10.0 > temp_threshold * 10;
+    if(hot && !over_temp) { cross_ps = sim_time_ps; if(pwm_match) cross_ps = 0; }
+    if(!hot) cross_ps = 0;
+    over_temp = hot;
+}
+
+uint16_t Sim_OnAdcInput(int adc, int ch)
+{
+    if(adc == 0 && ch == 1) return (uint16_t)(Sim_Temperature() * 10.0);   // LM35: 10 mV/C
+    return adc_mv[adc & 1][ch & 7];
+}
+
+// Response frames are decoded (and timed) instead of echoed
+static int Sim_ProtoOutput(uint8_t byte)
+{
+    uint64_t lat;
+    uint16_t crc;
+    int i, len;
+
+    if(proto.pos == 0 && byte != PROTO_SOF) return 0;
+    proto.buf[proto.pos++] = byte;
+    if(proto.pos < 2 || proto.pos < proto.buf[1] + 5) return 1;
+
+    len = proto.buf[1];
+    crc = CRC16_Update(CRC16_INIT, proto.buf + 1, len + 2);
+    if(crc != (proto.buf[len + 3] | (proto.buf[len + 4] << 8))) proto.bad++;
+    proto.responses++;
+    proto.pos = 0;
+
+    if(proto.head != proto.tail) {
+        lat = sim_time_ps - proto.sent[proto.head];
+        proto.head = (proto.head + 1) % MAX_REQUESTS;
+        proto.lat_sum += lat;
+        if(lat > proto.lat_max) proto.lat_max = lat;
+    }
+    if(verbose) {
+        printf("%s[%10.3f ms] <frame cmd=%02X status=%02X", uart_bol ? "" : "\n",
+               SIM_TO_MS(sim_time_ps), proto.buf[2], len ? proto.buf[3] : 0xFF);
+        for(i = 1; i < len; i++) printf(" %02X", proto.buf[3 + i]);
+        printf(">\n");
+        uart_bol = 1;
+    }
+    return 1;
+}
+
+void Sim_OnUartOutput(uint8_t byte)
+{
+    if(Sim_ProtoOutput(byte)) return;
+    if(!verbose) return;
+    if(uart_bol && byte != '\r' && byte != '\n') { printf("[%10.3f ms] ", SIM_TO_MS(sim_time_ps)); uart_bol = 0; }
+    if(byte == '\n') uart_bol = 1;
+    if(byte == '\n' || (byte >= 0x20 && byte < 0x7F)) putchar(byte);
+    else if(byte == '\b') printf("<BS>");
+}
+
+void Sim_OnLcdWrite(uint8_t rs, uint8_t value)
+{
+    (void)rs; (void)value;
+    if(key_count && keys[key_count - 1].lcd == 0) keys[key_count - 1].lcd = sim_time_ps;
+}
+
+void Sim_OnPwmDuty(uint32_t match, uint32_t period)
+{
+    uint64_t reaction;
+
+    pwm_match = match;
+    pwm_period = period ? period : 1;
+
+    if(match && cross_ps) {
+        reaction = sim_time_ps - cross_ps;
+        fan_reaction_sum += reaction;
+        if(reaction > fan_reaction_max) fan_reaction_max = reaction;
+        fan_reactions++;
+        cross_ps = 0;
+    }
+}
+
+static uint64_t Sim_HostNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void Sim_Mark(uint8_t id)
+{
+    uint64_t now = Sim_HostNs(), dt;
+    int c;
+
+    if(id != PERF_MONITOR_LOOP) return;
+
+    // Ignore the first mark and re-entries after leaving Monitor Mode
+    dt = sim_time_ps - loop.last_ps;
+    if(loop.last_ps && dt < SIM_MS(1000)) {
+        loop.n++;
+        loop.sum_ps += dt;
+        if(dt > loop.max_ps) loop.max_ps = dt;
+        for(c = 0; c < SIM_CAT_COUNT; c++) loop.cat_ps[c] += sim_cat_ps[c] - loop.last_cat[c];
+        loop.host_ns += now - loop.last_host_ns;
+    }
+    loop.last_ps = sim_time_ps;
+    memcpy(loop.last_cat, sim_cat_ps, sizeof(loop.last_cat));
+    loop.last_host_ns = Sim_HostNs();
+}
+
+void Sim_OnEnd(void)
+{
+    longjmp(end_jump, 1);
+}
+
+// ============================================================
+// Report
+// ============================================================
+
+static void Sim_Report(const char *name)
+{
+    static const char *const cat_names[SIM_CAT_COUNT] = { "busy", "delay", "uart", "irq", "flash", "idle" };
+    uint64_t lat, lat_sum = 0, lat_max = 0, lat_min = ~0ULL;
+    int i, n = 0, c;
+
+    printf("\n== %s ==\n", name);
+    printf("virtual time        : %.3f s (CCLK %lu Hz)\n", SIM_TO_MS(sim_time_ps) / 1000.0, (unsigned long)Sim_CCLK());
+
+    for(i = 0; i < key_count; i++) {
+        if(!keys[i].lcd) continue;
+        lat = keys[i].lcd - keys[i].press;
+        lat_sum += lat; n++;
+        if(lat > lat_max) lat_max = lat;
+        if(lat < lat_min) lat_min = lat;
+    }
+    if(n) printf("key -> LCD latency  : %d/%d keys, min %.2f / mean %.2f / max %.2f ms\n", n, key_count,
+                 SIM_TO_MS(lat_min), SIM_TO_MS(lat_sum / n), SIM_TO_MS(lat_max));
+    else  printf("key -> LCD latency  : no LCD updates after %d keys\n", key_count);
+
+    if(fan_reactions)
+        printf("fan reaction        : %d events, mean %.2f / max %.2f ms\n", fan_reactions,
+               SIM_TO_MS(fan_reaction_sum / fan_reactions), SIM_TO_MS(fan_reaction_max));
+    else
+        printf("fan reaction        : no over-threshold fan start observed\n");
+    printf("fan duty (final)    : %.1f %%\n", 100.0 * pwm_match / pwm_period);
+
+    if(proto.requests)
+        printf("protocol            : %d requests, %d responses (%d bad CRC), mean %.2f / max %.2f ms\n",
+               proto.requests, proto.responses, proto.bad,
+               proto.responses ? SIM_TO_MS(proto.lat_sum / proto.responses) : 0.0, SIM_TO_MS(proto.lat_max));
+
+    if(sim_spi_read || sim_spi_programmed || sim_spi_erased)
+        printf("spi flash           : %lu B read, %lu B programmed, %lu sector erases\n",
+               (unsigned long)sim_spi_read, (unsigned long)sim_spi_programmed, (unsigned long)sim_spi_erased);
+
+    if(loop.n) {
+        printf("monitor loop        : %lu iters, mean %.1f us, max %.1f us\n", (unsigned long)loop.n,
+               SIM_TO_US(loop.sum_ps / loop.n), SIM_TO_US(loop.max_ps));
+        printf("  per iteration     :");
+        for(c = 0; c < SIM_CAT_COUNT; c++) printf(" %s %.1f us", cat_names[c], SIM_TO_US(loop.cat_ps[c] / loop.n));
+        printf("\n  host CPU          : %.1f us/iter (firmware + model)\n", loop.host_ns / 1000.0 / loop.n);
+    } else {
+        printf("monitor loop        : not entered\n");
+    }
+
+    printf("LCD                 : |%s|\n                      |%s|\n", sim_lcd[0], sim_lcd[1]);
+}
+
+int main(int argc, char **argv)
+{
+    const char *flash = 0, *spi = 0, *scenario = 0;
+    int i;
+
+    for(i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-v") == 0) verbose = 1;
+        else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc) flash = argv[++i];
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) spi = argv[++i];
+        else scenario = argv[i];
+    }
+    if(!scenario) {
+        fprintf(stderr, "usage: %s [-v] [-f flash.bin] [-s spi.bin] scenario.scn\n", argv[0]);
+        return 2;
+    }
+    if(!Sim_LoadScenario(scenario)) return 2;
+
+    Sim_FlashLoad(flash ? flash : "");
+    Sim_SpiFlashLoad(spi ? spi : "");
+    Sim_Reset();
+
+    if(setjmp(end_jump) == 0) {
+        firmware_main();
+        fprintf(stderr, "firmware returned from main\n");
+    }
+
+    if(verbose) printf("\n");
+    Sim_Report(scenario);
+    if(flash && !Sim_FlashSave(flash)) { perror(flash); return 1; }
+    if(spi && !Sim_SpiFlashSave(spi)) { perror(spi); return 1; }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * File        : sim_spiflash.c
+ * Description : File-backed stand-in for a 25-series SPI NOR flash chip.
+ *
+ * NOTES:
+ * Sits on the modelled SSP bus behind the P0.20 chip select and decodes
+ * the command subset used by spi_flash.c: JEDEC ID, RDSR, WREN/WRDI,
+ * READ/FAST_READ, page program and 4KB sector erase. Program and erase
+ * need WEL, start when CS is released and keep WIP set for the typical
+ * chip time, during which only RDSR is answered. Page programs wrap
+ * inside the page and can only clear bits, like the real part.
+ * The image can be loaded/saved to a file to emulate power cycles.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+#define SF_WREN      0x06
+#define SF_WRDI      0x04
+#define SF_RDSR      0x05
+#define SF_READ      0x03
+#define SF_FAST_READ 0x0B
+#define SF_PP        0x02
+#define SF_SE        0x20
+#define SF_JEDEC_ID  0x9F
+
+static uint8_t spi_mem[SIM_SPI_SIZE];
+
+uint32_t sim_spi_read = 0, sim_spi_programmed = 0, sim_spi_erased = 0;
+
+static struct {
+    int      active;
+    int      pos;                       // Bytes since CS fell
+    uint8_t  cmd;
+    uint32_t addr;
+    uint8_t  wel;
+    uint64_t busy_until;
+} sf;
+
+static int Sf_Busy(void)
+{
+    return sim_time_ps < sf.busy_until;
+}
+
+static uint32_t Sf_Wrap(uint32_t addr)
+{
+    return addr & (SIM_SPI_SIZE - 1);
+}
+
+void Sim_SpiSelect(int active)
+{
+    // CS rising edge commits program / erase
+    if(sf.active && !active && sf.wel && !Sf_Busy())
+    {
+        if(sf.cmd == SF_PP && sf.pos > 4) {
+            sf.busy_until = sim_time_ps + (uint64_t)SIM_SPI_PP_US * 1000000ULL;
+            sf.wel = 0;
+        }
+        else if(sf.cmd == SF_SE && sf.pos >= 4) {
+            memset(&spi_mem[Sf_Wrap(sf.addr) & ~0xFFFUL], 0xFF, 0x1000);
+            sim_spi_erased++;
+            sf.busy_until = sim_time_ps + SIM_MS(SIM_SPI_SE_MS);
+            sf.wel = 0;
+        }
+    }
+    sf.active = active;
+    sf.pos = 0;
+}
+
+uint8_t Sim_SpiExchange(uint8_t mosi)
+{
+    int pos = sf.pos++;
+    uint8_t out = 0xFF;
+
+    if(!sf.active) return 0xFF;
+
+    if(pos == 0) {
+        sf.cmd = mosi;
+        sf.addr = 0;
+        if(Sf_Busy() && mosi != SF_RDSR) sf.cmd = 0;      // Ignored while busy
+        else if(mosi == SF_WREN) sf.wel = 1;
+        else if(mosi == SF_WRDI) sf.wel = 0;
+        return 0xFF;
+    }
+
+    switch(sf.cmd)
+    {
+        case SF_RDSR:
+            out = (Sf_Busy() ? 0x01 : 0) | (sf.wel ? 0x02 : 0);
+            break;
+
+        case SF_JEDEC_ID:
+            if(pos <= 3) out = (uint8_t)(SIM_SPI_JEDEC_ID >> (8 * (3 - pos)));
+            break;
+
+        case SF_READ:
+        case SF_FAST_READ:
+        case SF_PP:
+        case SF_SE:
+            if(pos <= 3) { sf.addr = (sf.addr << 8) | mosi; break; }
+            if(sf.cmd == SF_SE) break;
+            if(sf.cmd == SF_FAST_READ && pos == 4) break;   // Dummy byte
+
+            if(sf.cmd == SF_PP) {
+                if(sf.wel) {
+                    spi_mem[Sf_Wrap((sf.addr & ~0xFFUL) | ((sf.addr + pos - 4) & 0xFF))] &= mosi;
+                    sim_spi_programmed++;
+                }
+            } else {
+                out = spi_mem[Sf_Wrap(sf.addr + pos - (sf.cmd == SF_FAST_READ ? 5 : 4))];
+                sim_spi_read++;
+            }
+            break;
+    }
+    return out;
+}
+
+int Sim_SpiFlashLoad(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    size_t n;
+
+    memset(spi_mem, 0xFF, sizeof(spi_mem));
+    if(!f) return 0;
+    n = fread(spi_mem, 1, sizeof(spi_mem), f);
+    fclose(f);
+    return n == sizeof(spi_mem);
+}
+
+int Sim_SpiFlashSave(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    size_t n;
+
+    if(!f) return 0;
+    n = fwrite(spi_mem, 1, sizeof(spi_mem), f);
+    fclose(f);
+    return n == sizeof(spi_mem);
+}
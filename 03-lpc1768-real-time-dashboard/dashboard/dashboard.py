@@ -6,20 +6,46 @@ import tkinter as tk
 from tkinter import scrolledtext
 import serial
 import serial.tools.list_ports
+import math
 import threading
+import time
+
+import telemetry
 
 # CONFIGURATION
 SERIAL_PORT = 'COM9'  # Update this to match your Virtual Port
-BAUD_RATE = 9600
+BAUD_RATE = 9600      # Board default after reset
+LINK_BAUD = 230400    # Requested after connecting (telemetry.LINK_BAUDS)
+LINK_TIMEOUT = 3.0    # Seconds without a valid frame before falling back
+
+# AD0 channel plan (firmware/main.c): name, unit, value scale
+CHANNELS = {
+    0: ("Board", "°C", 0.1),
+    1: ("Enclosure", "°C", 0.1),
+    2: ("Ambient", "°C", 0.1),
+    3: ("5V rail", "V", 0.001),
+    4: ("Pressure", "bar", 0.01),
+    5: ("3V3 rail", "V", 0.001),
+}
 
 class DashboardApp:
     def __init__(self, root):
         self.root = root
-        self.root.title("LPC1768 Temperature Monitor")
-        self.root.geometry("600x480")
+        self.root.title("LPC1768 Sensor Monitor")
+        self.root.geometry("640x560")
         
         self.ser = None
         self.is_reading = False
+        self.decoder = telemetry.Decoder()
+        self.link_switched = None   # time of the last baud change
+        self.status = None          # last telemetry.Status from the board
+        self.last_time = None       # board time (ms) of the newest reading, kept across connections
+        self.backfill_from = None   # gap to fetch from the flash log once the link is up
+        self.last_boot = None       # board boot number (LOG INFO) that last_time belongs to
+        self.boot = None            # boot number reported on this connection
+        self.boot_asked = False
+        self.link_ready = False
+        self.history = {}           # backfilled records: time_ms -> {ch: value}
 
         # --- Connection Header ---
         self.conn_frame = tk.Frame(root, pady=10, bg="#f0f0f0")
@@ -42,20 +68,37 @@ class DashboardApp:
         tk.Label(self.control_frame, text="User LED (P0.1) Control", fg="gray").pack(pady=(0, 10))
 
         self.btn_on = tk.Button(self.control_frame, text="Turn LED ON", 
-                                command=lambda: self.send_data('A'), height=2, bg="#90ee90")
+                                command=lambda: self.send_command("LED 1"), height=2, bg="#90ee90")
         self.btn_on.pack(fill=tk.X, pady=5)
 
         self.btn_off = tk.Button(self.control_frame, text="Turn LED OFF", 
-                                 command=lambda: self.send_data('B'), height=2, bg="#ffcccb")
+                                 command=lambda: self.send_command("LED 0"), height=2, bg="#ffcccb")
         self.btn_off.pack(fill=tk.X, pady=5)
 
+        # Free command line: RATE <hz>, CH <mask>, STAT ... (answers go to the feed)
+        tk.Label(self.control_frame, text="Command", fg="gray").pack(pady=(10, 0))
+        self.entry_cmd = tk.Entry(self.control_frame)
+        self.entry_cmd.pack(fill=tk.X, pady=5)
+        self.entry_cmd.bind("<Return>", lambda e: self.send_entry())
+
         tk.Label(self.control_frame, text="\nSystem Status:\nLED 1 (P0.0) is Heartbeat\nLED 2 (P0.1) is User", 
                  justify=tk.LEFT, fg="blue").pack(pady=20)
 
         # --- Live Data Feed (Right) ---
-        self.log_frame = tk.LabelFrame(self.main_container, text="Sensor Feed (LM35)", padx=10, pady=10)
+        self.log_frame = tk.LabelFrame(self.main_container, text="Sensor Feed (AD0)", padx=10, pady=10)
         self.log_frame.pack(side=tk.RIGHT, fill=tk.BOTH, expand=True)
 
+        self.values_frame = tk.Frame(self.log_frame)
+        self.values_frame.pack(fill=tk.X, pady=(0, 5))
+        self.lbl_values = {}
+        for row, (ch, (name, unit, _)) in enumerate(sorted(CHANNELS.items())):
+            tk.Label(self.values_frame, text=f"AD0.{ch} {name}", anchor="w").grid(row=row, column=0, sticky="w")
+            self.lbl_values[ch] = tk.Label(self.values_frame, text=f"-- {unit}", font=("Helvetica", 12, "bold"))
+            self.lbl_values[ch].grid(row=row, column=1, sticky="e", padx=(10, 0))
+
+        self.lbl_link = tk.Label(self.log_frame, text="", fg="gray", justify=tk.LEFT)
+        self.lbl_link.pack(pady=(0, 5))
+
         self.log_text = scrolledtext.ScrolledText(self.log_frame, width=35, height=15, state='disabled')
         self.log_text.pack(fill=tk.BOTH, expand=True)
 
@@ -67,40 +110,157 @@ class DashboardApp:
             self.is_reading = False
         else:
             try:
-                self.ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=1)
+                self.ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=0.1)
                 self.lbl_status.config(text=f"Connected to {SERIAL_PORT}", fg="green")
                 self.btn_connect.config(text="Disconnect")
                 self.is_reading = True
+                self.decoder = telemetry.Decoder()
+                self.link_switched = None
+                self.backfill_from = self.last_time
+                self.boot = None
+                self.boot_asked = False
+                self.link_ready = LINK_BAUD == BAUD_RATE
                 
                 self.thread = threading.Thread(target=self.read_serial_loop)
                 self.thread.daemon = True 
                 self.thread.start()
+
+                # Ask for the fast link: the board answers with a LINK frame
+                if LINK_BAUD != BAUD_RATE:
+                    self.ser.write(f"BAUD {LINK_BAUD}\n".encode())
             except Exception as e:
                 self.lbl_status.config(text=f"Error: {e}", fg="red")
 
     def read_serial_loop(self):
+        samples = 0
+        window = time.monotonic()
+        rate = 0.0
+
         while self.is_reading and self.ser and self.ser.is_open:
             try:
-                if self.ser.in_waiting > 0:
-                    data = self.ser.readline().decode('utf-8', errors='ignore').strip()
-                    if data:
-                        self.update_logger(data)
+                data = self.ser.read(self.ser.in_waiting or 1)
             except Exception:
                 break
 
+            for frame in self.decoder.feed(data):
+                self.link_switched = None
+                if frame.type == telemetry.TYPE_SAMPLES:
+                    samples += sum(len(s) for s in frame.data[1].values())
+                elif frame.type == telemetry.TYPE_VALUES:
+                    self.reading(frame.time_ms)
+                    self.root.after(0, self.update_value, frame.data)
+                elif frame.type == telemetry.TYPE_TEXT:
+                    self.parse_reply(frame.data)
+                    self.root.after(0, self.update_logger, frame.data)
+                elif frame.type == telemetry.TYPE_LINK:
+                    self.switch_baud(frame.data)
+                elif frame.type == telemetry.TYPE_STATUS:
+                    self.status = frame.data
+                elif frame.type == telemetry.TYPE_SUMMARY:
+                    # Window means keep the labels live in summary mode
+                    self.reading(frame.time_ms)
+                    means = {ch: w.mean for ch, w in frame.data.channels.items()}
+                    self.root.after(0, self.update_value, means)
+                elif frame.type == telemetry.TYPE_EVENT:
+                    self.root.after(0, self.update_logger, self.format_event(frame))
+                elif frame.type == telemetry.TYPE_HISTORY:
+                    self.store_history(frame.data)
+
+            # Board went back to its old rate (or never switched)
+            if self.link_switched and time.monotonic() - self.link_switched > LINK_TIMEOUT:
+                self.switch_baud(BAUD_RATE, confirm=False)
+                self.link_switched = None
+
+            now = time.monotonic()
+            if now - window >= 1.0:
+                rate = samples / (now - window)
+                samples, window = 0, now
+                self.root.after(0, self.update_link, rate)
+
+    def reading(self, time_ms):
+        # Board times restart at every reset: learn the boot number first
+        # (LOG INFO), and only fetch a gap that lies in the same boot
+        if self.boot is None:
+            if self.link_ready and not self.boot_asked:
+                self.ser.write(b"LOG INFO\n")
+                self.boot_asked = True
+            return
+        if self.boot != self.last_boot:
+            if self.last_boot is not None:
+                self.root.after(0, self.update_logger, f">> Board reset (boot {self.boot}): no backfill")
+            self.last_boot, self.last_time, self.backfill_from = self.boot, None, None
+        elif self.backfill_from is not None:
+            # First reading after reconnecting: ask the board's flash log for the gap
+            self.ser.write(f"LOG {self.backfill_from + 1} {time_ms - 1}\n".encode())
+            self.root.after(0, self.update_logger, f">> Backfill {self.backfill_from / 1000:.1f} - {time_ms / 1000:.1f} s")
+            self.backfill_from = None
+        if self.last_time is None or time_ms > self.last_time:
+            self.last_time = time_ms
+
+    def parse_reply(self, text):
+        # "OK LOG <boot> <pages> <errors>" answers LOG INFO ("OK LOG <pages>" a download)
+        words = text.split()
+        if len(words) == 5 and words[:2] == ["OK", "LOG"] and words[2].isdigit():
+            self.boot = int(words[2])
+
+    def store_history(self, page):
+        # One flash page (~45 one-second records at six channels)
+        if not page.records or page.boot != self.boot:
+            return
+        self.history.update(page.records)
+        first, last = page.records[0][0], page.records[-1][0]
+        self.root.after(0, self.update_logger,
+                        f"<< Log {first / 1000:.1f} - {last / 1000:.1f} s: {len(page.records)} records")
+
+    def switch_baud(self, baud, confirm=True):
+        self.ser.baudrate = baud
+        self.decoder.reset()
+        self.link_switched = time.monotonic()
+        self.link_ready = True
+        if confirm:
+            # Leading newline flushes bytes garbled by the switch
+            self.ser.write(b"\nACK\n")
+        self.root.after(0, self.update_logger, f">> Link: {baud} baud")
+
+    def format_event(self, frame):
+        ev = frame.data
+        name, unit, scale = CHANNELS.get(ev.channel, (f"AD0.{ev.channel}", "", 1))
+        digits = max(0, -round(math.log10(scale)))
+        edge = "above" if ev.kind == telemetry.EVENT_ABOVE else "below"
+        return f"!! {frame.time_ms / 1000:.1f} s  {name} {edge} threshold: {ev.value * scale:.{digits}f} {unit}"
+
+    def update_value(self, values):
+        for ch, raw in values.items():
+            if ch in CHANNELS:
+                _, unit, scale = CHANNELS[ch]
+                digits = max(0, -round(math.log10(scale)))
+                self.lbl_values[ch].config(text=f"{raw * scale:.{digits}f} {unit}")
+
+    def update_link(self, rate):
+        d = self.decoder
+        text = (f"{self.ser.baudrate} baud  |  {rate:.0f} samples/s\n"
+                f"frames {d.frames}  lost {d.lost}  errors {d.errors}")
+        if self.status:
+            text += f"\nCPU {self.status.cpu_load:.1f} %  overruns {self.status.overruns}"
+        self.lbl_link.config(text=text)
+
     def update_logger(self, message):
         self.log_text.config(state='normal') 
         self.log_text.insert(tk.END, message + "\n") 
         self.log_text.see(tk.END) 
         self.log_text.config(state='disabled') 
 
-    def send_data(self, char_to_send):
+    def send_command(self, line):
+        # Command lines (firmware/cmd.c): the board answers "OK ..." / "ERR ..."
         if self.ser and self.ser.is_open:
-            self.ser.write(char_to_send.encode())
-            if char_to_send == 'A':
-                self.update_logger(">> Status: User turned LED 2 ON")
-            elif char_to_send == 'B':
-                self.update_logger(">> Status: User turned LED 2 OFF")
+            self.ser.write((line + "\n").encode())
+            self.update_logger(f">> {line}")
+
+    def send_entry(self):
+        line = self.entry_cmd.get().strip()
+        if line:
+            self.send_command(line)
+            self.entry_cmd.delete(0, tk.END)
 
 if __name__ == "__main__":
     root = tk.Tk()
@@ -0,0 +1,212 @@
+"""
+LPC1768 binary telemetry decoder (matches firmware/telemetry.h)
+
+Frame: COBS encoded, 0x00 terminated, little-endian:
+    version u8, type u8, seq u16, time_ms u32, chmask u8, payload, crc16 u16
+"""
+import struct
+from collections import namedtuple
+
+TLM_VERSION = 1
+TLM_HEADER = struct.Struct('<BBHIB')
+
+TYPE_SAMPLES = 1    # rate_hz u32 (scans), count u16, 12-bit samples packed 2 per 3 bytes
+TYPE_VALUES = 2     # i16 per channel in chmask, channel units (see dashboard CHANNELS)
+TYPE_TEXT = 3       # ASCII
+TYPE_LINK = 4       # baud u32: the board switches after this frame
+TYPE_STATUS = 5     # cpu_load u16 (0.1 %), overruns u32, dropped u32
+TYPE_SUMMARY = 6    # scans u32, per channel: min i16, max i16, mean i16, var u32
+TYPE_EVENT = 7      # channel u8, kind u8, value i16
+TYPE_HISTORY = 8    # Flash log page (firmware/history.h), answers "LOG <from> <to>"
+
+EVENT_ABOVE = 1     # Rose above the high threshold
+EVENT_BELOW = 2     # Fell back under the low threshold
+
+# Flash log page: magic crc boot interval_ms seq first_ms last_ms chmask count used
+HISTORY_HEADER = struct.Struct('<HHHHIIIBBBx')
+HISTORY_MAGIC = 0x4C47
+REC_KEY = 1         # time_ms u32, i16 per channel
+REC_DELTA8 = 2      # i8 per channel, time = previous + interval
+REC_DELTA4 = 3      # i4 per channel, two per byte (low nibble first)
+
+# Rates accepted by "BAUD <rate>" (TLM_LINK_BAUDS)
+LINK_BAUDS = [9600, 115200, 230400, 460800, 921600]
+
+Frame = namedtuple('Frame', 'type seq time_ms channels data')
+Status = namedtuple('Status', 'cpu_load overruns dropped')
+Window = namedtuple('Window', 'min max mean var')   # Channel units (var: units^2)
+Summary = namedtuple('Summary', 'scans channels')   # channels: {ch: Window}
+Event = namedtuple('Event', 'channel kind value')
+History = namedtuple('History', 'boot seq records')  # records: [(time_ms, {ch: value})]
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, run = 0, 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            run += 1
+        if byte == 0 or run == 0xFF:
+            out[code_pos] = run
+            code_pos, run = len(out), 1
+            out.append(0)
+    out[code_pos] = run
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """Decode one frame (without its delimiter). Raises ValueError."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def unpack_samples(payload, count):
+    """12-bit samples, two per three bytes (an odd tail takes two bytes)."""
+    samples = []
+    for i in range(0, count - 1, 2):
+        b0, b1, b2 = payload[3 * (i // 2):3 * (i // 2) + 3]
+        samples.append(b0 | ((b1 & 0x0F) << 8))
+        samples.append((b1 >> 4) | (b2 << 4))
+    if count & 1:
+        tail = 3 * (count // 2)
+        samples.append((payload[tail] | (payload[tail + 1] << 8)) & 0x0FFF)
+    return samples
+
+
+def decode_history(page):
+    """Records of one flash log page, channel units. Raises ValueError."""
+    (magic, crc, boot, interval, seq, _first, _last,
+     chmask, count, used) = HISTORY_HEADER.unpack_from(page)
+    if magic != HISTORY_MAGIC:
+        raise ValueError("not a history page")
+    if crc16(page[4:HISTORY_HEADER.size + used]) != crc:
+        raise ValueError("history CRC mismatch")
+
+    channels = [ch for ch in range(8) if chmask & (1 << ch)]
+    n = len(channels)
+    pos = HISTORY_HEADER.size
+    time_ms, values, records = None, None, []
+    for _ in range(count):
+        tag = page[pos]
+        pos += 1
+        if tag == REC_KEY:
+            time_ms = struct.unpack_from('<I', page, pos)[0]
+            values = list(struct.unpack_from('<%dh' % n, page, pos + 4))
+            pos += 4 + 2 * n
+        elif tag in (REC_DELTA8, REC_DELTA4) and values is not None:
+            if tag == REC_DELTA8:
+                deltas = struct.unpack_from('<%db' % n, page, pos)
+                pos += n
+            else:
+                nibbles = [(page[pos + i // 2] >> (4 * (i & 1))) & 0x0F for i in range(n)]
+                deltas = [(d ^ 8) - 8 for d in nibbles]
+                pos += (n + 1) // 2
+            time_ms += interval
+            values = [v + d for v, d in zip(values, deltas)]
+        else:
+            raise ValueError("bad history record %d" % tag)
+        records.append((time_ms, dict(zip(channels, values))))
+    return History(boot, seq, records)
+
+
+def parse_frame(raw):
+    """Check and decode one unstuffed frame. Raises ValueError."""
+    if len(raw) < TLM_HEADER.size + 2:
+        raise ValueError("short frame")
+    if crc16(raw[:-2]) != struct.unpack_from('<H', raw, len(raw) - 2)[0]:
+        raise ValueError("CRC mismatch")
+
+    version, ftype, seq, time_ms, chmask = TLM_HEADER.unpack_from(raw)
+    if version != TLM_VERSION:
+        raise ValueError("unsupported version %d" % version)
+
+    channels = [ch for ch in range(8) if chmask & (1 << ch)]
+    payload = raw[TLM_HEADER.size:-2]
+
+    if ftype == TYPE_SAMPLES:
+        rate_hz, count = struct.unpack_from('<IH', payload)
+        samples = unpack_samples(payload[6:], count)
+        # Interleaved in channel order, one set per scan
+        data = (rate_hz, {ch: samples[k::len(channels)] for k, ch in enumerate(channels)})
+    elif ftype == TYPE_VALUES:
+        values = struct.unpack_from('<%dh' % len(channels), payload)
+        data = dict(zip(channels, values))
+    elif ftype == TYPE_TEXT:
+        data = payload.decode('ascii', errors='replace')
+    elif ftype == TYPE_LINK:
+        data = struct.unpack_from('<I', payload)[0]
+    elif ftype == TYPE_STATUS:
+        load, overruns, dropped = struct.unpack_from('<HII', payload)
+        data = Status(load / 10.0, overruns, dropped)
+    elif ftype == TYPE_SUMMARY:
+        scans = struct.unpack_from('<I', payload)[0]
+        windows = {ch: Window(*struct.unpack_from('<hhhI', payload, 4 + 10 * k))
+                   for k, ch in enumerate(channels)}
+        data = Summary(scans, windows)
+    elif ftype == TYPE_EVENT:
+        data = Event(*struct.unpack_from('<BBh', payload))
+    elif ftype == TYPE_HISTORY:
+        data = decode_history(payload)
+    else:
+        raise ValueError("unknown frame type %d" % ftype)
+
+    return Frame(ftype, seq, time_ms, channels, data)
+
+
+class Decoder:
+    """Byte stream -> frames, with link statistics."""
+
+    def __init__(self):
+        self.reset()
+        self.last_seq = None
+        self.frames = 0
+        self.errors = 0     # COBS / CRC / format failures
+        self.lost = 0       # Frames missing from the sequence
+
+    def reset(self):
+        """Drop any partial frame (e.g. after a baud change)."""
+        self.buffer = bytearray()
+        self.synced = False
+
+    def feed(self, data):
+        frames = []
+        for byte in data:
+            if byte:
+                self.buffer.append(byte)
+                continue
+            chunk, self.buffer = bytes(self.buffer), bytearray()
+            synced, self.synced = self.synced, True
+            if not chunk:
+                continue
+            try:
+                frame = parse_frame(cobs_decode(chunk))
+            except (ValueError, struct.error, IndexError):
+                if synced:              # Else: tail of a frame sent before we listened
+                    self.errors += 1
+                continue
+            if self.last_seq is not None:
+                self.lost += (frame.seq - self.last_seq - 1) & 0xFFFF
+            self.last_seq = frame.seq
+            self.frames += 1
+            frames.append(frame)
+        return frames
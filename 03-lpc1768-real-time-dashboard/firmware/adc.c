@@ -1,26 +1,169 @@
 #include "adc.h"
+#include "dma.h"
+#include "timer.h"
+#include "clock_config.h"
+#include "power.h"
+#include "prof.h"
+
+/*
+ * Sample stream:
+ * Timer1 toggles MAT1.0 at twice the sample rate and the ADC starts one
+ * conversion on each rising edge (START = 110). Every result raises an
+ * ADC DMA request (ADINTEN, the ADC interrupt itself stays off in the
+ * NVIC) and GPDMA copies ADGDR into the current block. Two linked list
+ * items point at each other, so the channel alternates between the ping
+ * and pong block forever and the CPU only sees one interrupt per block.
+ *
+ * In START mode the ADC converts a single channel per edge (BURST
+ * ignores START), so a stream carries one channel at an exact rate.
+ *
+ * Burst scan:
+ * A Timer1 interrupt sets BURST; the ADC converts every enabled channel
+ * once, lowest first, and the highest channel's DONE raises the ADC
+ * interrupt. The handler clears BURST, reads each ADDRn (all from the
+ * same ~5 us-per-channel sweep), runs the channel filters and publishes
+ * the scan as one snapshot. Clearing BURST lets one more conversion of
+ * the lowest channel finish; the next scan overwrites it. With a single
+ * channel that extra result is also the interrupting one: it raises a
+ * second interrupt, which finds the sweep no longer armed and is only
+ * acknowledged.
+ *
+ * Only one of the two modes runs at a time: each start stops the other.
+ * Both are stopped before a clock profile switch and restarted with the
+ * same arguments after it (new ADC clock, new Timer1 period).
+ */
+
+#define ADC_BURST           (1UL << 16)
+#define ADC_PDN             (1UL << 21)
+#define ADC_IDLE_CR         ((1 << 0) | (4 << 8) | ADC_PDN)   // ADC_Init(): AD0.0, 5 MHz
+
+/* AD0.n pins: PINSEL / PINMODE register index, bit position, function */
+static const struct {
+    uint8_t reg;
+    uint8_t shift;
+    uint8_t func;
+} adc_pins[ADC_CHANNELS] = {
+    { 1, 14, 1 },                        // AD0.0  P0.23
+    { 1, 16, 1 },                        // AD0.1  P0.24
+    { 1, 18, 1 },                        // AD0.2  P0.25
+    { 1, 20, 1 },                        // AD0.3  P0.26
+    { 3, 28, 3 },                        // AD0.4  P1.30
+    { 3, 30, 3 },                        // AD0.5  P1.31
+    { 0,  6, 2 },                        // AD0.6  P0.3 (RXD0)
+    { 0,  4, 2 }                         // AD0.7  P0.2 (TXD0)
+};
+
+static uint32_t adc_blocks[2][ADC_BLOCK_MAX] DMA_RAM;
+static DMA_LLI adc_lli[2] DMA_RAM;
+
+static ADC_BlockCallback adc_block_cb;
+static uint16_t adc_block_len;
+static volatile uint8_t adc_half;
+
+/* Running mode, kept to restart it after a clock switch */
+#define ADC_MODE_IDLE       0
+#define ADC_MODE_STREAM     1
+#define ADC_MODE_SCAN       2
+static uint8_t adc_mode = ADC_MODE_IDLE;
+static uint8_t adc_resume = ADC_MODE_IDLE;
+static uint8_t adc_stream_ch;
+static uint32_t adc_rate;                // As requested
+
+/* Burst scan configuration, fixed while scanning */
+static ADC_ChannelConfig adc_cfg[ADC_CHANNELS];
+static uint8_t adc_mask = 0;             // 0 = not scanning
+static uint8_t adc_count;                // Enabled channels
+static uint32_t adc_scan_cr;             // ADCR without BURST
+static ADC_ScanCallback adc_scan_cb;
+static uint16_t adc_scan_n;              // Scans per block
+
+/* Scan state, private to the ADC interrupt */
+static uint16_t adc_scan_blocks[2][ADC_BLOCK_MAX];
+static uint16_t adc_scan_pos;
+static uint8_t adc_scan_half;
+static volatile uint8_t adc_scan_armed;  // BURST set by ADC_ScanKick, sweep not yet read
+static int32_t adc_ema[ADC_CHANNELS];    // Filter output << k
+static uint16_t adc_hist[ADC_CHANNELS][2];  // Two previous raw results (median)
+static uint8_t adc_seeded;               // Bit n set once channel n has a result
+
+/* Written by the ADC interrupt, read with it masked (ADC_GetSnapshot) */
+static ADC_Snapshot adc_snap;
+
+static void ADC_PinSelect(uint8_t ch)
+{
+    volatile uint32_t *pinsel  = &LPC_PINCON->PINSEL0  + adc_pins[ch].reg;
+    volatile uint32_t *pinmode = &LPC_PINCON->PINMODE0 + adc_pins[ch].reg;
+    uint8_t shift = adc_pins[ch].shift;
+
+    *pinsel  = (*pinsel  & ~(0x3UL << shift)) | ((uint32_t)adc_pins[ch].func << shift);
+    *pinmode = (*pinmode & ~(0x3UL << shift)) | (0x2UL << shift);   // No pull-up / pull-down
+}
+
+/* DMA interrupt: one block complete, the other one is filling */
+static void ADC_BlockDone(uint8_t status)
+{
+    uint8_t half = adc_half;
+
+    adc_half = half ^ 1;
+    if (status == DMA_DONE && adc_block_cb)
+    {
+        adc_block_cb(adc_blocks[half], adc_block_len, half);
+    }
+}
+
+/* CLKDIV for the fastest ADC clock within ADC_CLK_MAX_HZ at the running PCLK */
+static uint32_t ADC_ClkDiv(void)
+{
+    return (Clock_GetPCLK(CLOCK_PCLK_ADC) + ADC_CLK_MAX_HZ - 1) / ADC_CLK_MAX_HZ - 1;
+}
+
+uint32_t ADC_MaxRate(void)
+{
+    return Clock_GetPCLK(CLOCK_PCLK_ADC) / (ADC_ClkDiv() + 1) / 65;
+}
+
+/* Clock profile switch: stop what runs, restart it at the new clocks */
+static void ADC_ClockChange(uint8_t event)
+{
+    if (event == CLOCK_PRE)
+    {
+        adc_resume = adc_mode;
+        ADC_ScanStop();
+        ADC_StreamStop();
+    }
+    else if (adc_resume == ADC_MODE_STREAM)
+    {
+        ADC_StreamStart(adc_stream_ch, adc_rate, adc_block_len, adc_block_cb);
+    }
+    else if (adc_resume == ADC_MODE_SCAN)
+    {
+        ADC_ScanStart(adc_cfg, adc_rate, adc_scan_n, adc_scan_cb);
+    }
+}
 
 void ADC_Init(void)
 {
-    LPC_SC->PCONP |= (1 << 12);          // Power On ADC
-    LPC_SC->PCLKSEL0 &= ~(0x3 << 24);    // PCLK = 25 MHz
+    Power_On(POWER_ADC);                 // PCLK set by the clock profile
     
     // Configure P0.23 as AD0.0
-    LPC_PINCON->PINSEL1 &= ~(0x3 << 14);
-    LPC_PINCON->PINSEL1 |=  (0x1 << 14); 
+    ADC_PinSelect(0);
     
     /*
      * ADC Clock Configuration:
      * ADC Clock = PCLK / (CLKDIV + 1)
-     * = 25 MHz / (4 + 1) = 5 MHz (Safe, well below 13 MHz max)
+     * = 25 MHz / (4 + 1) = 5 MHz (Safe, well below 13 MHz max;
+     *   6 MHz at the 120 MHz profile, 2.4 MHz at 12 MHz)
      */
-    LPC_ADC->ADCR = (1 << 0) | (4 << 8) | (1 << 21);
+    LPC_ADC->ADCR = ADC_IDLE_CR;
+
+    Clock_Register(ADC_ClockChange);
 }
 
 uint16_t ADC_Read(void)
 {
     uint16_t result;
     
+    PROF_ENTER(PROF_ADC_READ);
     LPC_ADC->ADCR |= (1 << 24);          // Start Conversion
     
     // Wait for DONE bit (Bit 31)
@@ -30,6 +173,237 @@ uint16_t ADC_Read(void)
     result = (result >> 4) & 0xFFF;      // Extract 12-bit value
     
     LPC_ADC->ADCR &= ~(1 << 24);         // Stop Conversion
+    PROF_EXIT(PROF_ADC_READ);
     
     return result;
 }
+
+uint32_t ADC_StreamStart(uint8_t channel, uint32_t rate_hz, uint16_t n, ADC_BlockCallback cb)
+{
+    LPC_GPDMACH_TypeDef *ch = DMA_Channel(DMA_CH_ADC);
+    uint32_t control;
+    uint8_t i;
+
+    if (channel > 7 || n == 0 || n > ADC_BLOCK_MAX || rate_hz == 0) return 0;
+
+    DMA_Init();
+    ADC_ScanStop();
+    ADC_StreamStop();
+    ADC_PinSelect(channel);
+
+    adc_mode      = ADC_MODE_STREAM;
+    adc_stream_ch = channel;
+    adc_rate      = rate_hz;
+    if (rate_hz > ADC_MaxRate()) rate_hz = ADC_MaxRate();
+
+    adc_block_cb  = cb;
+    adc_block_len = n;
+    adc_half      = 0;
+
+    // 1. Ping-pong descriptors: word from ADGDR -> next block entry
+    control = DMA_CTRL_SIZE(n) | DMA_CTRL_SWIDTH(2) | DMA_CTRL_DWIDTH(2) |
+              DMA_CTRL_DI | DMA_CTRL_I;
+    for (i = 0; i < 2; i++)
+    {
+        adc_lli[i].src     = (uint32_t)&LPC_ADC->ADGDR;
+        adc_lli[i].dst     = (uint32_t)adc_blocks[i];
+        adc_lli[i].lli     = (uint32_t)&adc_lli[i ^ 1];
+        adc_lli[i].control = control;
+    }
+
+    // 2. Channel starts on the ping block, then follows the list
+    DMA_SetCallback(DMA_CH_ADC, ADC_BlockDone);
+    ch->DMACCSrcAddr  = adc_lli[0].src;
+    ch->DMACCDestAddr = adc_lli[0].dst;
+    ch->DMACCLLI      = adc_lli[0].lli;
+    ch->DMACCControl  = control;
+    ch->DMACCConfig   = DMA_CFG_SRC(DMA_REQ_ADC) | DMA_CFG_P2M |
+                        DMA_CFG_IE | DMA_CFG_ITC | DMA_CFG_E;
+
+    // 3. ADC: one channel, fastest clock (12.5 MHz at PCLK 25 MHz),
+    //    start on MAT1.0 rising edge, DMA request per result (ADGINTEN = 0)
+    LPC_ADC->ADINTEN = (1 << channel);
+    LPC_ADC->ADCR = (1 << channel) | (ADC_ClkDiv() << 8) | (1 << 21) | (6 << 24);
+
+    // 4. Pace it
+    return Timer1_StartTrigger(rate_hz);
+}
+
+void ADC_StreamStop(void)
+{
+    LPC_GPDMACH_TypeDef *ch = DMA_Channel(DMA_CH_ADC);
+
+    Timer1_StopTrigger();
+    ch->DMACCConfig = 0;                 // Disable channel (in-flight sample dropped)
+    if (adc_mode == ADC_MODE_STREAM) adc_mode = ADC_MODE_IDLE;
+
+    // Back to the software-start configuration of ADC_Init()
+    LPC_ADC->ADINTEN = (1 << 8);
+    LPC_ADC->ADCR = ADC_IDLE_CR;
+}
+
+static uint16_t ADC_Filter(uint8_t ch, uint16_t x)
+{
+    const ADC_ChannelConfig *c = &adc_cfg[ch];
+    uint16_t a, b, t;
+
+    if (!(adc_seeded & (1 << ch)))          // Seed on the first result
+    {
+        adc_ema[ch] = (int32_t)x << c->k;
+        adc_hist[ch][0] = x;
+        adc_hist[ch][1] = x;
+        adc_seeded |= (1 << ch);
+    }
+
+    switch (c->filter)
+    {
+        case ADC_FILTER_EMA:
+            adc_ema[ch] += x - (adc_ema[ch] >> c->k);
+            return (uint16_t)((adc_ema[ch] + (1 << (c->k - 1))) >> c->k);
+
+        case ADC_FILTER_MEDIAN3:
+            a = adc_hist[ch][0];
+            b = adc_hist[ch][1];
+            adc_hist[ch][0] = b;
+            adc_hist[ch][1] = x;
+            if (a > b) { t = a; a = b; b = t; }
+            return (x < a) ? a : (x > b) ? b : x;
+
+        default:
+            return x;
+    }
+}
+
+/* Timer1 interrupt: start one sweep of the enabled channels */
+static void ADC_ScanKick(void)
+{
+    adc_scan_armed = 1;
+    LPC_ADC->ADCR = adc_scan_cr | ADC_BURST;
+}
+
+/* Highest enabled channel done: the whole sweep is in ADDR0 - ADDR7 */
+void ADC_IRQHandler(void)
+{
+    const volatile uint32_t *addr = &LPC_ADC->ADDR0;
+    uint16_t *block = adc_scan_blocks[adc_scan_half];
+    uint16_t x;
+    uint8_t ch;
+
+    if (!adc_mask) return;
+    if (!adc_scan_armed)
+    {
+        (void)LPC_ADC->ADGDR;               // Conversion after BURST went off: drop it
+        for (ch = 0; ch < ADC_CHANNELS; ch++)
+        {
+            if (adc_mask & (1 << ch)) (void)addr[ch];
+        }
+        return;
+    }
+    PROF_ENTER(PROF_ADC_SCAN);
+    LPC_ADC->ADCR = adc_scan_cr;            // BURST off
+    adc_scan_armed = 0;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (!(adc_mask & (1 << ch))) continue;
+
+        x = (uint16_t)ADC_SAMPLE(addr[ch]);  // Reading ADDRn clears its DONE (and the interrupt)
+        adc_snap.raw[ch] = x;
+        adc_snap.filtered[ch] = ADC_Filter(ch, x);
+        block[adc_scan_pos++] = x;
+    }
+    adc_snap.seq++;
+
+    if (adc_scan_pos >= adc_scan_n * adc_count)
+    {
+        adc_scan_pos = 0;
+        adc_scan_half ^= 1;
+        if (adc_scan_cb) adc_scan_cb(block, adc_scan_n, adc_scan_half ^ 1);
+    }
+    PROF_EXIT(PROF_ADC_SCAN);
+}
+
+uint32_t ADC_ScanStart(const ADC_ChannelConfig *cfg, uint32_t rate_hz, uint16_t n, ADC_ScanCallback cb)
+{
+    uint8_t mask = 0;
+    uint8_t count = 0;
+    uint8_t last = 0;
+    uint8_t ch;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (!cfg[ch].enable) continue;
+        mask |= (1 << ch);
+        count++;
+        last = ch;
+    }
+    if (mask == 0 || rate_hz == 0 || n == 0 || n * count > ADC_BLOCK_MAX) return 0;
+
+    ADC_StreamStop();
+    ADC_ScanStop();
+
+    adc_mode = ADC_MODE_SCAN;
+    adc_rate = rate_hz;
+
+    // Each sweep takes count x 65 ADC clocks; keep half the period for the interrupt
+    if (rate_hz > ADC_MaxRate() / count / 2) rate_hz = ADC_MaxRate() / count / 2;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        adc_cfg[ch] = cfg[ch];
+        if (adc_cfg[ch].k < 1) adc_cfg[ch].k = 1;
+        if (adc_cfg[ch].k > 8) adc_cfg[ch].k = 8;
+        if (cfg[ch].enable) ADC_PinSelect(ch);
+    }
+
+    adc_count     = count;
+    adc_scan_cb   = cb;
+    adc_scan_n    = n;
+    adc_scan_pos  = 0;
+    adc_scan_half = 0;
+    adc_scan_armed = 0;
+    adc_seeded    = 0;
+    adc_snap.mask = mask;
+    adc_snap.seq  = 0;
+
+    // SEL = every enabled channel, fastest ADC clock, BURST set per scan.
+    // Interrupt on the last channel of the sweep only.
+    adc_scan_cr = mask | (ADC_ClkDiv() << 8) | ADC_PDN;
+    LPC_ADC->ADCR = adc_scan_cr;
+    LPC_ADC->ADINTEN = (1 << last);
+
+    adc_mask = mask;
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    return Timer1_StartPeriodic(rate_hz, ADC_ScanKick);
+}
+
+void ADC_ScanStop(void)
+{
+    if (!adc_mask) return;
+
+    Timer1_StopTrigger();
+    NVIC_DisableIRQ(ADC_IRQn);
+    adc_mask = 0;
+    adc_mode = ADC_MODE_IDLE;
+
+    LPC_ADC->ADINTEN = (1 << 8);
+    LPC_ADC->ADCR = ADC_IDLE_CR;
+}
+
+void ADC_GetSnapshot(ADC_Snapshot *s)
+{
+    uint8_t ch;
+
+    NVIC_DisableIRQ(ADC_IRQn);
+    *s = adc_snap;
+    if (adc_mask) NVIC_EnableIRQ(ADC_IRQn);
+
+    // Calibration outside the interrupt: one SMULL per channel
+    PROF_ENTER(PROF_CONVERT);
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        s->value[ch] = (s->mask & (1 << ch)) ? Sensor_Convert(&adc_cfg[ch].cal, s->filtered[ch]) : 0;
+    }
+    PROF_EXIT(PROF_CONVERT);
+}
@@ -2,8 +2,69 @@
 #define ADC_H_
 
 #include <LPC17xx.h>
+#include "sensor.h"
+
+#define ADC_CHANNELS        8
+#define ADC_CLK_MAX_HZ      13000000UL      // Streams and scans: fastest ADC clock below this
+#define ADC_BLOCK_MAX       512             // Samples per ping-pong half
+
+/* Stream entries are raw ADGDR words: result in bits 15:4 */
+#define ADC_SAMPLE(v)       (((v) >> 4) & 0xFFF)
+
+/* Channel filters (applied per scan in the ADC interrupt) */
+#define ADC_FILTER_NONE     0
+#define ADC_FILTER_EMA      1               // y += (x - y) / 2^k
+#define ADC_FILTER_MEDIAN3  2               // Median of the last 3 scans: rejects single spikes
+
+/*
+ * One entry per AD0 channel. The pin (fixed by silicon, see adc.c) is
+ * switched to its ADC function only when the channel is enabled.
+ * AD0.6 / AD0.7 share P0.3 / P0.2 with UART0 and must stay off.
+ */
+typedef struct {
+    uint8_t enable;
+    uint8_t filter;                         // ADC_FILTER_*
+    uint8_t k;                              // EMA weight 1/2^k (1 - 8)
+    Sensor_Cal cal;                         // Filtered counts -> channel units
+} ADC_ChannelConfig;
+
+/* One burst scan of every enabled channel */
+typedef struct {
+    uint8_t  mask;                          // Enabled channels (bit n = AD0.n)
+    uint16_t raw[ADC_CHANNELS];             // Conversion of this scan, 0 - 4095
+    uint16_t filtered[ADC_CHANNELS];        // After the channel filter
+    int32_t  value[ADC_CHANNELS];           // Calibrated (ADC_GetSnapshot)
+    uint32_t seq;                           // Scans since ADC_ScanStart()
+} ADC_Snapshot;
+
+/*
+ * Called from the DMA interrupt each time one half of the ping-pong
+ * buffer is full (half = 0: ping, 1: pong). The block stays valid for
+ * one block period, until DMA wraps back to it.
+ */
+typedef void (*ADC_BlockCallback)(const uint32_t *block, uint16_t n, uint8_t half);
+
+/* Called from the ADC interrupt with n scans of raw 12-bit results,
+   enabled channels interleaved in channel order. Valid for one block. */
+typedef void (*ADC_ScanCallback)(const uint16_t *block, uint16_t n, uint8_t half);
 
 void ADC_Init(void);
-uint16_t ADC_Read(void);
+uint16_t ADC_Read(void);                    // Software conversion (not while streaming / scanning)
+
+/* Conversions per second at the running PCLK (65 ADC clocks each):
+   ~192 kHz at PCLK 25 MHz, ~185 kHz at 12 MHz */
+uint32_t ADC_MaxRate(void);
+
+/* Timer-paced stream of one channel into ping-pong blocks of n samples.
+   Returns the achieved sample rate (0 = bad arguments). */
+uint32_t ADC_StreamStart(uint8_t channel, uint32_t rate_hz, uint16_t n, ADC_BlockCallback cb);
+void ADC_StreamStop(void);
+
+/* Burst scans of the enabled channels at rate_hz, n scans per block
+   (cb optional). Returns the achieved scan rate (0 = bad arguments).
+   A stream or scan restarts by itself after a clock profile switch. */
+uint32_t ADC_ScanStart(const ADC_ChannelConfig *cfg, uint32_t rate_hz, uint16_t n, ADC_ScanCallback cb);
+void ADC_ScanStop(void);
+void ADC_GetSnapshot(ADC_Snapshot *s);      // Latest complete scan, calibrated
 
 #endif
@@ -1,41 +1,210 @@
 #include "clock_config.h"
 
-void SetupClock(void)
+/*
+ * Clock profiles
+ *
+ * Every switch runs from the 12 MHz main oscillator while PLL0 is
+ * reconfigured: disconnect and disable PLL0, set PCLKSEL (only effective
+ * while PLL0 is off, errata), start PLL0 with the new M / N, set the CPU
+ * divider and connect. The flash accelerator gets the slower of the old
+ * and new wait states during the switch and the new setting afterwards.
+ *
+ * PCLK: UART0 always runs at CCLK (baud rate generator range), every
+ * other peripheral at CCLK / pclk_div.
+ */
+
+typedef struct {
+    const char *name;
+    uint32_t cclk_hz;
+    uint16_t m;                             // PLL0 multiplier, 0 = PLL0 off
+    uint8_t n;                              // PLL0 pre-divider
+    uint8_t cclk_div;                       // FCCO (or oscillator) / CCLK
+    uint8_t pclk_div;                       // 1, 2 or 4
+    uint8_t flashtim;                       // FLASHCFG: CPU clocks per flash access - 1
+} Clock_Profile;
+
+static const Clock_Profile clock_profiles[CLOCK_PROFILES] = {
+    /* name       CCLK        M   N  div pclk flash  FCCO               */
+    { "PERF",    120000000UL, 20, 1,  4,  4,  5 },  // 2 * 20 * 12 / 1 = 480
+    { "DEFAULT", 100000000UL, 50, 3,  4,  4,  5 },  // 2 * 50 * 12 / 3 = 400
+    { "LOW",      12000000UL,  0, 1,  1,  1,  0 }   // Oscillator direct
+};
+
+/* PCLKSELx field value for CCLK / div */
+static const uint8_t clock_pclksel[5] = { 0, 1, 2, 0, 0 };
+
+/* Documented PCLKSELx fields; reserved ones (PCLKSEL0 11:10, 19:18,
+   PCLKSEL1 9:8, 25:24) must be written as zero */
+#define CLOCK_PCLKSEL0_FIELDS   0xFFF3F3FFUL
+#define CLOCK_PCLKSEL1_FIELDS   0xFCFFFCFFUL
+
+#if CLOCK_BOOT_PROFILE == CLOCK_PROFILE_PERF && CLOCK_CCLK_MAX_HZ < 120000000UL
+#error "CLOCK_PROFILE_PERF exceeds this part's maximum CPU clock"
+#endif
+
+static Clock_Notify clock_notify[CLOCK_MAX_NOTIFY];
+static uint8_t clock_notify_count = 0;
+static uint8_t clock_profile = CLOCK_BOOT_PROFILE;
+
+#define PLL0_FEED()     do { LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55; } while (0)
+
+static void Clock_Flash(uint8_t flashtim)
 {
-    // 1. Disconnect & Disable PLL0
-    LPC_SC->PLL0CON &= ~(1 << 1); 
-    LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55;
+    LPC_SC->FLASHCFG = (LPC_SC->FLASHCFG & ~0x0000F000) | ((uint32_t)flashtim << 12);
+}
+
+/* The switch itself, interrupts off */
+static void Clock_Apply(const Clock_Profile *p)
+{
+    uint8_t old_flash = (LPC_SC->FLASHCFG >> 12) & 0xF;
+    uint32_t sel = clock_pclksel[p->pclk_div];
+    uint32_t all = 0;
+    uint8_t i;
+
+    // 1. Slowest flash timing of the two profiles while switching
+    Clock_Flash(old_flash > p->flashtim ? old_flash : p->flashtim);
+
+    // 2. Disconnect & Disable PLL0: CCLK from the oscillator
+    LPC_SC->PLL0CON &= ~(1 << 1);
+    PLL0_FEED();
     LPC_SC->PLL0CON &= ~(1 << 0);
-    LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55;
+    PLL0_FEED();
 
-    // 2. Enable Main OSC (12 MHz)
-    LPC_SC->SCS |= (1 << 5);
-    while (!(LPC_SC->SCS & (1 << 6)));
+    // 3. Main OSC (12 MHz) as Source
+    if (!(LPC_SC->SCS & (1 << 6)))
+    {
+        LPC_SC->SCS |= (1 << 5);
+        while (!(LPC_SC->SCS & (1 << 6)));
+    }
+    LPC_SC->CLKSRCSEL = 0x01;
 
-    // 3. Select Main OSC as Source
-    LPC_SC->CLKSRCSEL = 0x01; 
+    // 4. Peripheral Clock Selection while PLL0 is off:
+    //    every documented field CCLK / pclk_div, UART0 = CCLK
+    for (i = 0; i < 16; i++) all |= sel << (i * 2);
+    LPC_SC->PCLKSEL0 = (all & CLOCK_PCLKSEL0_FIELDS & ~(0x3UL << 6)) | (0x1UL << 6);
+    LPC_SC->PCLKSEL1 = all & CLOCK_PCLKSEL1_FIELDS;
 
-    // 4. Configure PLL0 (M=50, N=3 -> 400 MHz)
-    LPC_SC->PLL0CFG  = (49 << 0) | (2 << 16); 
-    LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55;
+    if (p->m)
+    {
+        // 5. Configure PLL0, Enable & Wait for Lock
+        LPC_SC->PLL0CFG = (p->m - 1) | ((uint32_t)(p->n - 1) << 16);
+        PLL0_FEED();
+        LPC_SC->PLL0CON |= (1 << 0);
+        PLL0_FEED();
+        while (!(LPC_SC->PLL0STAT & (1 << 26)));
 
-    // 5. Enable PLL0 & Wait for Lock
-    LPC_SC->PLL0CON |= (1 << 0);
-    LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55;
-    while (!(LPC_SC->PLL0STAT & (1 << 26)));
+        // 6. CPU Clock Divider, then Connect PLL0
+        LPC_SC->CCLKCFG = p->cclk_div - 1;
+        LPC_SC->PLL0CON |= (1 << 1);
+        PLL0_FEED();
+        while (!(LPC_SC->PLL0STAT & (1 << 25)));
+    }
+    else
+    {
+        LPC_SC->CCLKCFG = p->cclk_div - 1;  // PLL0 stays powered down
+    }
 
-    // 6. CPU Clock Divider (400/4 = 100 MHz)
-    LPC_SC->CCLKCFG = 3; 
+    // 7. Flash Accelerator for the new clock
+    Clock_Flash(p->flashtim);
+}
+
+void SetupClock(void)
+{
+    Clock_Apply(&clock_profiles[CLOCK_BOOT_PROFILE]);
+    clock_profile = CLOCK_BOOT_PROFILE;
+}
+
+uint8_t Clock_SetProfile(uint8_t profile)
+{
+    uint8_t i;
 
-    // 7. Flash Accelerator Setup (Safe for 100 MHz)
-    LPC_SC->FLASHCFG = (LPC_SC->FLASHCFG & ~0x0000F000) | (0x5 << 12);
+    if (profile >= CLOCK_PROFILES || clock_profiles[profile].cclk_hz > CLOCK_CCLK_MAX_HZ) return 0;
+    if (profile == clock_profile) return 1;
 
-    // 8. Connect PLL0
-    LPC_SC->PLL0CON |= (1 << 1);
-    LPC_SC->PLL0FEED = 0xAA; LPC_SC->PLL0FEED = 0x55;
-    while (!(LPC_SC->PLL0STAT & (1 << 25)));
+    for (i = 0; i < clock_notify_count; i++) clock_notify[i](CLOCK_PRE);
+
+    __disable_irq();
+    Clock_Apply(&clock_profiles[profile]);
+    __enable_irq();
+    clock_profile = profile;
+
+    for (i = 0; i < clock_notify_count; i++) clock_notify[i](CLOCK_POST);
+    return 1;
+}
+
+void Clock_Suspend(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < clock_notify_count; i++) clock_notify[i](CLOCK_PRE);
+}
 
-    // 9. Peripheral Clock Selection (PCLK = CCLK/4 = 25 MHz)
-    LPC_SC->PCLKSEL0 = 0x00; 
-    LPC_SC->PCLKSEL1 = 0x00;
+void Clock_Resume(void)
+{
+    uint8_t i;
+
+    __disable_irq();
+    Clock_Apply(&clock_profiles[clock_profile]);
+    __enable_irq();
+
+    for (i = 0; i < clock_notify_count; i++) clock_notify[i](CLOCK_POST);
+}
+
+uint8_t Clock_GetProfile(void)
+{
+    return clock_profile;
+}
+
+const char *Clock_ProfileName(uint8_t profile)
+{
+    return (profile < CLOCK_PROFILES) ? clock_profiles[profile].name : "";
+}
+
+uint32_t Clock_ProfileCCLK(uint8_t profile)
+{
+    return (profile < CLOCK_PROFILES) ? clock_profiles[profile].cclk_hz : 0;
+}
+
+uint8_t Clock_Register(Clock_Notify fn)
+{
+    if (clock_notify_count == CLOCK_MAX_NOTIFY || fn == 0) return 0;
+    clock_notify[clock_notify_count++] = fn;
+    return 1;
+}
+
+uint32_t Clock_GetCCLK(void)
+{
+    uint32_t stat = LPC_SC->PLL0STAT;
+    uint32_t in;
+    uint32_t m;
+    uint32_t n;
+
+    switch (LPC_SC->CLKSRCSEL & 0x3)
+    {
+        case 1:  in = CLOCK_XTAL_HZ; break;
+        case 2:  in = 32768;         break;     // RTC oscillator
+        default: in = CLOCK_IRC_HZ;  break;
+    }
+
+    // PLLE0_STAT and PLLC0_STAT: CCLK comes from FCCO = 2 * M * in / N
+    if ((stat & (3UL << 24)) == (3UL << 24))
+    {
+        m = (stat & 0x7FFF) + 1;
+        n = ((stat >> 16) & 0xFF) + 1;
+        in = (uint32_t)(2ULL * m * in / n);
+    }
+    return in / ((LPC_SC->CCLKCFG & 0xFF) + 1);
+}
+
+uint8_t Clock_GetPCLKDiv(uint8_t periph)
+{
+    static const uint8_t div[4] = { 4, 1, 2, 8 };
+    uint32_t sel = (periph < 16) ? LPC_SC->PCLKSEL0 : LPC_SC->PCLKSEL1;
+
+    return div[(sel >> ((periph % 16) * 2)) & 0x3];
+}
+
+uint32_t Clock_GetPCLK(uint8_t periph)
+{
+    return Clock_GetCCLK() / Clock_GetPCLKDiv(periph);
 }
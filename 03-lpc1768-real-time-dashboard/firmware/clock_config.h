@@ -3,7 +3,61 @@
 
 #include <LPC17xx.h>
 
-/* Initializes the System Clock to 100 MHz and PCLK to 25 MHz */
+#define CLOCK_XTAL_HZ   12000000UL
+#define CLOCK_IRC_HZ    4000000UL
+#define CLOCK_CCLK_MAX_HZ   100000000UL         // LPC1768 (LPC1769: 120 MHz)
+
+/* Clock profiles (SetupClock() starts CLOCK_BOOT_PROFILE) */
+#define CLOCK_PROFILE_PERF      0               // 120 MHz, PLL0 480 MHz: LPC1769 only
+#define CLOCK_PROFILE_DEFAULT   1               // 100 MHz, PLL0 400 MHz
+#define CLOCK_PROFILE_LOW       2               // 12 MHz main oscillator, PLL0 off
+#define CLOCK_PROFILES          3
+
+#ifndef CLOCK_BOOT_PROFILE
+#define CLOCK_BOOT_PROFILE      CLOCK_PROFILE_DEFAULT
+#endif
+
+/* PCLKSEL0/1 fields (2 bits per peripheral, PCLKSEL1 from 16) */
+#define CLOCK_PCLK_TIMER0   1
+#define CLOCK_PCLK_TIMER1   2
+#define CLOCK_PCLK_UART0    3
+#define CLOCK_PCLK_UART1    4
+#define CLOCK_PCLK_ADC      12
+#define CLOCK_PCLK_UART2    24
+#define CLOCK_PCLK_UART3    25
+
+/*
+ * Drivers register once (from their Init) and are called around every
+ * profile switch, in main context: CLOCK_PRE with the old clocks still
+ * running (finish or stop transfers), CLOCK_POST once the new ones are
+ * stable (reprogram dividers from Clock_GetPCLK()).
+ */
+#define CLOCK_PRE           0
+#define CLOCK_POST          1
+#define CLOCK_MAX_NOTIFY    6
+
+typedef void (*Clock_Notify)(uint8_t event);
+
+/* Starts CLOCK_BOOT_PROFILE (100 MHz: PCLK = 25 MHz, UART0 100 MHz) */
 void SetupClock(void);
 
+/* Runtime switch, main context only. Returns 0 for an unknown profile
+   or one above CLOCK_CCLK_MAX_HZ (clocks unchanged). */
+uint8_t Clock_SetProfile(uint8_t profile);
+uint8_t Clock_GetProfile(void);
+const char *Clock_ProfileName(uint8_t profile);
+uint32_t Clock_ProfileCCLK(uint8_t profile);   // 0 = unknown (UART0 PCLK = CCLK)
+uint8_t Clock_Register(Clock_Notify fn);
+
+/* Deep Sleep (power.c) stops the oscillator and PLL0: Clock_Suspend()
+   runs CLOCK_PRE, Clock_Resume() applies the profile again after
+   wake-up and runs CLOCK_POST */
+void Clock_Suspend(void);
+void Clock_Resume(void);
+
+/* Running clocks, read back from the PLL0 / CCLKCFG / PCLKSEL registers */
+uint32_t Clock_GetCCLK(void);
+uint32_t Clock_GetPCLK(uint8_t periph);    // CLOCK_PCLK_*
+uint8_t Clock_GetPCLKDiv(uint8_t periph);  // CCLK / PCLK: 1, 2, 4 or 8
+
 #endif /* CLOCK_CONFIG_H_ */
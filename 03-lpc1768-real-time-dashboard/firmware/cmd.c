@@ -0,0 +1,192 @@
+#include "cmd.h"
+#include "uart.h"
+#include "telemetry.h"
+#include "fmt.h"
+#include "prof.h"
+
+/*
+ * Line parser for host commands
+ *
+ * The UART0 interrupt only queues bytes; lines are assembled, split and
+ * dispatched here in main context, so handlers may restart peripherals
+ * or queue frames without racing the ISR.
+ */
+
+static const Cmd_Entry *cmd_table;
+static uint8_t cmd_count = 0;
+
+static char cmd_line[CMD_LINE_MAX];
+static uint8_t cmd_len = 0;
+static uint8_t cmd_overflow = 0;            // Line too long: discard until CR / LF
+static uint32_t cmd_errors = 0;
+
+void Cmd_Init(const Cmd_Entry *table, uint8_t count)
+{
+    cmd_table = table;
+    cmd_count = count;
+    cmd_len = 0;
+    cmd_overflow = 0;
+}
+
+uint8_t Cmd_ParseUInt(const char *s, uint32_t *value)
+{
+    uint32_t v = 0;
+    uint8_t base = 10;
+    uint8_t digit;
+
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    {
+        base = 16;
+        s += 2;
+    }
+    if (!*s) return 0;
+
+    for (; *s; s++)
+    {
+        if (*s >= '0' && *s <= '9') digit = *s - '0';
+        else if (base == 16 && *s >= 'a' && *s <= 'f') digit = *s - 'a' + 10;
+        else if (base == 16 && *s >= 'A' && *s <= 'F') digit = *s - 'A' + 10;
+        else return 0;
+
+        if (v > (0xFFFFFFFFUL - digit) / base) return 0;   // Overflow
+        v = v * base + digit;
+    }
+    *value = v;
+    return 1;
+}
+
+uint8_t Cmd_ParseInt(const char *s, int32_t *value)
+{
+    uint32_t v;
+    uint8_t neg = (*s == '-');
+
+    if (!Cmd_ParseUInt(s + neg, &v) || v > 0x80000000UL - !neg) return 0;
+    *value = neg ? -(int32_t)(v - 1) - 1 : (int32_t)v;
+    return 1;
+}
+
+/* Splits on spaces in place. Returns the word count, CMD_ARGS_MAX + 1 if too many. */
+static uint8_t Cmd_Split(char *line, char *argv[])
+{
+    uint8_t argc = 0;
+
+    while (*line)
+    {
+        while (*line == ' ' || *line == '\t') *line++ = 0;
+        if (!*line) break;
+        if (argc == CMD_ARGS_MAX) return CMD_ARGS_MAX + 1;
+        argv[argc++] = line;
+        while (*line && *line != ' ' && *line != '\t') line++;
+    }
+    return argc;
+}
+
+uint8_t Cmd_Match(const char *word, const char *name)
+{
+    char c;
+
+    for (; *word; word++, name++)
+    {
+        c = *word;
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (c != *name) return 0;
+    }
+    return *name == 0;
+}
+
+/* Upper-cases the command word (for the reply) and looks it up */
+static const Cmd_Entry *Cmd_Find(char *name)
+{
+    char *p;
+    uint8_t i;
+
+    for (p = name; *p; p++)
+    {
+        if (*p >= 'a' && *p <= 'z') *p -= 'a' - 'A';
+    }
+    for (i = 0; i < cmd_count; i++)
+    {
+        if (Cmd_Match(name, cmd_table[i].name)) return &cmd_table[i];
+    }
+    return 0;
+}
+
+static void Cmd_Execute(uint32_t now)
+{
+    char *argv[CMD_ARGS_MAX];
+    char reply[CMD_REPLY_MAX];
+    char text[CMD_LINE_MAX + CMD_REPLY_MAX + 8];
+    const Cmd_Entry *e;
+    uint8_t argc;
+    char *p;
+
+    argc = Cmd_Split(cmd_line, argv);
+    if (argc == 0) return;                  // Blank line
+    if (argc > CMD_ARGS_MAX)
+    {
+        cmd_errors++;
+        Telemetry_SendText(now, "ERR too many arguments");
+        return;
+    }
+
+    e = Cmd_Find(argv[0]);
+    reply[0] = 0;
+    if (e && argc - 1 >= e->min_args && e->fn(argc, argv, reply))
+    {
+        p = Fmt_Str(text, "OK ");
+        p = Fmt_Str(p, argv[0]);
+        if (reply[0])
+        {
+            p = Fmt_Str(p, " ");
+            Fmt_Str(p, reply);
+        }
+    }
+    else
+    {
+        cmd_errors++;
+        p = Fmt_Str(text, "ERR ");
+        p = Fmt_Str(p, argv[0]);
+        p = Fmt_Str(p, e ? " usage: " : " unknown command");
+        if (e) Fmt_Str(p, e->usage);
+    }
+    Telemetry_SendText(now, text);
+}
+
+void Cmd_Poll(uint32_t now)
+{
+    char c;
+
+    while (UART0_RxChar(&c))
+    {
+        if (c == '\r' || c == '\n')
+        {
+            if (cmd_overflow)
+            {
+                cmd_errors++;
+                Telemetry_SendText(now, "ERR line too long");
+            }
+            else if (cmd_len)
+            {
+                cmd_line[cmd_len] = 0;
+                PROF_ENTER(PROF_COMMAND);
+                Cmd_Execute(now);
+                PROF_EXIT(PROF_COMMAND);
+            }
+            cmd_len = 0;
+            cmd_overflow = 0;
+        }
+        else if (cmd_len < CMD_LINE_MAX - 1)
+        {
+            cmd_line[cmd_len++] = c;
+        }
+        else
+        {
+            cmd_overflow = 1;
+        }
+    }
+}
+
+uint32_t Cmd_Errors(void)
+{
+    return cmd_errors;
+}
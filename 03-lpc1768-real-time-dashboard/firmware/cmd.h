@@ -0,0 +1,37 @@
+#ifndef CMD_H_
+#define CMD_H_
+
+#include <LPC17xx.h>
+
+/*
+ * Host command lines: "<NAME> [arg ...]" terminated by CR or LF.
+ * Names are case-insensitive, arguments are split on spaces.
+ * Every line is answered with a text frame: "OK <NAME> [reply]" or
+ * "ERR <NAME> usage: ...".
+ */
+#define CMD_LINE_MAX        48                  // Including the terminator
+#define CMD_ARGS_MAX        6                   // Including the name
+#define CMD_REPLY_MAX       128
+
+/* argv[0] is the name. Write an optional answer to reply (CMD_REPLY_MAX).
+   Return 1 if done, 0 if an argument was rejected. */
+typedef uint8_t (*Cmd_Handler)(uint8_t argc, char *argv[], char *reply);
+
+typedef struct {
+    const char *name;                           // Upper case
+    uint8_t min_args;                           // Not counting the name
+    Cmd_Handler fn;
+    const char *usage;
+} Cmd_Entry;
+
+void Cmd_Init(const Cmd_Entry *table, uint8_t count);
+
+/* Scheduler task: runs every complete line waiting in the UART0 ring */
+void Cmd_Poll(uint32_t now);
+
+uint8_t Cmd_ParseUInt(const char *s, uint32_t *value);    // Decimal or 0x hex
+uint8_t Cmd_ParseInt(const char *s, int32_t *value);      // Optional '-', then as above
+uint8_t Cmd_Match(const char *word, const char *name);    // Case-insensitive, name upper case
+uint32_t Cmd_Errors(void);                  // Unknown, rejected or overlong lines
+
+#endif /* CMD_H_ */
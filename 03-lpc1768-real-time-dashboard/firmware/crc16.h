@@ -0,0 +1,11 @@
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <LPC17xx.h>
+
+#define CRC16_INIT      0xFFFF
+
+/* CRC-16/CCITT-FALSE (poly 0x1021): CRC16_Update(CRC16_INIT, ...) */
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t len);
+
+#endif /* CRC16_H_ */
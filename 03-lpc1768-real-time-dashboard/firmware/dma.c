@@ -0,0 +1,58 @@
+#include "dma.h"
+#include "power.h"
+
+/*
+ * GPDMA controller shared by the drivers.
+ *
+ * Each driver owns fixed channels (see dma.h) and registers a callback.
+ * The single DMA interrupt clears and dispatches terminal count and error
+ * events per channel, so drivers never touch the shared status registers.
+ */
+
+static LPC_GPDMACH_TypeDef * const dma_channels[8] = {
+    LPC_GPDMACH0, LPC_GPDMACH1, LPC_GPDMACH2, LPC_GPDMACH3,
+    LPC_GPDMACH4, LPC_GPDMACH5, LPC_GPDMACH6, LPC_GPDMACH7
+};
+
+static DMA_Callback dma_callbacks[8];
+
+void DMA_IRQHandler(void)
+{
+    uint32_t tc  = LPC_GPDMA->DMACIntTCStat;
+    uint32_t err = LPC_GPDMA->DMACIntErrStat;
+    uint8_t ch;
+
+    LPC_GPDMA->DMACIntTCClear = tc;
+    LPC_GPDMA->DMACIntErrClr  = err;
+
+    for (ch = 0; ch < 8; ch++)
+    {
+        if (((tc | err) & (1 << ch)) && dma_callbacks[ch])
+        {
+            dma_callbacks[ch]((err & (1 << ch)) ? DMA_ERROR : DMA_DONE);
+        }
+    }
+}
+
+void DMA_Init(void)
+{
+    if (Power_IsOn(POWER_GPDMA)) return;     // Already powered
+
+    Power_On(POWER_GPDMA);
+
+    LPC_GPDMA->DMACIntTCClear = 0xFF;
+    LPC_GPDMA->DMACIntErrClr  = 0xFF;
+    LPC_GPDMA->DMACConfig     = 0x01;        // Enable, little-endian
+
+    NVIC_EnableIRQ(DMA_IRQn);
+}
+
+void DMA_SetCallback(uint8_t ch, DMA_Callback cb)
+{
+    dma_callbacks[ch & 7] = cb;
+}
+
+LPC_GPDMACH_TypeDef *DMA_Channel(uint8_t ch)
+{
+    return dma_channels[ch & 7];
+}
@@ -0,0 +1,65 @@
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <LPC17xx.h>
+
+/* Channel Ownership (lower channel = higher priority) */
+#define DMA_CH_ADC          0           // Sample stream must never stall
+#define DMA_CH_UART0_TX     7           // Telemetry is the least urgent
+
+/* Peripheral Request Lines (DMAREQSEL = 0) */
+#define DMA_REQ_ADC         4
+#define DMA_REQ_UART0_TX    8
+#define DMA_REQ_UART0_RX    9
+
+/* DMACCControl Fields */
+#define DMA_CTRL_SIZE(n)    ((uint32_t)(n) & 0xFFF)   // Transfers (max 4095)
+#define DMA_CTRL_SBSIZE(b)  ((uint32_t)(b) << 12)     // Burst: 0 = 1, 1 = 4, 2 = 8 ...
+#define DMA_CTRL_DBSIZE(b)  ((uint32_t)(b) << 15)
+#define DMA_CTRL_SWIDTH(w)  ((uint32_t)(w) << 18)     // 0 = byte, 1 = half, 2 = word
+#define DMA_CTRL_DWIDTH(w)  ((uint32_t)(w) << 21)
+#define DMA_CTRL_SI         (1UL << 26)               // Source increment
+#define DMA_CTRL_DI         (1UL << 27)               // Destination increment
+#define DMA_CTRL_I          (1UL << 31)               // Terminal count interrupt
+
+/* DMACCConfig Fields */
+#define DMA_CFG_E           (1UL << 0)                // Channel enable
+#define DMA_CFG_SRC(p)      ((uint32_t)(p) << 1)      // Source request line
+#define DMA_CFG_DST(p)      ((uint32_t)(p) << 6)      // Destination request line
+#define DMA_CFG_M2P         (1UL << 11)
+#define DMA_CFG_P2M         (2UL << 11)
+#define DMA_CFG_IE          (1UL << 14)               // Error interrupt mask
+#define DMA_CFG_ITC         (1UL << 15)               // Terminal count interrupt mask
+
+#define DMA_MAX_TRANSFER    4095
+
+/*
+ * GPDMA cannot reach the CPU-local SRAM (0x10000000): buffers and
+ * descriptors it touches must live in AHB SRAM (0x2007C000), placed by
+ * the scatter file: RW_IRAM2 0x2007C000 0x8000 { *(AHBSRAM0) }
+ */
+#define DMA_RAM             __attribute__((section("AHBSRAM0"), zero_init))
+
+/* Completion Status (callback argument) */
+#define DMA_DONE            0
+#define DMA_ERROR           1
+
+typedef void (*DMA_Callback)(uint8_t status);
+
+/* Linked list item: loaded into the channel when the current block ends */
+typedef struct {
+    uint32_t src;
+    uint32_t dst;
+    uint32_t lli;                       // Next item (0 = stop)
+    uint32_t control;                   // DMACCControl for that block
+} DMA_LLI;
+
+/* Powers the controller once; safe to call from every driver init */
+void DMA_Init(void);
+
+/* Registers the terminal count / error handler of a channel */
+void DMA_SetCallback(uint8_t ch, DMA_Callback cb);
+
+LPC_GPDMACH_TypeDef *DMA_Channel(uint8_t ch);
+
+#endif /* DMA_H_ */
@@ -0,0 +1,59 @@
+#include "fmt.h"
+
+char *Fmt_Str(char *dst, const char *s)
+{
+    while (*s) *dst++ = *s++;
+    *dst = '\0';
+    return dst;
+}
+
+char *Fmt_UInt(char *dst, uint32_t value)
+{
+    char digits[10];
+    uint8_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);  // UDIV: a few cycles on the M3
+        value /= 10;
+    } while (value);
+
+    while (n) *dst++ = digits[--n];
+    *dst = '\0';
+    return dst;
+}
+
+char *Fmt_Int(char *dst, int32_t value)
+{
+    if (value < 0)
+    {
+        *dst++ = '-';
+        return Fmt_UInt(dst, 0u - (uint32_t)value);
+    }
+    return Fmt_UInt(dst, (uint32_t)value);
+}
+
+char *Fmt_Deci(char *dst, int32_t tenths)
+{
+    uint32_t u = (uint32_t)tenths;
+
+    if (tenths < 0)
+    {
+        *dst++ = '-';
+        u = 0u - u;
+    }
+    dst = Fmt_UInt(dst, u / 10);
+    *dst++ = '.';
+    *dst++ = (char)('0' + u % 10);
+    *dst = '\0';
+    return dst;
+}
+
+char *Fmt_Hex(char *dst, uint32_t value, uint8_t digits)
+{
+    static const char hex[16] = "0123456789ABCDEF";
+
+    while (digits--) *dst++ = hex[(value >> (digits * 4)) & 0xF];
+    *dst = '\0';
+    return dst;
+}
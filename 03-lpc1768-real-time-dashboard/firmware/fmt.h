@@ -0,0 +1,17 @@
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <LPC17xx.h>
+
+/*
+ * Integer text formatting (replaces sprintf on the telemetry path).
+ * Each call writes a terminated string at dst and returns a pointer to
+ * the terminator, so calls chain: p = Fmt_Str(p, "..."); len = p - buf.
+ */
+char *Fmt_Str(char *dst, const char *s);
+char *Fmt_UInt(char *dst, uint32_t value);
+char *Fmt_Int(char *dst, int32_t value);
+char *Fmt_Deci(char *dst, int32_t tenths);      // -123 -> "-12.3"
+char *Fmt_Hex(char *dst, uint32_t value, uint8_t digits);  // 0x2A, 4 -> "002A"
+
+#endif /* FMT_H_ */
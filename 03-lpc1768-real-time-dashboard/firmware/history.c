@@ -0,0 +1,309 @@
+#include "history.h"
+#include "crc16.h"
+
+/*
+ * hist_head is the next flash page to write. It always sits in a sector
+ * erased when the log entered it, so walking the ring from the page
+ * after hist_head visits the log oldest first and ends with the page
+ * written last. A page is programmed once, in full: its header (count,
+ * last_ms, crc) is final before the write.
+ *
+ * A page that is not blank where the next write should go (power lost
+ * during a write) is skipped with the rest of its sector. Main context
+ * only.
+ */
+
+static union {
+    History_Page page;
+    uint32_t words[HISTORY_PAGE_SIZE / 4];  // Word aligned: IAP source
+    uint8_t bytes[HISTORY_PAGE_SIZE];
+} hist_stage;
+
+static uint16_t hist_head = 0;
+static uint32_t hist_seq = 0;
+static uint16_t hist_boot = 0;
+static uint16_t hist_pages = 0;
+static uint32_t hist_errors = 0;
+
+static int16_t hist_last[HISTORY_CHANNELS]; // Values of the previous record
+static uint8_t hist_channels;               // In the open page's chmask
+static uint8_t hist_since_key;
+
+/* Download in progress */
+static uint32_t dl_from, dl_to;
+static uint16_t dl_start;                   // hist_head when it started
+static uint16_t dl_next;                    // Ring offset from dl_start, 1 .. HISTORY_PAGES
+static uint8_t dl_stage = 0;                // Open page still to check
+
+static const History_Page *History_Flash(uint16_t index)
+{
+    return (const History_Page *)(HISTORY_BASE + (uint32_t)index * HISTORY_PAGE_SIZE);
+}
+
+static uint16_t History_Crc(const History_Page *p)
+{
+    return CRC16_Update(CRC16_INIT, (const uint8_t *)p + 4, (uint16_t)(HISTORY_HEADER - 4 + p->used));
+}
+
+static uint8_t History_Valid(const History_Page *p)
+{
+    return p->magic == HISTORY_MAGIC && p->used <= HISTORY_PAYLOAD && p->crc == History_Crc(p);
+}
+
+static uint8_t History_Blank(const uint32_t *p, uint32_t words)
+{
+    while (words--)
+    {
+        if (*p++ != 0xFFFFFFFFUL) return 0;
+    }
+    return 1;
+}
+
+void History_Init(void)
+{
+    const History_Page *p;
+    uint32_t newest = 0;
+    uint16_t i;
+
+    hist_head = 0;
+    hist_seq = 0;
+    hist_boot = 0;
+    hist_pages = 0;
+
+    for (i = 0; i < HISTORY_PAGES; i++)
+    {
+        p = History_Flash(i);
+        if (!History_Valid(p)) continue;
+
+        if (hist_pages++ == 0 || (int32_t)(p->seq - newest) > 0)
+        {
+            newest = p->seq;
+            hist_head = (uint16_t)((i + 1) % HISTORY_PAGES);
+            hist_seq = p->seq + 1;
+            hist_boot = (uint16_t)(p->boot + 1);
+        }
+    }
+
+    hist_stage.page.count = 0;
+    dl_next = HISTORY_PAGES + 1;
+    dl_stage = 0;
+}
+
+/* Erase the sector starting at hist_head, forgetting its pages */
+static uint8_t History_Erase(void)
+{
+    const History_Page *p = History_Flash(hist_head);
+    uint32_t sector = IAP_Sector((uint32_t)p);
+    uint16_t i;
+
+    if (History_Blank((const uint32_t *)p, HISTORY_SECTOR_SIZE / 4)) return 1;
+
+    for (i = 0; i < HISTORY_SECTOR_PAGES; i++)
+    {
+        if (History_Valid(History_Flash((uint16_t)(hist_head + i)))) hist_pages--;
+    }
+    return IAP_Erase(sector, sector) == IAP_SUCCESS;
+}
+
+/* Program the RAM page at hist_head (~1 ms, ~100 ms more when a sector
+   has to be erased first) */
+static void History_Commit(void)
+{
+    History_Page *page = &hist_stage.page;
+    uint16_t i;
+
+    if (hist_head % HISTORY_SECTOR_PAGES != 0 &&
+        !History_Blank((const uint32_t *)History_Flash(hist_head), HISTORY_PAGE_SIZE / 4))
+    {
+        hist_head = (uint16_t)((hist_head / HISTORY_SECTOR_PAGES + 1) * HISTORY_SECTOR_PAGES % HISTORY_PAGES);
+    }
+
+    for (i = HISTORY_HEADER + page->used; i < HISTORY_PAGE_SIZE; i++) hist_stage.bytes[i] = 0xFF;
+    page->crc = History_Crc(page);
+
+    if (hist_head % HISTORY_SECTOR_PAGES == 0 && !History_Erase())
+    {
+        hist_errors++;                      // Page lost, try the next sector next time
+    }
+    else if (IAP_Write((uint32_t)History_Flash(hist_head), hist_stage.words, HISTORY_PAGE_SIZE) != IAP_SUCCESS ||
+             !History_Valid(History_Flash(hist_head)))
+    {
+        hist_errors++;
+    }
+    else
+    {
+        hist_pages++;
+    }
+
+    hist_head = (uint16_t)((hist_head + 1) % HISTORY_PAGES);
+    page->count = 0;
+}
+
+static void History_Open(uint32_t time_ms, uint8_t chmask)
+{
+    History_Page *page = &hist_stage.page;
+    uint8_t ch;
+
+    page->magic = HISTORY_MAGIC;
+    page->boot = hist_boot;
+    page->interval_ms = HISTORY_INTERVAL_MS;
+    page->seq = hist_seq++;
+    page->first_ms = time_ms;
+    page->last_ms = time_ms;
+    page->chmask = chmask;
+    page->count = 0;
+    page->used = 0;
+    page->reserved = 0xFF;
+
+    hist_channels = 0;
+    for (ch = 0; ch < HISTORY_CHANNELS; ch++) hist_channels += (chmask >> ch) & 1;
+}
+
+/* Smallest record that holds every delta to the previous one */
+static uint8_t History_Kind(uint32_t time_ms, const int16_t *values)
+{
+    const History_Page *page = &hist_stage.page;
+    uint8_t kind = HISTORY_REC_DELTA4;
+    int32_t d;
+    uint8_t i;
+
+    if (page->count == 0 || hist_since_key >= HISTORY_KEY_EVERY ||
+        time_ms != page->last_ms + page->interval_ms) return HISTORY_REC_KEY;
+
+    for (i = 0; i < hist_channels; i++)
+    {
+        d = (int32_t)values[i] - hist_last[i];
+        if (d < -128 || d > 127) return HISTORY_REC_KEY;
+        if (d < -8 || d > 7) kind = HISTORY_REC_DELTA8;
+    }
+    return kind;
+}
+
+static uint8_t History_Size(uint8_t kind)
+{
+    if (kind == HISTORY_REC_KEY) return (uint8_t)(1 + 4 + 2 * hist_channels);
+    if (kind == HISTORY_REC_DELTA8) return (uint8_t)(1 + hist_channels);
+    return (uint8_t)(1 + (hist_channels + 1) / 2);
+}
+
+void History_Add(uint32_t time_ms, uint8_t chmask, const int16_t *values)
+{
+    History_Page *page = &hist_stage.page;
+    uint8_t *rec;
+    uint8_t kind, size, i;
+    int32_t d;
+
+    if (!chmask) return;
+    if (page->count && page->chmask != chmask) History_Commit();
+    if (page->count == 0) History_Open(time_ms, chmask);
+
+    kind = History_Kind(time_ms, values);
+    size = History_Size(kind);
+    if (page->used + size > HISTORY_PAYLOAD)
+    {
+        History_Commit();
+        History_Open(time_ms, chmask);
+        kind = HISTORY_REC_KEY;
+        size = History_Size(kind);
+    }
+
+    rec = hist_stage.bytes + HISTORY_HEADER + page->used;
+    *rec++ = kind;
+    if (kind == HISTORY_REC_KEY)
+    {
+        for (i = 0; i < 4; i++) *rec++ = (uint8_t)(time_ms >> (8 * i));
+        for (i = 0; i < hist_channels; i++)
+        {
+            *rec++ = (uint8_t)values[i];
+            *rec++ = (uint8_t)((uint16_t)values[i] >> 8);
+        }
+    }
+    else
+    {
+        if (kind == HISTORY_REC_DELTA4)
+        {
+            for (i = 0; i < (hist_channels + 1) / 2; i++) rec[i] = 0;
+        }
+        for (i = 0; i < hist_channels; i++)
+        {
+            d = (int32_t)values[i] - hist_last[i];
+            if (kind == HISTORY_REC_DELTA8) rec[i] = (uint8_t)d;
+            else rec[i / 2] |= (uint8_t)((d & 0x0F) << (4 * (i & 1)));
+        }
+    }
+
+    for (i = 0; i < hist_channels; i++) hist_last[i] = values[i];
+    hist_since_key = (kind == HISTORY_REC_KEY) ? 0 : (uint8_t)(hist_since_key + 1);
+    page->used = (uint8_t)(page->used + size);
+    page->count++;
+    page->last_ms = time_ms;
+
+    // Program as soon as the smallest record no longer fits
+    if (page->used + History_Size(HISTORY_REC_DELTA4) > HISTORY_PAYLOAD) History_Commit();
+}
+
+/* Header check only: the CRC is checked when the page is sent */
+static uint8_t History_Match(const History_Page *p)
+{
+    return p->magic == HISTORY_MAGIC && p->boot == hist_boot && p->count &&
+           p->first_ms <= dl_to && p->last_ms >= dl_from;
+}
+
+uint16_t History_Download(uint32_t from_ms, uint32_t to_ms)
+{
+    const History_Page *p;
+    uint16_t pages = 0;
+    uint16_t i;
+
+    dl_from = from_ms;
+    dl_to = to_ms;
+    dl_start = hist_head;
+    dl_next = 1;
+    dl_stage = 1;
+
+    // Same test as History_Next(), so the count is what gets sent
+    for (i = 0; i < HISTORY_PAGES; i++)
+    {
+        p = History_Flash(i);
+        pages += History_Match(p) && History_Valid(p);
+    }
+    return (uint16_t)(pages + History_Match(&hist_stage.page));
+}
+
+const History_Page *History_Next(void)
+{
+    const History_Page *p;
+
+    // hist_head of the start is visited last: written since, if at all
+    while (dl_next <= HISTORY_PAGES)
+    {
+        p = History_Flash((uint16_t)((dl_start + dl_next++) % HISTORY_PAGES));
+        if (History_Match(p) && History_Valid(p)) return p;
+    }
+
+    if (dl_stage)
+    {
+        dl_stage = 0;
+        if (History_Match(&hist_stage.page))
+        {
+            hist_stage.page.crc = History_Crc(&hist_stage.page);
+            return &hist_stage.page;
+        }
+    }
+    return 0;
+}
+
+uint16_t History_Boot(void)
+{
+    return hist_boot;
+}
+
+uint16_t History_Pages(void)
+{
+    return hist_pages;
+}
+
+uint32_t History_Errors(void)
+{
+    return hist_errors;
+}
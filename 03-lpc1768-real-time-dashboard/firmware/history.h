@@ -0,0 +1,79 @@
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <LPC17xx.h>
+#include "iap.h"
+
+/*
+ * Flash history log: circular, in sectors 26 - 29 (0x60000 - 0x7FFFF,
+ * 4 x 32 KB). Keep the firmware (IROM1) below HISTORY_BASE.
+ *
+ * Records are collected in a RAM page and written with one IAP page
+ * write when it is full; the sector ahead is erased when the log enters
+ * it, so the oldest 32 KB go at once. Each page decodes on its own:
+ *
+ *   History_Page header, then records until `used`:
+ *   KEY     tag, time_ms u32, i16 per channel     (first of every page)
+ *   DELTA8  tag, i8 per channel                    time = previous + interval
+ *   DELTA4  tag, i4 per channel, two per byte (low nibble first)
+ *
+ * Deltas are against the previous record, in channel units. A key
+ * record also follows any gap in time and every HISTORY_KEY_EVERY
+ * records.
+ */
+#define HISTORY_BASE        0x00060000UL
+#define HISTORY_SIZE        0x00020000UL
+#define HISTORY_SECTOR_SIZE 0x8000UL
+#define HISTORY_PAGE_SIZE   IAP_PAGE_SIZE
+#define HISTORY_PAGES       (HISTORY_SIZE / HISTORY_PAGE_SIZE)
+#define HISTORY_SECTOR_PAGES (HISTORY_SECTOR_SIZE / HISTORY_PAGE_SIZE)
+
+#define HISTORY_MAGIC       0x4C47              // "GL" in flash
+#define HISTORY_CHANNELS    8                   // chmask bits
+#define HISTORY_INTERVAL_MS 1000                // One record per second
+#define HISTORY_KEY_EVERY   30
+
+#define HISTORY_REC_KEY     1
+#define HISTORY_REC_DELTA8  2
+#define HISTORY_REC_DELTA4  3
+
+typedef struct {
+    uint16_t magic;                         // HISTORY_MAGIC
+    uint16_t crc;                           // CRC16 from boot to the last used byte
+    uint16_t boot;                          // Power-up count, +1 per History_Init()
+    uint16_t interval_ms;                   // Record spacing (delta records)
+    uint32_t seq;                           // Page number, never repeats
+    uint32_t first_ms;                      // Time of the first / last record
+    uint32_t last_ms;
+    uint8_t  chmask;                        // Channels in every record (bit n = AD0.n)
+    uint8_t  count;                         // Records
+    uint8_t  used;                          // Record bytes after the header
+    uint8_t  reserved;
+} History_Page;
+
+#define HISTORY_HEADER      sizeof(History_Page)    // 24
+#define HISTORY_PAYLOAD     (HISTORY_PAGE_SIZE - HISTORY_HEADER)
+
+/* Finds the newest page in flash and starts a new boot */
+void History_Init(void);
+
+/* One record: values of the channels in chmask (lowest first), channel
+   units. A new chmask starts a new page. */
+void History_Add(uint32_t time_ms, uint8_t chmask, const int16_t *values);
+
+/* Download of this boot's records between from_ms and to_ms: returns the
+   pages to send, History_Next() hands them out oldest first (the open
+   RAM page last), 0 when done. A new download replaces the old one.
+
+   Times are scheduler ticks of this boot, not wall time: IAP runs with
+   interrupts masked, so SysTick loses ~100 ms per sector erase (every
+   ~1.6 h) and up to 1 ms per page write. time_ms runs slow by about
+   0.15 s per hour, and the drift adds up over the boot. */
+uint16_t History_Download(uint32_t from_ms, uint32_t to_ms);
+const History_Page *History_Next(void);
+
+uint16_t History_Boot(void);
+uint16_t History_Pages(void);               // Valid pages in flash
+uint32_t History_Errors(void);              // Failed erases / writes
+
+#endif /* HISTORY_H_ */
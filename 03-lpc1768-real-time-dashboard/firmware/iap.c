@@ -0,0 +1,61 @@
+#include "iap.h"
+#include "clock_config.h"
+
+/* Boot ROM commands */
+#define IAP_CMD_PREPARE     50
+#define IAP_CMD_COPY        51
+#define IAP_CMD_ERASE       52
+
+typedef void (*IAP_Entry)(uint32_t *command, uint32_t *result);
+
+static const IAP_Entry iap_entry = (IAP_Entry)IAP_LOCATION;
+
+uint32_t IAP_Sector(uint32_t addr)
+{
+    if (addr < 0x10000) return addr >> 12;
+    return 16 + ((addr - 0x10000) >> 15);
+}
+
+/*
+ * Prepare (unlock) the sectors, then run the command, with interrupts
+ * masked throughout. The ROM needs the running core clock in kHz.
+ */
+static uint32_t IAP_Run(uint32_t first, uint32_t last, uint32_t *command)
+{
+    uint32_t prepare[3];
+    uint32_t result[5];
+
+    prepare[0] = IAP_CMD_PREPARE;
+    prepare[1] = first;
+    prepare[2] = last;
+
+    __disable_irq();
+    iap_entry(prepare, result);
+    if (result[0] == IAP_SUCCESS) iap_entry(command, result);
+    __enable_irq();
+
+    return result[0];
+}
+
+uint32_t IAP_Erase(uint32_t first, uint32_t last)
+{
+    uint32_t command[4];
+
+    command[0] = IAP_CMD_ERASE;
+    command[1] = first;
+    command[2] = last;
+    command[3] = Clock_GetCCLK() / 1000;
+    return IAP_Run(first, last, command);
+}
+
+uint32_t IAP_Write(uint32_t dst, const void *src, uint32_t bytes)
+{
+    uint32_t command[5];
+
+    command[0] = IAP_CMD_COPY;
+    command[1] = dst;
+    command[2] = (uint32_t)src;
+    command[3] = bytes;
+    command[4] = Clock_GetCCLK() / 1000;
+    return IAP_Run(IAP_Sector(dst), IAP_Sector(dst + bytes - 1), command);
+}
@@ -0,0 +1,40 @@
+#ifndef IAP_H_
+#define IAP_H_
+
+#include <LPC17xx.h>
+
+/*
+ * In-Application Programming: flash erase / write through the boot ROM.
+ *
+ * Sectors 0 - 15 are 4 KB (0x00000 - 0x0FFFF), sectors 16 - 29 are
+ * 32 KB. Flash cannot be read while the ROM erases or writes it, so
+ * every call runs with interrupts masked (vectors and handlers live in
+ * flash): ~1 ms per page write, ~100 ms per sector erase.
+ *
+ * The ROM uses the top 32 bytes of the local SRAM (0x10007FE0) and up to
+ * 128 bytes of the caller's stack: keep IRAM1 below 0x10007FE0.
+ */
+#define IAP_LOCATION        0x1FFF1FF1UL        // Thumb entry point
+#define IAP_PAGE_SIZE       256                 // Smallest write (also 512, 1024, 4096)
+
+/* ROM status codes (0 = success) */
+#define IAP_SUCCESS         0
+#define IAP_SRC_ADDR_ERROR  2
+#define IAP_DST_ADDR_ERROR  3
+#define IAP_COUNT_ERROR     6
+#define IAP_INVALID_SECTOR  7
+#define IAP_NOT_BLANK       8
+#define IAP_NOT_PREPARED    9
+#define IAP_COMPARE_ERROR   10
+#define IAP_BUSY            11
+
+uint32_t IAP_Sector(uint32_t addr);             // Sector holding a flash address
+
+/* Erase sectors first .. last. Returns an IAP_* status. */
+uint32_t IAP_Erase(uint32_t first, uint32_t last);
+
+/* Write bytes (IAP_PAGE_SIZE multiple) from word-aligned RAM to an
+   erased, 256-byte aligned flash address. Returns an IAP_* status. */
+uint32_t IAP_Write(uint32_t dst, const void *src, uint32_t bytes);
+
+#endif /* IAP_H_ */
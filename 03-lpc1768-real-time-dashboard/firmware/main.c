@@ -1,62 +1,571 @@
 /*
  * Project: LPC1768 Sensor Dashboard
  * Author: Vishnu
- * Description: Main application loop. Reads LM35 temperature sensor 
- * and communicates with PC via UART0.
+ * Description: Main application. Scans the AD0 sensor channels
+ * and communicates with PC via UART0 (telemetry out, command lines in).
  */
 
-#include <stdio.h>
 #include "clock_config.h"
 #include "timer.h"
 #include "uart.h"
 #include "adc.h"
+#include "sensor.h"
+#include "telemetry.h"
+#include "sched.h"
+#include "cmd.h"
+#include "fmt.h"
+#include "prof.h"
+#include "stats.h"
+#include "history.h"
+#include "power.h"
+
+/* Acquisition: burst scans of the enabled AD0 channels, ~100 ms blocks */
+#define SCAN_RATE_HZ        500             // Default, "RATE <hz>" changes it
+#define SCAN_RATE_MAX       2000            // One ADC interrupt per scan
+#define SCAN_BLOCK_MS       100
+#define SCAN_CH_RESERVED    0xC0            // AD0.6 / AD0.7: UART0 pins
+
+/* Link content: raw streams values + samples; summary sends only the
+   window statistics and threshold events (both modes carry those) */
+#define MODE_RAW            0
+#define MODE_SUMMARY        1
+#define WINDOW_MS           1000            // Default statistics window, "WIN <ms>"
+#define WINDOW_MAX_MS       60000
+#define EVENTS_PER_RUN      2               // Per telemetry task run, rest stays queued
+
+/* Task periods (ms): each runs at its own rate on the SysTick scheduler */
+#define TASK_SAMPLE_MS      10              // Pick up finished blocks
+#define TASK_TELEMETRY_MS   50              // Ship readings and raw blocks
+#define TASK_COMMAND_MS     20              // Host command lines, baud negotiation
+#define TASK_STATUS_MS      1000            // CPU load, overruns
+#define TASK_HISTORY_MS     HISTORY_INTERVAL_MS  // One flash log record
+#define TASK_DOWNLOAD_MS    5               // Log download: refill free frame buffers
+
+/* A finished block is overwritten one block period later: it must outlive
+   the pick-up by Sample_Task plus the send by Telemetry_Task */
+#define SCAN_BLOCK_MIN_MS   (TASK_SAMPLE_MS + TASK_TELEMETRY_MS)
+
+#define DOWNLOAD_RESERVE    1               // Frame buffers left to live telemetry
+
+/*
+ * AD0 channel plan. Values are in channel units:
+ * LM35 0.1 C (10 mV/C), rails in mV (1:2 dividers), pressure in 0.01 bar
+ * (0.5 - 4.5 V = 0 - 10 bar through a 2:3 divider: mV * 3/8 - 125).
+ * AD0.6 / AD0.7 are P0.3 / P0.2, taken by UART0.
+ */
+static const ADC_ChannelConfig adc_defaults[ADC_CHANNELS] = {
+    /* on  filter              k  calibration                        */
+    {  1, ADC_FILTER_EMA,      3, SENSOR_CAL_LM35 },                  // AD0.0 LM35, board
+    {  1, ADC_FILTER_EMA,      3, SENSOR_CAL_LM35 },                  // AD0.1 LM35, enclosure
+    {  1, ADC_FILTER_EMA,      3, SENSOR_CAL_LM35 },                  // AD0.2 LM35, ambient
+    {  1, ADC_FILTER_EMA,      2, { SENSOR_GAIN_Q16(2, 1), 0 } },     // AD0.3 5 V rail
+    {  1, ADC_FILTER_MEDIAN3,  1, { SENSOR_GAIN_Q16(3, 8), -125 } },  // AD0.4 Pressure
+    {  1, ADC_FILTER_EMA,      2, { SENSOR_GAIN_Q16(2, 1), 0 } },     // AD0.5 3.3 V rail
+    {  0, ADC_FILTER_NONE,     1, { 0, 0 } },                         // AD0.6 (RXD0)
+    {  0, ADC_FILTER_NONE,     1, { 0, 0 } }                          // AD0.7 (TXD0)
+};
+
+/* Running configuration: defaults with the "CH" selection applied */
+static ADC_ChannelConfig adc_channels[ADC_CHANNELS];
+
+/* Latest full block, handed over by the ADC interrupt */
+static const uint16_t * volatile scan_block;
+static volatile uint32_t scan_tick;         // Scheduler tick the block completed
+
+/* Sampling task -> telemetry task. A block stays valid for one block
+   period (the interrupt wraps back to it), at least SCAN_BLOCK_MIN_MS. */
+static const uint16_t *tlm_block;           // 0 = nothing new
+static uint32_t tlm_time;                   // First scan of the block (ms)
+static uint8_t tlm_mask;                    // Channels in the block / values
+static uint8_t tlm_count;
+static int16_t tlm_values[ADC_CHANNELS];
+
+static uint32_t scan_rate_hz;              // Achieved rate
+static uint16_t scan_n;                     // Scans per block
+static uint32_t scan_block_ms;
+
+static uint8_t link_mode = MODE_RAW;
+static uint32_t window_ms = WINDOW_MS;
+
+static uint8_t sleep_request = 0;           // "SLEEP": after the reply has gone out
+static uint32_t sleep_seconds;
+
+/* ADC interrupt: a ping or pong block is full */
+static void Scans_Ready(const uint16_t *block, uint16_t n, uint8_t half)
+{
+    (void)n;
+    (void)half;
+    scan_tick = Sched_Ticks();
+    scan_block = block;
+}
+
+/* Snapshot of every channel (filtered, calibrated) next to the raw block,
+   window statistics over every scan, threshold check on the snapshot */
+static void Sample_Task(uint32_t now)
+{
+    const uint16_t *block = scan_block;
+    ADC_Snapshot snap;
+    uint8_t ch;
+
+    (void)now;
+    if (!block) return;
+    scan_block = 0;
+
+    ADC_GetSnapshot(&snap);
+
+    tlm_count = 0;
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (snap.mask & (1 << ch)) tlm_values[tlm_count++] = (int16_t)snap.value[ch];
+    }
+    tlm_mask = snap.mask;
+    tlm_time = scan_tick - scan_block_ms;
+    tlm_block = block;
+
+    Stats_AddBlock(block, scan_n, tlm_time);
+    Stats_Check(&snap, scan_tick);
+}
+
+/* Binary telemetry (DMA, returns immediately): threshold events and
+   closed windows first, then in raw mode every channel in one values
+   frame plus the raw scans once the link can carry them */
+static void Telemetry_Task(uint32_t now)
+{
+    Stats_Window window;
+    Stats_Event event;
+    uint8_t i;
+
+    (void)now;
+    for (i = 0; i < EVENTS_PER_RUN && Stats_GetEvent(&event); i++) Telemetry_SendEvent(&event);
+    if (Stats_GetWindow(&window)) Telemetry_SendSummary(&window);
+
+    if (!tlm_block) return;
+
+    if (link_mode == MODE_RAW)
+    {
+        Telemetry_SendValues(tlm_time, tlm_mask, tlm_values);
+        if (UART0_GetBaud() >= TLM_SAMPLES_MIN_BAUD)
+        {
+            Telemetry_SendSamples(tlm_time, tlm_mask, scan_rate_hz, tlm_block, scan_n * tlm_count);
+        }
+    }
+    tlm_block = 0;
+}
+
+/* Flash history: every enabled channel, filtered and calibrated */
+static void History_Task(uint32_t now)
+{
+    ADC_Snapshot snap;
+    int16_t values[ADC_CHANNELS];
+    uint8_t n = 0;
+    uint8_t ch;
+
+    (void)now;
+    ADC_GetSnapshot(&snap);
+    if (!snap.seq) return;                  // No scan yet
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (snap.mask & (1 << ch)) values[n++] = (int16_t)snap.value[ch];
+    }
+    // Release tick, not 'now': a late run must not break the 1 s spacing
+    // the delta records rely on (one late tick would force two KEYs)
+    History_Add(Sched_Release(), snap.mask, values);
+}
+
+/* "LOG" download at link speed: one page per free frame buffer */
+static void Download_Task(uint32_t now)
+{
+    const History_Page *page;
+
+    (void)now;
+    while (Telemetry_Free() > DOWNLOAD_RESERVE && (page = History_Next()) != 0)
+    {
+        Telemetry_SendHistory(page);
+    }
+}
+
+/* Statistics windows of window_ms, at least one block */
+static void Window_Start(void)
+{
+    uint32_t scans = scan_rate_hz * window_ms / 1000;
+
+    Stats_Config(adc_channels, scan_rate_hz, scans < scan_n ? scan_n : scans);
+}
+
+/* (Re)start the burst scans of adc_channels, keeping blocks near
+   SCAN_BLOCK_MS whatever the rate (and within ADC_BLOCK_MAX samples).
+   When ADC_BLOCK_MAX shortens the block below SCAN_BLOCK_MIN_MS, the
+   rate is lowered instead (reported back by RATE). */
+static uint8_t Scan_Start(uint32_t rate_hz)
+{
+    uint32_t n = rate_hz * SCAN_BLOCK_MS / 1000;
+    uint32_t rate;
+    uint8_t count = 0;
+    uint8_t ch;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++) count += adc_channels[ch].enable;
+    if (count == 0) return 0;
+
+    if (n < 1) n = 1;
+    if (n > ADC_BLOCK_MAX / count) n = ADC_BLOCK_MAX / count;
+    if (n * 1000 < rate_hz * SCAN_BLOCK_MIN_MS) rate_hz = n * 1000 / SCAN_BLOCK_MIN_MS;
+
+    rate = ADC_ScanStart(adc_channels, rate_hz, (uint16_t)n, Scans_Ready);
+    if (!rate) return 0;
+
+    scan_block = 0;                         // Drop blocks of the old layout
+    tlm_block = 0;
+    scan_rate_hz = rate;
+    scan_n = (uint16_t)n;
+    scan_block_ms = n * 1000 / rate;
+    Window_Start();
+    return 1;
+}
+
+/* ----------------------------------------------------------------
+   Host commands (cmd.c)
+   ---------------------------------------------------------------- */
+
+/* LED <0|1>: user LED on P0.1 */
+static uint8_t Cmd_Led(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t on;
+
+    (void)argc;
+    (void)reply;
+    if (!Cmd_ParseUInt(argv[1], &on) || on > 1) return 0;
+
+    if (on) LPC_GPIO0->FIOSET = (1 << 1);
+    else    LPC_GPIO0->FIOCLR = (1 << 1);
+    return 1;
+}
+
+/* RATE <hz>: scan rate, answers with the achieved rate */
+static uint8_t Cmd_Rate(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t hz;
+
+    (void)argc;
+    if (!Cmd_ParseUInt(argv[1], &hz) || hz == 0 || hz > SCAN_RATE_MAX) return 0;
+    if (!Scan_Start(hz)) return 0;
+
+    Fmt_UInt(reply, scan_rate_hz);
+    return 1;
+}
+
+/* CH <mask>: channels to scan, bit n = AD0.n (AD0.6 / AD0.7 not allowed) */
+static uint8_t Cmd_Channels(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t mask;
+    uint8_t prev = 0;
+    uint8_t ch;
+
+    (void)argc;
+    (void)reply;
+    if (!Cmd_ParseUInt(argv[1], &mask)) return 0;
+    if (mask == 0 || (mask & ~(uint32_t)(0xFF & ~SCAN_CH_RESERVED))) return 0;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        prev |= (uint8_t)(adc_channels[ch].enable << ch);
+        adc_channels[ch].enable = (mask >> ch) & 1;
+    }
+    if (Scan_Start(scan_rate_hz)) return 1;
+
+    // Refused: keep (and resume) the previous channel set
+    for (ch = 0; ch < ADC_CHANNELS; ch++) adc_channels[ch].enable = (prev >> ch) & 1;
+    Scan_Start(scan_rate_hz);
+    return 0;
+}
+
+/* BAUD <rate>: announce, switch, revert unless ACK follows */
+static uint8_t Cmd_Baud(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t baud;
+
+    (void)argc;
+    (void)reply;
+    return Cmd_ParseUInt(argv[1], &baud) && Telemetry_LinkRequest(baud);
+}
+
+/* ACK: host is listening at the new rate */
+static uint8_t Cmd_Ack(uint8_t argc, char *argv[], char *reply)
+{
+    (void)argc;
+    (void)argv;
+    (void)reply;
+    Telemetry_LinkAck();
+    return 1;
+}
+
+/* MODE RAW|SUMMARY: what goes on the link */
+static uint8_t Cmd_Mode(uint8_t argc, char *argv[], char *reply)
+{
+    (void)argc;
+    (void)reply;
+    if (Cmd_Match(argv[1], "RAW")) link_mode = MODE_RAW;
+    else if (Cmd_Match(argv[1], "SUMMARY")) link_mode = MODE_SUMMARY;
+    else return 0;
+    return 1;
+}
+
+/* WIN <ms>: statistics window, answers the window in scans */
+static uint8_t Cmd_Window(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t ms;
+
+    (void)argc;
+    if (!Cmd_ParseUInt(argv[1], &ms) || ms < SCAN_BLOCK_MS || ms > WINDOW_MAX_MS) return 0;
+
+    window_ms = ms;
+    Window_Start();
+    Fmt_UInt(reply, scan_rate_hz * ms / 1000);
+    return 1;
+}
+
+/* THR <ch> <low> <high> | THR <ch> OFF: hysteresis thresholds, channel units */
+static uint8_t Cmd_Threshold(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t ch;
+    int32_t low, high;
+
+    (void)reply;
+    if (!Cmd_ParseUInt(argv[1], &ch) || ch >= ADC_CHANNELS) return 0;
+
+    if (argc == 3 && Cmd_Match(argv[2], "OFF"))
+    {
+        Stats_ClearThreshold((uint8_t)ch);
+        return 1;
+    }
+    if (argc != 4 || !Cmd_ParseInt(argv[2], &low) || !Cmd_ParseInt(argv[3], &high)) return 0;
+    if (low < -32768 || high > 32767) return 0;
+
+    return Stats_SetThreshold((uint8_t)ch, (int16_t)low, (int16_t)high);
+}
+
+/* LOG <from_ms> <to_ms>: this boot's flash history, answers the number of
+   history frames that follow. LOG INFO: boot, pages stored, flash errors */
+static uint8_t Cmd_Log(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t from, to;
+
+    if (argc == 2 && Cmd_Match(argv[1], "INFO"))
+    {
+        reply = Fmt_UInt(reply, History_Boot());
+        reply = Fmt_Str(reply, " ");
+        reply = Fmt_UInt(reply, History_Pages());
+        reply = Fmt_Str(reply, " ");
+        Fmt_UInt(reply, History_Errors());
+        return 1;
+    }
+    if (argc != 3 || !Cmd_ParseUInt(argv[1], &from) || !Cmd_ParseUInt(argv[2], &to) || from > to) return 0;
+
+    Fmt_UInt(reply, History_Download(from, to));
+    return 1;
+}
+
+/* CLOCK [PERF|DEFAULT|LOW]: switch the clock profile, answers name and CCLK */
+static uint8_t Cmd_Clock(uint8_t argc, char *argv[], char *reply)
+{
+    UART_Divider d;
+    uint8_t i;
+
+    if (argc > 1)
+    {
+        for (i = 0; i < CLOCK_PROFILES && !Cmd_Match(argv[1], Clock_ProfileName(i)); i++);
+
+        // UART0 runs at CCLK: if the new profile cannot keep the link rate the
+        // driver drops to the reset default, so tell the dashboard first
+        if (i < CLOCK_PROFILES && Clock_ProfileCCLK(i) <= CLOCK_CCLK_MAX_HZ &&
+            UART0_GetBaud() != UART_BAUD_DEFAULT &&
+            !UART_MatchBaud(Clock_ProfileCCLK(i), UART0_GetBaud(), &d))
+        {
+            Telemetry_LinkAnnounce(Sched_Ticks(), UART_BAUD_DEFAULT);
+        }
+        if (!Clock_SetProfile(i)) return 0;
+    }
+
+    reply = Fmt_Str(reply, Clock_ProfileName(Clock_GetProfile()));
+    reply = Fmt_Str(reply, " ");
+    Fmt_UInt(reply, Clock_GetCCLK());
+    return 1;
+}
+
+/* STAT: receive line errors, TX errors, rejected command lines, achieved baud */
+static uint8_t Cmd_Stat(uint8_t argc, char *argv[], char *reply)
+{
+    UART_RxStats rx;
+    char *p = reply;
+
+    (void)argc;
+    (void)argv;
+    UART0_RxStats(&rx);
+
+    p = Fmt_Str(p, "ovr ");
+    p = Fmt_UInt(p, rx.overrun);
+    p = Fmt_Str(p, " fe ");
+    p = Fmt_UInt(p, rx.framing);
+    p = Fmt_Str(p, " pe ");
+    p = Fmt_UInt(p, rx.parity);
+    p = Fmt_Str(p, " brk ");
+    p = Fmt_UInt(p, rx.breaks);
+    p = Fmt_Str(p, " drop ");
+    p = Fmt_UInt(p, rx.dropped);
+    p = Fmt_Str(p, " tx ");
+    p = Fmt_UInt(p, UART0_TxErrors());
+    p = Fmt_Str(p, " cmd ");
+    p = Fmt_UInt(p, Cmd_Errors());
+    p = Fmt_Str(p, " baud ");
+    Fmt_UInt(p, UART0_GetBaudActual());
+    return 1;
+}
+
+/* SLEEP <s>: Deep Sleep until the RTC alarm after s seconds (0 = EINT0
+   only) or the EINT0 button, entered by the command task after the reply */
+static uint8_t Cmd_Sleep(uint8_t argc, char *argv[], char *reply)
+{
+    uint32_t s;
+
+    (void)argc;
+    (void)reply;
+    if (!Cmd_ParseUInt(argv[1], &s) || s > POWER_SLEEP_MAX_S) return 0;
+
+    sleep_seconds = s;
+    sleep_request = 1;
+    return 1;
+}
+
+/* POWER: powered peripheral blocks (PCONP) */
+static uint8_t Cmd_Power(uint8_t argc, char *argv[], char *reply)
+{
+    (void)argc;
+    (void)argv;
+    reply = Fmt_Str(reply, "0x");
+    Fmt_Hex(reply, Power_Mask(), 8);
+    return 1;
+}
+
+/* TASKS: scheduler table (CPU share, runs, overruns, delay, cycles) as text */
+static uint8_t Cmd_Tasks(uint8_t argc, char *argv[], char *reply)
+{
+    static char text[SCHED_FORMAT_MAX];
+
+    (void)argc;
+    (void)argv;
+    (void)reply;
+    Sched_Format(text);
+    return Telemetry_SendText(Sched_Ticks(), text);
+}
+
+#if PROF_ENABLE
+/* PROF [RESET]: probe table (cycles) as one text frame */
+static uint8_t Cmd_Prof(uint8_t argc, char *argv[], char *reply)
+{
+    static char text[PROF_FORMAT_MAX];
+
+    (void)reply;
+    if (argc > 1)
+    {
+        if (!Cmd_Match(argv[1], "RESET")) return 0;
+        Prof_Reset();
+        return 1;
+    }
+    Prof_Format(text);
+    return Telemetry_SendText(Sched_Ticks(), text);
+}
+#endif
+
+static const Cmd_Entry commands[] = {
+    /* name    args  handler       usage           */
+    { "LED",   1,    Cmd_Led,      "LED <0|1>"     },
+    { "RATE",  1,    Cmd_Rate,     "RATE <hz>"     },
+    { "CH",    1,    Cmd_Channels, "CH <mask>"     },
+    { "BAUD",  1,    Cmd_Baud,     "BAUD <rate>"   },
+    { "ACK",   0,    Cmd_Ack,      "ACK"           },
+    { "STAT",  0,    Cmd_Stat,     "STAT"          },
+    { "MODE",  1,    Cmd_Mode,     "MODE RAW|SUMMARY" },
+    { "WIN",   1,    Cmd_Window,   "WIN <ms>"      },
+    { "THR",   2,    Cmd_Threshold, "THR <ch> <low> <high> | THR <ch> OFF" },
+    { "LOG",   1,    Cmd_Log,      "LOG <from_ms> <to_ms> | LOG INFO" },
+    { "CLOCK", 0,    Cmd_Clock,    "CLOCK [PERF|DEFAULT|LOW]" },
+    { "SLEEP", 1,    Cmd_Sleep,    "SLEEP <s>"     },
+    { "POWER", 0,    Cmd_Power,    "POWER"         },
+    { "TASKS", 0,    Cmd_Tasks,    "TASKS"         },
+#if PROF_ENABLE
+    { "PROF",  0,    Cmd_Prof,     "PROF [RESET]"  },
+#endif
+};
+
+/* Command lines from the dashboard, then any baud switch or Deep Sleep
+   they asked for */
+static void Command_Task(uint32_t now)
+{
+    Cmd_Poll(now);
+    Telemetry_Service(now);
+
+    if (sleep_request)
+    {
+        sleep_request = 0;
+        Sched_Skip(Power_DeepSleep(sleep_seconds));
+    }
+
+#if PROF_ENABLE
+    Prof_Pend(PROF_UART0_LAT, UART0_IRQn);  // One UART0 latency sample per run
+#endif
+}
+
+static void Status_Task(uint32_t now)
+{
+    Telemetry_SendStatus(now, Sched_Load(), Sched_Overruns());
+}
 
 int main(void)
 {
-    char buffer[50];
-    uint16_t adc_raw_val;
-    float voltage_mv;
-    float temperature_c;
+    uint8_t i;
 
     /* ----------------------------------------------------------------
        1. Hardware Initialization
        ---------------------------------------------------------------- */
-    SetupClock();    // Configure System Clock to 100 MHz
+    SetupClock();    // Boot clock profile (100 MHz, CLOCK command switches)
+    Power_Init();    // Every peripheral off: drivers power their own
     __enable_irq();  // Enable Global Interrupts
 
     /* Configure GPIO
        P0.0: Heartbeat LED (Timer0 Controlled)
-       P0.1: User LED (UART Command Controlled) */
-    LPC_GPIO0->FIODIR |= (1 << 0) | (1 << 1); 
+       P0.1: User LED ("LED" command) */
+    LPC_GPIO0->FIODIR |= (1 << 0) | (1 << 1);
 
+    Sched_Init();    // 1 ms SysTick timebase
+#if PROF_ENABLE
+    Prof_Init();     // DWT probe table
+#endif
     Timer0_Init();   // Start Heartbeat Timer (500ms)
     UART0_Init();    // Start UART (9600 Baud, Interrupt Enabled)
-    ADC_Init();      // Start ADC (Channel 0)
+    ADC_Init();      // Start ADC (software reads until scanning starts)
+    History_Init();  // Find the end of the flash log
+
+    Telemetry_SendText(0, "System Online. Mode: Multi-channel Sensor Monitor");
 
-    UART0_TxString("System Online. Mode: LM35 Temperature Monitor\r\n");
+#if SENSOR_BENCHMARK
+    Sensor_Benchmark(ADC_Read());
+#endif
+
+    // Timer1-paced burst scans of every enabled channel
+    for (i = 0; i < ADC_CHANNELS; i++) adc_channels[i] = adc_defaults[i];
+    Scan_Start(SCAN_RATE_HZ);
+
+    Cmd_Init(commands, sizeof(commands) / sizeof(commands[0]));
 
     /* ----------------------------------------------------------------
-       2. Main Application Loop
+       2. Task Table (offsets spread the releases over the ticks)
        ---------------------------------------------------------------- */
-    while (1)
-    {
-        // A. Read Raw ADC Value (0 - 4095)
-        adc_raw_val = ADC_Read();
-        
-        // B. Convert to Voltage (Assuming VREF = 3.3V = 3300mV)
-        voltage_mv = (adc_raw_val * 3300.0f) / 4095.0f;
-        
-        // C. Convert to Temperature (LM35: 10mV = 1 Degree Celsius)
-        temperature_c = voltage_mv / 10.0f;
-        
-        // D. Format Data: "Temp: 25.4 C"
-        // NOTE: sprintf used for clarity; may be replaced with a lighter formatter in production
-        sprintf(buffer, "Temp: %.1f C\r\n", temperature_c);
-        
-        // E. Transmit to PC Dashboard
-        UART0_TxString(buffer);
-        
-        // F. Update Rate (500ms)
-        delay_ms(500); 
-    }
+    Sched_Add("sample",    Sample_Task,    TASK_SAMPLE_MS,    0);
+    Sched_Add("telemetry", Telemetry_Task, TASK_TELEMETRY_MS, 5);
+    Sched_Add("command",   Command_Task,   TASK_COMMAND_MS,   3);
+    Sched_Add("status",    Status_Task,    TASK_STATUS_MS,    7);
+    Sched_Add("history",   History_Task,   TASK_HISTORY_MS,   9);
+    Sched_Add("download",  Download_Task,  TASK_DOWNLOAD_MS,  1);
+
+    Sched_Run();     // Never returns: sleeps in WFI between releases
 }
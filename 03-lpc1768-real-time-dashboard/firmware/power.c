@@ -0,0 +1,123 @@
+#include "power.h"
+#include "clock_config.h"
+
+/*
+ * Plain Sleep needs no setup: PCON.PM = 00 with SLEEPDEEP clear, so the
+ * scheduler's WFI only stops the core clock and every peripheral keeps
+ * running. Deep Sleep is entered here only.
+ */
+
+#define RTC_CCR_CLKEN       (1 << 0)
+#define RTC_CCR_CCALEN      (1 << 4)            // 1 = calibration counter off
+#define RTC_ILR_ALL         0x3                 // Counter increment + alarm flags
+#define RTC_AMR_ALL         0xFF                // Every alarm field masked (off)
+#define RTC_AMR_SEC_ONLY    0xFE                // Compare the seconds only
+
+static volatile uint8_t power_wake;
+
+void EINT0_IRQHandler(void)
+{
+    LPC_SC->EXTINT = (1 << 0);                  // Clear the edge flag
+    power_wake = 1;
+}
+
+void RTC_IRQHandler(void)
+{
+    LPC_RTC->ILR = RTC_ILR_ALL;                 // Both: either one keeps the IRQ asserted
+    power_wake = 1;
+}
+
+void Power_Init(void)
+{
+    LPC_SC->PCONP = POWER_KEEP;
+    LPC_SC->PCON &= ~0x3UL;                     // PM = 00: WFI enters (Deep) Sleep
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+void Power_On(uint8_t block)
+{
+    LPC_SC->PCONP |= (1UL << block);
+}
+
+void Power_Off(uint8_t block)
+{
+    if ((1UL << block) & POWER_KEEP) return;
+    LPC_SC->PCONP &= ~(1UL << block);
+}
+
+uint8_t Power_IsOn(uint8_t block)
+{
+    return (LPC_SC->PCONP >> block) & 1;
+}
+
+uint32_t Power_Mask(void)
+{
+    return LPC_SC->PCONP;
+}
+
+/* Minutes and seconds of the RTC, in seconds (CTIME0 reads both at once) */
+static uint32_t Power_RtcSeconds(void)
+{
+    uint32_t t = LPC_RTC->CTIME0;
+
+    return ((t >> 8) & 0x3F) * 60 + (t & 0x3F);
+}
+
+uint32_t Power_DeepSleep(uint32_t seconds)
+{
+    uint32_t start;
+    uint32_t slept;
+
+    if (seconds > POWER_SLEEP_MAX_S) return 0;
+
+    // RTC: free-running from its own oscillator, alarm on the seconds field.
+    // Its registers are not reset and undefined at power-up: no increment
+    // interrupts, no calibration, no stale flags.
+    Power_On(POWER_RTC);
+    LPC_RTC->CCR = RTC_CCR_CLKEN | RTC_CCR_CCALEN;
+    LPC_RTC->CIIR = 0;
+    LPC_RTC->AMR = RTC_AMR_ALL;
+    LPC_RTC->ILR = RTC_ILR_ALL;
+    start = Power_RtcSeconds();
+    if (seconds)
+    {
+        LPC_RTC->ALSEC = (uint8_t)((start + seconds) % 60);
+        LPC_RTC->AMR = RTC_AMR_SEC_ONLY;
+        NVIC_ClearPendingIRQ(RTC_IRQn);
+        NVIC_EnableIRQ(RTC_IRQn);
+    }
+
+    // EINT0 on P2.10, falling edge
+    LPC_PINCON->PINSEL4 = (LPC_PINCON->PINSEL4 & ~(0x3UL << 20)) | (0x1UL << 20);
+    LPC_SC->EXTMODE |= (1 << 0);
+    LPC_SC->EXTPOLAR &= ~(1UL << 0);
+    LPC_SC->EXTINT = (1 << 0);
+    NVIC_ClearPendingIRQ(EINT0_IRQn);
+    NVIC_EnableIRQ(EINT0_IRQn);
+
+    Clock_Suspend();                            // Drivers stop (CLOCK_PRE)
+
+    // Any other interrupt still pending (a last tick) only sleeps again
+    power_wake = 0;
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    __disable_irq();
+    while (!power_wake)
+    {
+        __WFI();
+        __enable_irq();                         // Waking interrupt runs here
+        __disable_irq();
+    }
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    __enable_irq();
+
+    Clock_Resume();                             // Profile again, drivers restart (CLOCK_POST)
+
+    NVIC_DisableIRQ(EINT0_IRQn);
+    NVIC_DisableIRQ(RTC_IRQn);
+    LPC_RTC->AMR = RTC_AMR_ALL;
+    LPC_PINCON->PINSEL4 &= ~(0x3UL << 20);      // P2.10 back to GPIO
+
+    slept = (Power_RtcSeconds() + 3600 - start) % 3600;
+    Power_Off(POWER_RTC);                       // Keeps counting, registers only
+    return slept * 1000;
+}
@@ -0,0 +1,63 @@
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <LPC17xx.h>
+
+/* PCONP bits: one per peripheral block */
+#define POWER_TIM0          1
+#define POWER_TIM1          2
+#define POWER_UART0         3
+#define POWER_UART1         4
+#define POWER_PWM1          6
+#define POWER_I2C0          7
+#define POWER_SPI           8
+#define POWER_RTC           9
+#define POWER_SSP1          10
+#define POWER_ADC           12
+#define POWER_CAN1          13
+#define POWER_CAN2          14
+#define POWER_GPIO          15
+#define POWER_RIT           16
+#define POWER_MCPWM         17
+#define POWER_QEI           18
+#define POWER_I2C1          19
+#define POWER_SSP0          21
+#define POWER_TIM2          22
+#define POWER_TIM3          23
+#define POWER_UART2         24
+#define POWER_UART3         25
+#define POWER_I2C2          26
+#define POWER_I2S           27
+#define POWER_GPDMA         29
+#define POWER_ENET          30
+#define POWER_USB           31
+
+#define POWER_KEEP          (1UL << POWER_GPIO)     // Never switched off
+
+/*
+ * Reset leaves 13 blocks powered (timers, UARTs, I2C, SPI, PWM, RTC ...).
+ * Power_Init() switches off all but POWER_KEEP; each driver powers its
+ * own blocks from its Init, so PCONP holds exactly what is in use.
+ */
+void Power_Init(void);
+void Power_On(uint8_t block);               // POWER_*
+void Power_Off(uint8_t block);
+uint8_t Power_IsOn(uint8_t block);
+uint32_t Power_Mask(void);                  // PCONP
+
+/*
+ * Deep Sleep: the main oscillator, PLL0 and every peripheral clock stop
+ * (SysTick and the heartbeat too), SRAM and registers are kept. Drivers
+ * stop through CLOCK_PRE and restart through CLOCK_POST when the clock
+ * profile is applied again after wake-up.
+ *
+ * Wake-up: EINT0 falling edge (P2.10, the ISP button on most boards) or
+ * the RTC alarm after seconds (1 - 59, 0 = EINT0 only; needs the
+ * 32.768 kHz crystal). Returns the time slept in ms, whole seconds from
+ * the RTC (for Sched_Skip()).
+ */
+#define POWER_SLEEP_MAX_S   59
+
+uint32_t Power_DeepSleep(uint32_t seconds);
+
+#endif /* POWER_H_ */
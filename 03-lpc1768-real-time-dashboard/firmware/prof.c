@@ -0,0 +1,123 @@
+#include "prof.h"
+
+#if PROF_ENABLE
+
+#include "fmt.h"
+
+/*
+ * Probe table
+ *
+ * A probe costs two CYCCNT reads and a call (~20 cycles); the cycles
+ * between two back-to-back reads are measured once and subtracted, so an
+ * empty ENTER / EXIT pair records ~0. The table is written by whichever
+ * context owns a probe and copied with interrupts masked when read.
+ */
+
+static const char * const prof_names[PROF_COUNT] = {
+    "adc_read", "adc_scan", "convert", "frame", "tx_queue",
+    "command", "uart0_isr", "tim0_lat", "uart0_lat"
+};
+
+uint32_t prof_start[PROF_COUNT];
+static Prof_Stat prof_stats[PROF_COUNT];
+static volatile uint32_t prof_pend_stamp[PROF_COUNT];
+static volatile uint8_t prof_pending[PROF_COUNT];
+static uint32_t prof_overhead = 0;
+
+void Prof_Init(void)
+{
+    uint32_t t;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    t = DWT->CYCCNT;
+    prof_overhead = DWT->CYCCNT - t;
+
+    Prof_Reset();
+}
+
+static void Prof_Add(uint8_t id, uint32_t cycles)
+{
+    Prof_Stat *s = &prof_stats[id];
+
+    if (s->count == 0 || cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->total += cycles;
+    s->count++;
+}
+
+void Prof_Record(uint8_t id, uint32_t cycles)
+{
+    Prof_Add(id, (cycles > prof_overhead) ? cycles - prof_overhead : 0);
+}
+
+void Prof_Latency(uint8_t id, uint32_t cycles)
+{
+    Prof_Add(id, cycles);
+}
+
+void Prof_Pend(uint8_t id, IRQn_Type irq)
+{
+    prof_pend_stamp[id] = DWT->CYCCNT;
+    prof_pending[id] = 1;
+    NVIC_SetPendingIRQ(irq);
+}
+
+void Prof_Entered(uint8_t id, uint32_t now)
+{
+    if (!prof_pending[id]) return;          // Real interrupt, no stamp
+    prof_pending[id] = 0;
+    Prof_Add(id, now - prof_pend_stamp[id]);
+}
+
+void Prof_Get(uint8_t id, Prof_Stat *s)
+{
+    __disable_irq();
+    *s = prof_stats[id];
+    __enable_irq();
+}
+
+const char *Prof_Name(uint8_t id)
+{
+    return (id < PROF_COUNT) ? prof_names[id] : "";
+}
+
+void Prof_Reset(void)
+{
+    uint8_t i;
+
+    __disable_irq();
+    for (i = 0; i < PROF_COUNT; i++)
+    {
+        prof_stats[i].count = 0;
+        prof_stats[i].min = 0;
+        prof_stats[i].max = 0;
+        prof_stats[i].total = 0;
+    }
+    __enable_irq();
+}
+
+char *Prof_Format(char *dst)
+{
+    Prof_Stat s;
+    uint8_t i;
+
+    for (i = 0; i < PROF_COUNT; i++)
+    {
+        Prof_Get(i, &s);
+        dst = Fmt_Str(dst, prof_names[i]);
+        dst = Fmt_Str(dst, " n ");
+        dst = Fmt_UInt(dst, s.count);
+        dst = Fmt_Str(dst, " min ");
+        dst = Fmt_UInt(dst, s.min);
+        dst = Fmt_Str(dst, " avg ");
+        dst = Fmt_UInt(dst, s.count ? (uint32_t)(s.total / s.count) : 0);
+        dst = Fmt_Str(dst, " max ");
+        dst = Fmt_UInt(dst, s.max);
+        if (i + 1 < PROF_COUNT) dst = Fmt_Str(dst, "\n");
+    }
+    return dst;
+}
+
+#endif /* PROF_ENABLE */
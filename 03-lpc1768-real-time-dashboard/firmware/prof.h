@@ -0,0 +1,72 @@
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <LPC17xx.h>
+
+/*
+ * DWT cycle-counter probes. PROF_ENTER / PROF_EXIT around a stage record
+ * its CPU cycles into a static table (count, min, max, mean); interrupt
+ * latency probes record request -> handler entry instead. Times in main context include
+ * any interrupt that preempted the stage.
+ *
+ * Each probe must be used from one context only (one ISR or main).
+ */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE         1                   // 0: probes compile to nothing
+#endif
+
+/* Probe points */
+#define PROF_ADC_READ       0                   // ADC_Read(): software conversion
+#define PROF_ADC_SCAN       1                   // ADC interrupt: one burst scan + filters
+#define PROF_CONVERT        2                   // ADC_GetSnapshot(): calibration maths
+#define PROF_FRAME          3                   // Telemetry frame: CRC16 + COBS
+#define PROF_TX_QUEUE       4                   // UART0_TxAsync() / UART0_TxString()
+#define PROF_COMMAND        5                   // One command line: parse, handler, reply
+#define PROF_UART0_ISR      6                   // UART0 interrupt: FIFO drain
+#define PROF_TIMER0_LAT     7                   // Timer0 match -> handler entry
+#define PROF_UART0_LAT      8                   // Pended -> UART0 handler entry
+#define PROF_COUNT          9
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;                               // CPU cycles
+    uint32_t max;
+    uint64_t total;
+} Prof_Stat;
+
+#if PROF_ENABLE
+
+extern uint32_t prof_start[PROF_COUNT];
+
+#define PROF_ENTER(id)          (prof_start[id] = DWT->CYCCNT)
+#define PROF_EXIT(id)           Prof_Record((id), DWT->CYCCNT - prof_start[id])
+#define PROF_LATENCY(id, cyc)   Prof_Latency((id), (cyc))
+#define PROF_IRQ_ENTRY(id)      Prof_Entered((id), DWT->CYCCNT)
+
+void Prof_Init(void);
+void Prof_Record(uint8_t id, uint32_t cycles);  // Less the probe's own cost
+void Prof_Latency(uint8_t id, uint32_t cycles);
+
+/* Software latency probe: stamp, pend irq; its handler's PROF_IRQ_ENTRY
+   records the cycles in between (only for a stamped entry) */
+void Prof_Pend(uint8_t id, IRQn_Type irq);
+void Prof_Entered(uint8_t id, uint32_t now);
+
+void Prof_Get(uint8_t id, Prof_Stat *s);
+const char *Prof_Name(uint8_t id);
+void Prof_Reset(void);
+
+/* "name count min mean max" per probe, one line each. Returns the end. */
+#define PROF_FORMAT_MAX         (PROF_COUNT * 72)
+char *Prof_Format(char *dst);
+
+#else
+
+#define PROF_ENTER(id)          ((void)0)
+#define PROF_EXIT(id)           ((void)0)
+#define PROF_LATENCY(id, cyc)   ((void)0)
+#define PROF_IRQ_ENTRY(id)      ((void)0)
+
+#endif /* PROF_ENABLE */
+
+#endif /* PROF_H_ */
@@ -0,0 +1,272 @@
+#include "sched.h"
+#include "clock_config.h"
+#include "fmt.h"
+
+/*
+ * Cooperative scheduler on a 1 ms SysTick
+ *
+ * The SysTick interrupt only counts ticks. Sched_Run() starts every task
+ * whose release time has come, re-arms it one period later and otherwise
+ * sleeps in WFI until the next interrupt (tick, DMA, UART ...).
+ *
+ * Deadline = period: a task still running at its next release counts an
+ * overrun and skips the releases it missed, keeping its phase.
+ *
+ * CPU load: the core sleeps with PRIMASK set, so the waking interrupt is
+ * held until the idle time has been read from the SysTick counter (which
+ * keeps running in Sleep). Everything else, tasks and ISRs, is load.
+ * Each task's share comes from its DWT cycles in the same window
+ * (including ISRs that preempted it), so the shares add up to a little
+ * less than the load: the rest is interrupts taken outside tasks.
+ *
+ * A clock profile switch reloads SysTick for the new core clock and
+ * restarts the load window; task cycle counts mix both clocks.
+ */
+
+static Sched_Task sched_tasks[SCHED_MAX_TASKS];
+static uint8_t sched_count = 0;
+
+static volatile uint32_t sched_ticks = 0;
+static uint32_t sched_cycles_per_tick;      // Core clock / SCHED_TICK_HZ
+
+static uint32_t idle_cycles = 0;            // Current window
+static uint32_t load_start = 0;             // Tick the window started
+static uint16_t load_permille = 0;
+static uint8_t load_skip = 0;               // Sched_Skip() ran: restart the window
+static uint32_t sched_release;              // Release tick of the task being dispatched
+
+/* Start a new load window at tick 'now' */
+static void Sched_Window(uint32_t now)
+{
+    uint8_t i;
+
+    idle_cycles = 0;
+    load_start = now;
+    for (i = 0; i < sched_count; i++) sched_tasks[i].cycles = 0;
+}
+
+void SysTick_Handler(void)
+{
+    sched_ticks++;
+}
+
+/* Clock profile switch: same 1 ms tick at the new core clock */
+static void Sched_ClockChange(uint8_t event)
+{
+    if (event != CLOCK_POST) return;
+
+    sched_cycles_per_tick = Clock_GetCCLK() / SCHED_TICK_HZ;
+    SysTick->LOAD = sched_cycles_per_tick - 1;
+    SysTick->VAL = 0;
+
+    Sched_Window(sched_ticks);
+}
+
+void Sched_Init(void)
+{
+    // Cycle counter for task execution times
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    sched_cycles_per_tick = Clock_GetCCLK() / SCHED_TICK_HZ;
+    SysTick_Config(sched_cycles_per_tick);  // Core clock, lowest priority
+
+    Clock_Register(Sched_ClockChange);
+}
+
+uint8_t Sched_Add(const char *name, Sched_Fn fn, uint32_t period_ms, uint32_t offset_ms)
+{
+    Sched_Task *t;
+
+    if (sched_count == SCHED_MAX_TASKS || fn == 0 || period_ms == 0) return 0;
+
+    t = &sched_tasks[sched_count++];
+    t->name = name;
+    t->fn = fn;
+    t->period = period_ms;
+    t->next = sched_ticks + offset_ms;
+    t->runs = 0;
+    t->overruns = 0;
+    t->late_max = 0;
+    t->cycles_max = 0;
+    t->cycles = 0;
+    t->load = 0;
+    return 1;
+}
+
+uint32_t Sched_Ticks(void)
+{
+    return sched_ticks;
+}
+
+uint32_t Sched_Release(void)
+{
+    return sched_release;
+}
+
+/* CPU cycles since start (wraps every ~43 s). Call with IRQs disabled. */
+static uint32_t Sched_Stamp(void)
+{
+    uint32_t val = SysTick->VAL;
+    uint32_t ticks = sched_ticks;
+
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) // Reloaded, tick not counted yet
+    {
+        ticks++;
+        val = SysTick->VAL;
+    }
+    return ticks * sched_cycles_per_tick + (SysTick->LOAD - val);
+}
+
+/* Sleep until the next interrupt unless a tick arrived since 'now' */
+static void Sched_Idle(uint32_t now)
+{
+    uint32_t start;
+
+    __disable_irq();
+    if (sched_ticks == now)
+    {
+        start = Sched_Stamp();
+        __WFI();                            // Wakes on a pending IRQ despite PRIMASK
+        idle_cycles += Sched_Stamp() - start;
+    }
+    __enable_irq();                         // Waking interrupt runs here
+}
+
+static void Sched_Dispatch(Sched_Task *t, uint32_t now)
+{
+    uint32_t start;
+    uint32_t cycles;
+
+    if (now - t->next > t->late_max) t->late_max = now - t->next;
+
+    sched_release = t->next;
+    start = DWT->CYCCNT;
+    t->fn(now);
+    cycles = DWT->CYCCNT - start;           // Includes ISRs that preempted it
+    if (cycles > t->cycles_max) t->cycles_max = cycles;
+    t->cycles += cycles;
+
+    t->runs++;
+    t->next += t->period;
+
+    if ((int32_t)(sched_ticks - t->next) > 0)
+    {
+        t->overruns++;                      // Missed its deadline
+        while ((int32_t)(sched_ticks - t->next) > 0) t->next += t->period;
+    }
+}
+
+void Sched_Run(void)
+{
+    uint32_t now;
+    uint32_t elapsed;
+    uint32_t idle;
+    uint32_t window;
+    Sched_Task *t;
+    uint8_t i;
+
+    load_start = sched_ticks;
+
+    while (1)
+    {
+        now = sched_ticks;
+
+        for (i = 0; i < sched_count; i++)
+        {
+            if ((int32_t)(now - sched_tasks[i].next) >= 0) Sched_Dispatch(&sched_tasks[i], now);
+        }
+
+        // A task skipped ticks (Deep Sleep): 'now' is stale and the sleep is
+        // neither idle nor load, so the window restarts after it
+        if (load_skip)
+        {
+            load_skip = 0;
+            Sched_Window(sched_ticks);
+            continue;
+        }
+
+        elapsed = now - load_start;
+        if (elapsed >= SCHED_LOAD_WINDOW)
+        {
+            window = elapsed * (sched_cycles_per_tick / 1000);     // Cycles per 0.1 %
+            idle = idle_cycles / window;
+            load_permille = (idle < 1000) ? (uint16_t)(1000 - idle) : 0;
+            for (i = 0; i < sched_count; i++)
+            {
+                t = &sched_tasks[i];
+                t->load = (uint16_t)(t->cycles / window);
+            }
+            Sched_Window(now);
+        }
+
+        Sched_Idle(now);
+    }
+}
+
+void Sched_Skip(uint32_t ms)
+{
+    Sched_Task *t;
+    uint8_t i;
+
+    __disable_irq();
+    sched_ticks += ms;
+    __enable_irq();
+
+    for (i = 0; i < sched_count; i++)
+    {
+        t = &sched_tasks[i];
+        while ((int32_t)(sched_ticks - t->next) > 0) t->next += t->period;
+    }
+    load_skip = 1;                          // Window restarts in Sched_Run()
+}
+
+void Sched_Delay(uint32_t ms)
+{
+    uint32_t start = sched_ticks;
+
+    while (sched_ticks - start < ms) __WFI();
+}
+
+uint16_t Sched_Load(void)
+{
+    return load_permille;
+}
+
+uint32_t Sched_Overruns(void)
+{
+    uint32_t total = 0;
+    uint8_t i;
+
+    for (i = 0; i < sched_count; i++) total += sched_tasks[i].overruns;
+    return total;
+}
+
+const Sched_Task *Sched_GetTask(uint8_t index)
+{
+    return (index < sched_count) ? &sched_tasks[index] : 0;
+}
+
+char *Sched_Format(char *dst)
+{
+    const Sched_Task *t;
+    uint8_t i;
+
+    for (i = 0; i < sched_count; i++)
+    {
+        t = &sched_tasks[i];
+        dst = Fmt_Str(dst, t->name);
+        dst = Fmt_Str(dst, " ");
+        dst = Fmt_Deci(dst, t->load);
+        dst = Fmt_Str(dst, "% n ");
+        dst = Fmt_UInt(dst, t->runs);
+        dst = Fmt_Str(dst, " ovr ");
+        dst = Fmt_UInt(dst, t->overruns);
+        dst = Fmt_Str(dst, " late ");
+        dst = Fmt_UInt(dst, t->late_max);
+        dst = Fmt_Str(dst, " max ");
+        dst = Fmt_UInt(dst, t->cycles_max);
+        if (i + 1 < sched_count) dst = Fmt_Str(dst, "\n");
+    }
+    return dst;
+}
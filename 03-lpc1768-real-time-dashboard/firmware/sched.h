@@ -0,0 +1,52 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <LPC17xx.h>
+
+#define SCHED_TICK_HZ       1000                // SysTick: 1 ms
+#define SCHED_MAX_TASKS     8
+#define SCHED_LOAD_WINDOW   1000                // ms per CPU load measurement
+
+/* Periodic task, called with the current tick (ms). Runs to completion:
+   never wait inside a task, return and pick up on the next release. */
+typedef void (*Sched_Fn)(uint32_t now);
+
+typedef struct {
+    const char *name;
+    Sched_Fn fn;
+    uint32_t period;                            // ms
+    uint32_t next;                              // Next release (tick)
+    uint32_t runs;
+    uint32_t overruns;                          // Finished after its next release
+    uint32_t late_max;                          // Worst release-to-start delay (ms)
+    uint32_t cycles_max;                        // Worst execution time (CPU cycles)
+    uint32_t cycles;                            // Spent in the current load window
+    uint16_t load;                              // Share of the CPU, last window (0.1 %)
+} Sched_Task;
+
+void Sched_Init(void);
+
+/* Tasks run in table order when due together (first added = first run).
+   offset_ms staggers the first release. Returns 1 if added. */
+uint8_t Sched_Add(const char *name, Sched_Fn fn, uint32_t period_ms, uint32_t offset_ms);
+
+/* Dispatch loop, never returns. Sleeps (WFI) whenever no task is due. */
+void Sched_Run(void);
+
+uint32_t Sched_Ticks(void);
+uint32_t Sched_Release(void);                   // Scheduled tick of the running task (jitter-free)
+void Sched_Delay(uint32_t ms);                  // Sleeping wait, for init code (not tasks)
+
+/* SysTick was stopped for ms (Deep Sleep): the tick count jumps ahead and
+   every task resumes at its next release, without counting overruns */
+void Sched_Skip(uint32_t ms);
+
+uint16_t Sched_Load(void);                      // CPU load over the last window, 0.1 %
+uint32_t Sched_Overruns(void);                  // All tasks
+const Sched_Task *Sched_GetTask(uint8_t index); // 0 past the last task
+
+/* Task table as text: load, runs, overruns, worst delay and cycles */
+#define SCHED_FORMAT_MAX    (SCHED_MAX_TASKS * 72)
+char *Sched_Format(char *dst);
+
+#endif /* SCHED_H_ */
@@ -0,0 +1,59 @@
+#include "sensor.h"
+
+/*
+ * Fixed-point sensor conversion
+ *
+ * Counts -> millivolts in Q16 (one multiply, exact to 1/65536 mV),
+ * then the sensor gain in Q16 with a single 32x32->64 multiply (SMULL)
+ * and one rounding step at the end. No float, no division.
+ * Limits: raw <= 4095 and |gain| < 2^31 / 65536 units per mV.
+ */
+
+int32_t Sensor_Millivolts(uint16_t raw)
+{
+    return (int32_t)((raw * SENSOR_MV_Q16 + 0x8000) >> 16);
+}
+
+int32_t Sensor_Convert(const Sensor_Cal *cal, uint16_t raw)
+{
+    int64_t x;
+
+    x = (int64_t)(int32_t)(raw * SENSOR_MV_Q16) * cal->gain_q16;   // Q32
+    return (int32_t)((x + (1LL << 31)) >> 32) + cal->offset;
+}
+
+#if SENSOR_BENCHMARK
+#include <stdio.h>
+#include "fmt.h"
+#include "uart.h"
+
+void Sensor_Benchmark(uint16_t raw)
+{
+    static const Sensor_Cal cal = SENSOR_CAL_LM35;
+    char buf[32];
+    char line[64];
+    char *p;
+    volatile float temperature_c;
+    uint32_t start, cyc_float, cyc_fixed;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // 1. Previous path: float maths + "%.1f"
+    start = DWT->CYCCNT;
+    temperature_c = ((raw * 3300.0f) / 4095.0f) / 10.0f;
+    sprintf(buf, "Temp: %.1f C\r\n", temperature_c);
+    cyc_float = DWT->CYCCNT - start;
+
+    // 2. Fixed-point conversion + integer formatter
+    start = DWT->CYCCNT;
+    p = Fmt_Str(buf, "Temp: ");
+    p = Fmt_Deci(p, Sensor_Convert(&cal, raw));
+    Fmt_Str(p, " C\r\n");
+    cyc_fixed = DWT->CYCCNT - start;
+
+    sprintf(line, "Cycles/sample: float %lu, fixed %lu\r\n",
+            (unsigned long)cyc_float, (unsigned long)cyc_fixed);
+    UART0_TxString(line);
+}
+#endif
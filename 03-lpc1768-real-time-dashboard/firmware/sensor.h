@@ -0,0 +1,35 @@
+#ifndef SENSOR_H_
+#define SENSOR_H_
+
+#include <LPC17xx.h>
+
+/* Board: 12-bit ADC against VREF */
+#define SENSOR_VREF_MV      3300
+#define SENSOR_MV_Q16       ((SENSOR_VREF_MV * 65536UL + 2047) / 4095)   // mV per count, Q16
+
+/* Gain in output units (0.1) per mV, Q16: SENSOR_GAIN_Q16(3, 2) = 1.5 */
+#define SENSOR_GAIN_Q16(num, den)   ((int32_t)(((num) * 65536L + (den) / 2) / (den)))
+
+/* Per-sensor calibration: output = mV * gain + offset, in 0.1 units */
+typedef struct {
+    int32_t gain_q16;                   // 0.1 units per mV (Q16)
+    int32_t offset;                     // 0.1 units, trims sensor / front-end error
+} Sensor_Cal;
+
+/* LM35: 10 mV per degree -> 1 mV = 0.1 C */
+#define SENSOR_CAL_LM35     { SENSOR_GAIN_Q16(1, 1), 0 }
+
+int32_t Sensor_Millivolts(uint16_t raw);
+int32_t Sensor_Convert(const Sensor_Cal *cal, uint16_t raw);    // 0.1 units
+
+/* Boot-time cycle comparison against the float + printf path (DWT).
+   Links soft-float and printf: leave at 0 for production builds. */
+#ifndef SENSOR_BENCHMARK
+#define SENSOR_BENCHMARK    0
+#endif
+
+#if SENSOR_BENCHMARK
+void Sensor_Benchmark(uint16_t raw);
+#endif
+
+#endif /* SENSOR_H_ */
@@ -0,0 +1,240 @@
+#include "stats.h"
+
+/*
+ * Accumulators are raw 12-bit counts: min / max / sum / sum of squares.
+ * Calibration is applied once per closed window (it is linear): min, max
+ * and mean through Sensor_Convert(), variance scaled by the square of the
+ * channel's units per count. With at most STATS_WINDOW_MAX scans per
+ * window the sum fits 32 bits and n * sumsq stays below 2^64.
+ *
+ * Main context only (sampling task).
+ */
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint64_t sumsq;
+} Stats_Acc;
+
+typedef struct {
+    uint8_t  on;
+    uint8_t  above;                         // Comparator state
+    int16_t  low;
+    int16_t  high;
+} Stats_Threshold;
+
+static Sensor_Cal stats_cal[ADC_CHANNELS];
+static uint8_t stats_mask = 0;
+static uint32_t stats_rate;
+static uint32_t stats_window;               // Scans per window
+
+static Stats_Acc stats_acc[ADC_CHANNELS];
+static uint32_t stats_scans;                // In the open window
+static uint32_t stats_start;                // ms, first scan of the open window
+
+static Stats_Window stats_done;
+static uint8_t stats_ready = 0;
+static uint32_t stats_missed = 0;
+
+static Stats_Threshold stats_thr[ADC_CHANNELS];
+static Stats_Event stats_events[STATS_EVENT_QUEUE];
+static uint8_t stats_ev_head = 0;
+static uint8_t stats_ev_count = 0;
+
+static void Stats_Open(uint32_t time_ms)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        stats_acc[ch].min = 0xFFFF;
+        stats_acc[ch].max = 0;
+        stats_acc[ch].sum = 0;
+        stats_acc[ch].sumsq = 0;
+    }
+    stats_scans = 0;
+    stats_start = time_ms;
+}
+
+void Stats_Config(const ADC_ChannelConfig *cfg, uint32_t rate_hz, uint32_t window_scans)
+{
+    uint8_t ch;
+
+    stats_mask = 0;
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        stats_cal[ch] = cfg[ch].cal;
+        if (cfg[ch].enable) stats_mask |= (1 << ch);
+    }
+    if (window_scans < 1) window_scans = 1;
+    if (window_scans > STATS_WINDOW_MAX) window_scans = STATS_WINDOW_MAX;
+
+    stats_rate = rate_hz ? rate_hz : 1;
+    stats_window = window_scans;
+    stats_ready = 0;
+    Stats_Open(0);
+}
+
+static int16_t Stats_Clamp(int32_t v)
+{
+    return (v > 32767) ? 32767 : (v < -32768) ? -32768 : (int16_t)v;
+}
+
+/* Close the open window into stats_done */
+static void Stats_Close(void)
+{
+    const Stats_Acc *a;
+    Stats_Channel *c;
+    uint32_t n = stats_scans;
+    uint64_t var_q8;
+    uint64_t k;
+    int32_t lo, hi;
+    uint8_t ch;
+
+    if (stats_ready) stats_missed++;
+
+    stats_done.time_ms = stats_start;
+    stats_done.scans = n;
+    stats_done.mask = stats_mask;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (!(stats_mask & (1 << ch))) continue;
+        a = &stats_acc[ch];
+        c = &stats_done.ch[ch];
+
+        lo = Sensor_Convert(&stats_cal[ch], a->min);
+        hi = Sensor_Convert(&stats_cal[ch], a->max);
+        c->min  = Stats_Clamp(lo < hi ? lo : hi);   // Negative gain swaps them
+        c->max  = Stats_Clamp(lo < hi ? hi : lo);
+        c->mean = Stats_Clamp(Sensor_Convert(&stats_cal[ch], (uint16_t)((a->sum + n / 2) / n)));
+
+        // Variance in counts^2 (Q8): (n * sumsq - sum^2) / n^2
+        var_q8 = (a->sumsq * n - (uint64_t)a->sum * a->sum) / n;
+        var_q8 = (var_q8 << 8) / n;
+
+        // Units per count (Q16) = mV per count x units per mV, squared
+        k = ((uint64_t)SENSOR_MV_Q16 * (uint32_t)(stats_cal[ch].gain_q16 < 0 ?
+                -stats_cal[ch].gain_q16 : stats_cal[ch].gain_q16)) >> 16;
+        var_q8 = (var_q8 * k) >> 16;
+        var_q8 = (var_q8 * k) >> 16;
+        c->var = (uint32_t)((var_q8 + 128) >> 8);
+    }
+    stats_ready = 1;
+}
+
+uint8_t Stats_AddBlock(const uint16_t *block, uint16_t n, uint32_t time_ms)
+{
+    Stats_Acc *a;
+    uint8_t closed = 0;
+    uint16_t x;
+    uint16_t i;
+    uint8_t ch;
+
+    if (!stats_mask) return 0;
+
+    for (i = 0; i < n; i++)
+    {
+        if (stats_scans == 0) Stats_Open(time_ms + (uint32_t)((uint64_t)i * 1000 / stats_rate));
+
+        for (ch = 0; ch < ADC_CHANNELS; ch++)
+        {
+            if (!(stats_mask & (1 << ch))) continue;
+            x = *block++;
+            a = &stats_acc[ch];
+            if (x < a->min) a->min = x;
+            if (x > a->max) a->max = x;
+            a->sum += x;
+            a->sumsq += (uint32_t)x * x;
+        }
+
+        if (++stats_scans == stats_window)
+        {
+            Stats_Close();
+            stats_scans = 0;
+            closed = 1;
+        }
+    }
+    return closed;
+}
+
+uint8_t Stats_GetWindow(Stats_Window *w)
+{
+    if (!stats_ready) return 0;
+    *w = stats_done;
+    stats_ready = 0;
+    return 1;
+}
+
+uint32_t Stats_Missed(void)
+{
+    return stats_missed;
+}
+
+uint8_t Stats_SetThreshold(uint8_t ch, int16_t low, int16_t high)
+{
+    if (ch >= ADC_CHANNELS || low > high) return 0;
+
+    stats_thr[ch].low = low;
+    stats_thr[ch].high = high;
+    stats_thr[ch].above = 0;
+    stats_thr[ch].on = 1;
+    return 1;
+}
+
+void Stats_ClearThreshold(uint8_t ch)
+{
+    if (ch < ADC_CHANNELS) stats_thr[ch].on = 0;
+}
+
+static void Stats_Push(uint32_t time_ms, uint8_t ch, uint8_t kind, int16_t value)
+{
+    Stats_Event *e;
+
+    if (stats_ev_count == STATS_EVENT_QUEUE)    // Full: the oldest goes
+    {
+        stats_ev_head = (stats_ev_head + 1) % STATS_EVENT_QUEUE;
+        stats_ev_count--;
+    }
+    e = &stats_events[(stats_ev_head + stats_ev_count++) % STATS_EVENT_QUEUE];
+    e->time_ms = time_ms;
+    e->channel = ch;
+    e->kind = kind;
+    e->value = value;
+}
+
+void Stats_Check(const ADC_Snapshot *snap, uint32_t time_ms)
+{
+    Stats_Threshold *t;
+    int16_t v;
+    uint8_t ch;
+
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        t = &stats_thr[ch];
+        if (!t->on || !(snap->mask & (1 << ch))) continue;
+
+        v = Stats_Clamp(snap->value[ch]);
+        if (!t->above && v > t->high)
+        {
+            t->above = 1;
+            Stats_Push(time_ms, ch, STATS_EVENT_ABOVE, v);
+        }
+        else if (t->above && v < t->low)
+        {
+            t->above = 0;
+            Stats_Push(time_ms, ch, STATS_EVENT_BELOW, v);
+        }
+    }
+}
+
+uint8_t Stats_GetEvent(Stats_Event *e)
+{
+    if (stats_ev_count == 0) return 0;
+
+    *e = stats_events[stats_ev_head];
+    stats_ev_head = (stats_ev_head + 1) % STATS_EVENT_QUEUE;
+    stats_ev_count--;
+    return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <LPC17xx.h>
+#include "adc.h"
+
+/*
+ * Windowed statistics and threshold events per AD0 channel
+ *
+ * Every raw scan is accumulated into fixed (tumbling) windows of
+ * window_scans scans; a closed window yields min / max / mean / variance
+ * in channel units. Thresholds compare the filtered, calibrated value
+ * with hysteresis: ABOVE once it exceeds high, BELOW once it is back
+ * under low.
+ */
+#define STATS_EVENT_ABOVE   1
+#define STATS_EVENT_BELOW   2
+#define STATS_EVENT_QUEUE   16
+#define STATS_WINDOW_MAX    120000UL            // Scans: 60 s at 2 kHz
+
+typedef struct {
+    int16_t  min;                           // Channel units
+    int16_t  max;
+    int16_t  mean;
+    uint32_t var;                           // Channel units squared
+} Stats_Channel;
+
+typedef struct {
+    uint32_t time_ms;                       // First scan of the window
+    uint32_t scans;
+    uint8_t  mask;                          // Channels in ch[] (bit n = AD0.n)
+    Stats_Channel ch[ADC_CHANNELS];
+} Stats_Window;
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t  channel;
+    uint8_t  kind;                          // STATS_EVENT_*
+    int16_t  value;                         // Value that crossed
+} Stats_Event;
+
+/* Restart accumulation for the enabled channels of cfg (calibration taken
+   from it), scans at rate_hz, windows of window_scans (>= 1 block) */
+void Stats_Config(const ADC_ChannelConfig *cfg, uint32_t rate_hz, uint32_t window_scans);
+
+/* n interleaved scans (ADC_ScanCallback layout), the first at time_ms.
+   Returns 1 when a window has closed (Stats_GetWindow). */
+uint8_t Stats_AddBlock(const uint16_t *block, uint16_t n, uint32_t time_ms);
+uint8_t Stats_GetWindow(Stats_Window *w);   // 1 = a new window was waiting
+uint32_t Stats_Missed(void);                // Windows replaced before being read
+
+/* Thresholds in channel units, low <= high. Checked by Stats_Check(). */
+uint8_t Stats_SetThreshold(uint8_t ch, int16_t low, int16_t high);
+void Stats_ClearThreshold(uint8_t ch);
+void Stats_Check(const ADC_Snapshot *snap, uint32_t time_ms);
+uint8_t Stats_GetEvent(Stats_Event *e);     // 1 = event popped (oldest first)
+
+#endif /* STATS_H_ */
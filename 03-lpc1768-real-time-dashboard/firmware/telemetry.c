@@ -0,0 +1,333 @@
+#include "telemetry.h"
+#include "uart.h"
+#include "dma.h"
+#include "crc16.h"
+#include "prof.h"
+
+/*
+ * Binary telemetry link to dashboard.py
+ *
+ * Frames are built in a CPU-RAM scratch buffer, closed with a CRC16 and
+ * COBS encoded into one of TLM_BUFFERS DMA buffers, so the only 0x00 on
+ * the wire is the frame delimiter: the host resynchronises on the next
+ * zero after any corrupt or lost byte. 12-bit samples travel packed
+ * (1.5 bytes each) instead of ~15 bytes of ASCII per reading.
+ *
+ * Every frame takes a sequence number, including frames dropped because
+ * all buffers were still on the wire, so the host counts losses from the
+ * gaps. All senders run in main context only.
+ */
+
+static uint8_t tlm_buffers[TLM_BUFFERS][TLM_FRAME_MAX] DMA_RAM;
+static volatile uint8_t tlm_busy[TLM_BUFFERS];
+
+static uint8_t tlm_frame[TLM_HEADER + TLM_PAYLOAD_MAX + 2];
+static uint16_t tlm_seq = 0;
+static uint32_t tlm_dropped = 0;
+
+static const uint32_t link_bauds[TLM_LINK_COUNT] = TLM_LINK_BAUDS;
+/* Link switch states: the task never waits for the wire, it retries on
+   its next release */
+#define TLM_LINK_IDLE       0
+#define TLM_LINK_ANNOUNCE   1               // LINK frame waits for a free buffer
+#define TLM_LINK_SWITCH     2               // Draining at the old rate, new frames dropped
+#define TLM_LINK_WAIT_ACK   3               // Switched, waiting for ACK
+
+static uint32_t link_request = 0;          // Baud rate asked for, 0 = none
+static uint8_t link_ack = 0;
+static uint8_t link_state = TLM_LINK_IDLE;
+static uint8_t link_confirm;                // Wait for ACK after the switch
+static uint32_t link_baud;                  // Rate being switched to
+static uint32_t link_deadline;
+static uint32_t link_fallback;              // Last confirmed baud rate
+
+/* DMA interrupt: a frame has left its buffer */
+static void Telemetry_Sent(const char *buf, uint8_t status)
+{
+    uint8_t i;
+
+    (void)status;                           // Errors are counted by the UART driver
+    for (i = 0; i < TLM_BUFFERS; i++)
+    {
+        if (buf == (const char *)tlm_buffers[i]) tlm_busy[i] = 0;
+    }
+}
+
+static uint8_t *Telemetry_Put16(uint8_t *p, uint16_t v)
+{
+    *p++ = (uint8_t)v;
+    *p++ = (uint8_t)(v >> 8);
+    return p;
+}
+
+static uint8_t *Telemetry_Put32(uint8_t *p, uint32_t v)
+{
+    p = Telemetry_Put16(p, (uint16_t)v);
+    return Telemetry_Put16(p, (uint16_t)(v >> 16));
+}
+
+/*
+ * COBS: each block starts with a code byte = 1 + number of non-zero bytes
+ * that follow; a code below 0xFF stands for a zero after the block.
+ * Returns the encoded length including the 0x00 delimiter.
+ */
+static uint16_t Telemetry_Cobs(uint8_t *dst, const uint8_t *src, uint16_t len)
+{
+    uint8_t *code = dst;                    // Code byte of the open block
+    uint8_t *out = dst + 1;
+    uint8_t run = 1;
+
+    while (len--)
+    {
+        if (*src)
+        {
+            *out++ = *src;
+            run++;
+        }
+        if (*src == 0 || run == 0xFF)       // Close the block
+        {
+            *code = run;
+            code = out++;
+            run = 1;
+        }
+        src++;
+    }
+    *code = run;
+    *out++ = 0x00;                          // Delimiter
+
+    return (uint16_t)(out - dst);
+}
+
+static uint8_t *Telemetry_Begin(uint8_t type, uint32_t time_ms, uint8_t chmask)
+{
+    uint8_t *p = tlm_frame;
+
+    *p++ = TLM_VERSION;
+    *p++ = type;
+    p = Telemetry_Put16(p, tlm_seq++);
+    p = Telemetry_Put32(p, time_ms);
+    *p++ = chmask;
+    return p;
+}
+
+/* CRC, encode into a free DMA buffer and queue it */
+static uint8_t Telemetry_Finish(uint8_t *end)
+{
+    uint16_t len = (uint16_t)(end - tlm_frame);
+    uint8_t i;
+
+    for (i = 0; i < TLM_BUFFERS && tlm_busy[i]; i++);
+    if (i == TLM_BUFFERS || link_state == TLM_LINK_SWITCH)
+    {
+        tlm_dropped++;                      // Saturated or draining for a baud switch: seq gap
+        return 0;
+    }
+
+    PROF_ENTER(PROF_FRAME);
+    end = Telemetry_Put16(end, CRC16_Update(CRC16_INIT, tlm_frame, len));
+    len = Telemetry_Cobs(tlm_buffers[i], tlm_frame, (uint16_t)(end - tlm_frame));
+    PROF_EXIT(PROF_FRAME);
+
+    tlm_busy[i] = 1;
+    if (!UART0_TxAsync((const char *)tlm_buffers[i], len, Telemetry_Sent))
+    {
+        tlm_busy[i] = 0;
+        tlm_dropped++;
+        return 0;
+    }
+    return 1;
+}
+
+uint8_t Telemetry_SendSamples(uint32_t time_ms, uint8_t chmask, uint32_t rate_hz,
+                              const uint16_t *samples, uint16_t n)
+{
+    uint8_t *p;
+    uint16_t a, b;
+    uint16_t i;
+
+    if (n > ADC_BLOCK_MAX) return 0;
+
+    p = Telemetry_Begin(TLM_TYPE_SAMPLES, time_ms, chmask);
+    p = Telemetry_Put32(p, rate_hz);
+    p = Telemetry_Put16(p, n);
+
+    // Two 12-bit samples in three bytes: a[7:0], b[3:0] a[11:8], b[11:4]
+    for (i = 0; i + 1 < n; i += 2)
+    {
+        a = samples[i];
+        b = samples[i + 1];
+        *p++ = (uint8_t)a;
+        *p++ = (uint8_t)((a >> 8) | (b << 4));
+        *p++ = (uint8_t)(b >> 4);
+    }
+    if (n & 1) p = Telemetry_Put16(p, samples[n - 1]);
+
+    return Telemetry_Finish(p);
+}
+
+uint8_t Telemetry_SendValues(uint32_t time_ms, uint8_t chmask, const int16_t *values)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_VALUES, time_ms, chmask);
+    uint8_t ch;
+
+    for (ch = 0; ch < 8; ch++)
+    {
+        if (chmask & (1 << ch)) p = Telemetry_Put16(p, (uint16_t)*values++);
+    }
+    return Telemetry_Finish(p);
+}
+
+uint8_t Telemetry_SendText(uint32_t time_ms, const char *text)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_TEXT, time_ms, 0);
+    uint16_t n = 0;
+
+    while (*text && n++ < TLM_PAYLOAD_MAX) *p++ = (uint8_t)*text++;
+    return Telemetry_Finish(p);
+}
+
+uint8_t Telemetry_SendStatus(uint32_t time_ms, uint16_t cpu_load, uint32_t overruns)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_STATUS, time_ms, 0);
+
+    p = Telemetry_Put16(p, cpu_load);
+    p = Telemetry_Put32(p, overruns);
+    p = Telemetry_Put32(p, tlm_dropped);
+    return Telemetry_Finish(p);
+}
+
+uint8_t Telemetry_SendSummary(const Stats_Window *w)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_SUMMARY, w->time_ms, w->mask);
+    uint8_t ch;
+
+    p = Telemetry_Put32(p, w->scans);
+    for (ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if (!(w->mask & (1 << ch))) continue;
+        p = Telemetry_Put16(p, (uint16_t)w->ch[ch].min);
+        p = Telemetry_Put16(p, (uint16_t)w->ch[ch].max);
+        p = Telemetry_Put16(p, (uint16_t)w->ch[ch].mean);
+        p = Telemetry_Put32(p, w->ch[ch].var);
+    }
+    return Telemetry_Finish(p);
+}
+
+uint8_t Telemetry_SendEvent(const Stats_Event *e)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_EVENT, e->time_ms, (uint8_t)(1 << e->channel));
+
+    *p++ = e->channel;
+    *p++ = e->kind;
+    p = Telemetry_Put16(p, (uint16_t)e->value);
+    return Telemetry_Finish(p);
+}
+
+/* Page exactly as stored: the host decodes the records */
+uint8_t Telemetry_SendHistory(const History_Page *page)
+{
+    uint8_t *p = Telemetry_Begin(TLM_TYPE_HISTORY, page->first_ms, page->chmask);
+    const uint8_t *src = (const uint8_t *)page;
+    uint16_t n = (uint16_t)(HISTORY_HEADER + page->used);
+
+    while (n--) *p++ = *src++;
+    return Telemetry_Finish(p);
+}
+
+uint32_t Telemetry_Dropped(void)
+{
+    return tlm_dropped;
+}
+
+uint8_t Telemetry_Free(void)
+{
+    uint8_t free = 0;
+    uint8_t i;
+
+    for (i = 0; i < TLM_BUFFERS; i++) free += !tlm_busy[i];
+    return free;
+}
+
+/* Host asked for a new rate ("BAUD <rate>"): one of TLM_LINK_BAUDS */
+uint8_t Telemetry_LinkRequest(uint32_t baud)
+{
+    uint8_t i;
+
+    for (i = 0; i < TLM_LINK_COUNT; i++)
+    {
+        if (link_bauds[i] == baud)
+        {
+            link_request = baud;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Host confirmed the new rate ("ACK") */
+void Telemetry_LinkAck(void)
+{
+    link_ack = 1;
+}
+
+uint8_t Telemetry_LinkAnnounce(uint32_t now_ms, uint32_t baud)
+{
+    uint8_t *p;
+
+    link_request = 0;
+    link_state = TLM_LINK_IDLE;
+    link_fallback = baud;
+    p = Telemetry_Begin(TLM_TYPE_LINK, now_ms, 0);
+    return Telemetry_Finish(Telemetry_Put32(p, baud));
+}
+
+void Telemetry_Service(uint32_t now_ms)
+{
+    uint32_t baud = link_request;
+    uint8_t *p;
+
+    // A new request restarts the negotiation, except while draining
+    if (baud && link_state != TLM_LINK_SWITCH)
+    {
+        link_request = 0;
+        if (link_state == TLM_LINK_IDLE) link_fallback = UART0_GetBaud();
+        link_baud = baud;
+        link_state = TLM_LINK_ANNOUNCE;
+    }
+
+    switch (link_state)
+    {
+    case TLM_LINK_ANNOUNCE:
+        // Announce at the old rate as soon as a buffer is free
+        if (!Telemetry_Free()) break;
+        link_ack = 0;
+        p = Telemetry_Begin(TLM_TYPE_LINK, now_ms, 0);
+        if (Telemetry_Finish(Telemetry_Put32(p, link_baud)))
+        {
+            link_confirm = 1;
+            link_state = TLM_LINK_SWITCH;
+        }
+        break;
+
+    case TLM_LINK_SWITCH:
+        // Switch once every byte has left
+        if (!UART0_TxIdle()) break;
+        UART0_SetBaud(link_baud);
+        link_deadline = now_ms + TLM_LINK_TIMEOUT_MS;
+        link_state = link_confirm ? TLM_LINK_WAIT_ACK : TLM_LINK_IDLE;
+        break;
+
+    case TLM_LINK_WAIT_ACK:
+        if (link_ack)
+        {
+            link_state = TLM_LINK_IDLE;     // Host is listening at the new rate
+        }
+        else if ((int32_t)(now_ms - link_deadline) >= 0)
+        {
+            link_baud = link_fallback;      // No answer: fall back
+            link_confirm = 0;
+            link_state = TLM_LINK_SWITCH;
+        }
+        break;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <LPC17xx.h>
+#include "adc.h"
+#include "stats.h"
+#include "history.h"
+
+/*
+ * Binary telemetry frame (little-endian), COBS encoded, 0x00 terminated:
+ *
+ *   0  version      TLM_VERSION
+ *   1  type         TLM_TYPE_*
+ *   2  seq          u16, +1 per frame (also for frames dropped here)
+ *   4  time_ms      u32, time of the first sample
+ *   8  chmask       u8, bit n = AD0.n
+ *   9  payload      depends on type
+ *   n  crc          u16, CRC-16/CCITT-FALSE over bytes 0 .. n-1
+ */
+#define TLM_VERSION         1
+#define TLM_HEADER          9
+
+#define TLM_TYPE_SAMPLES    1   // rate_hz u32 (scans), count u16, 12-bit samples packed 2 per 3 bytes
+#define TLM_TYPE_VALUES     2   // i16 per channel in chmask, channel units (0.1 C, mV ...)
+#define TLM_TYPE_TEXT       3   // ASCII, not terminated
+#define TLM_TYPE_LINK       4   // baud u32: the link switches after this frame
+#define TLM_TYPE_STATUS     5   // cpu_load u16 (0.1 %), overruns u32, dropped u32
+#define TLM_TYPE_SUMMARY    6   // scans u32, per channel in chmask: min i16, max i16, mean i16, var u32
+#define TLM_TYPE_EVENT      7   // channel u8, kind u8 (STATS_EVENT_*), value i16
+#define TLM_TYPE_HISTORY    8   // History_Page header + records (history.h), time_ms = first record
+
+#define TLM_PAYLOAD_MAX     (6 + (ADC_BLOCK_MAX * 3 + 1) / 2)
+#define TLM_FRAME_MAX       (TLM_HEADER + TLM_PAYLOAD_MAX + 2 + 8)    // + COBS overhead, delimiter
+#define TLM_BUFFERS         3                   // Frames on the wire / queued (DMA_RAM)
+
+/* Baud negotiation: host sends "BAUD <rate>", the board announces the rate
+   (TLM_TYPE_LINK), switches, and reverts unless "ACK" arrives in time */
+#define TLM_LINK_BAUDS      { 9600, 115200, 230400, 460800, 921600 }
+#define TLM_LINK_COUNT      5
+#define TLM_LINK_TIMEOUT_MS 1500
+#define TLM_SAMPLES_MIN_BAUD 115200             // Below this only values are sent
+
+/* Frame senders (main context). Return 1 if queued, 0 if dropped:
+   the sequence number still advances, so the host sees the gap. */
+uint8_t Telemetry_SendSamples(uint32_t time_ms, uint8_t chmask, uint32_t rate_hz,
+                              const uint16_t *samples, uint16_t n); // n = scans x channels
+uint8_t Telemetry_SendValues(uint32_t time_ms, uint8_t chmask, const int16_t *values);
+uint8_t Telemetry_SendText(uint32_t time_ms, const char *text);
+uint8_t Telemetry_SendStatus(uint32_t time_ms, uint16_t cpu_load, uint32_t overruns);
+uint8_t Telemetry_SendSummary(const Stats_Window *w);
+uint8_t Telemetry_SendEvent(const Stats_Event *e);
+uint8_t Telemetry_SendHistory(const History_Page *page);
+
+uint32_t Telemetry_Dropped(void);
+uint8_t Telemetry_Free(void);                   // Frame buffers not on the wire
+
+/* Link negotiation: requests come from the command parser,
+   Telemetry_Service() acts on them from the main loop */
+uint8_t Telemetry_LinkRequest(uint32_t baud);  // 0 = not in TLM_LINK_BAUDS
+void Telemetry_LinkAck(void);
+void Telemetry_Service(uint32_t now_ms);
+
+/* The board is about to drop to baud on its own (clock profile switch):
+   LINK frame at the current rate, no ACK expected. Ends any negotiation. */
+uint8_t Telemetry_LinkAnnounce(uint32_t now_ms, uint32_t baud);
+
+#endif /* TELEMETRY_H_ */
@@ -1,4 +1,10 @@
 #include "timer.h"
+#include "clock_config.h"
+#include "power.h"
+#include "prof.h"
+
+static Timer_Callback timer1_cb;
+static uint32_t timer1_pclk;             // PCLK of the running Timer1 mode
 
 /*
  * Timer0 Interrupt Service Routine
@@ -6,6 +12,16 @@
  */
 void TIMER0_IRQHandler(void)
 {
+#if PROF_ENABLE
+    // Latency from the match: TC holds MR0 for one prescale period, then
+    // resets; PC counts the PCLK ticks within the current period
+    uint32_t pc = LPC_TIM0->PC;
+    uint32_t tc = LPC_TIM0->TC;
+    uint32_t ticks = (tc == LPC_TIM0->MR0) ? pc : (tc + 1) * (LPC_TIM0->PR + 1) + pc;
+
+    PROF_LATENCY(PROF_TIMER0_LAT, ticks * Clock_GetPCLKDiv(CLOCK_PCLK_TIMER0));
+#endif
+
     if (LPC_TIM0->IR & (1 << 0)) // Check MR0 Match
     {
         LPC_GPIO0->FIOPIN ^= (1 << 0); // Toggle P0.0
@@ -13,40 +29,101 @@ void TIMER0_IRQHandler(void)
     }
 }
 
+/*
+ * Timer1 Interrupt Service Routine (periodic mode only)
+ */
+void TIMER1_IRQHandler(void)
+{
+    LPC_TIM1->IR = (1 << 0);             // Clear MR0 Interrupt Flag
+    if (timer1_cb) timer1_cb();
+}
+
+/* Clock profile switch: keep the 1 s prescale at the new PCLK */
+static void Timer0_ClockChange(uint8_t event)
+{
+    if (event == CLOCK_POST) LPC_TIM0->PR = Clock_GetPCLK(CLOCK_PCLK_TIMER0) / 1000000 - 1;
+}
+
 void Timer0_Init(void)
 {
-    LPC_SC->PCONP |= (1 << 1);           // Power On Timer0
-    LPC_SC->PCLKSEL0 &= ~(0x3 << 2);     // PCLK = 25 MHz
+    Power_On(POWER_TIM0);                // PCLK set by the clock profile
     
     LPC_TIM0->CTCR = 0x0;                // Timer Mode
-    LPC_TIM0->PR = 24;                   // Prescaler: 1s resolution
+    LPC_TIM0->PR = Clock_GetPCLK(CLOCK_PCLK_TIMER0) / 1000000 - 1;  // Prescaler: 1s resolution
     LPC_TIM0->MR0 = 500000;              // Match: 500ms (500,000s)
     LPC_TIM0->MCR = (1 << 0) | (1 << 1); // Interrupt & Reset on Match
     
     NVIC_EnableIRQ(TIMER0_IRQn);         // Enable in NVIC
     LPC_TIM0->TCR = 0x01;                // Start Timer
+
+    Clock_Register(Timer0_ClockChange);
+}
+
+/* PCLK ticks per 1/rate_hz (rounded), Timer1 powered and stopped */
+static uint32_t Timer1_Setup(uint32_t rate_hz)
+{
+    uint32_t period;
+
+    timer1_pclk = Clock_GetPCLK(CLOCK_PCLK_TIMER1);
+
+    if (rate_hz == 0) rate_hz = 1;
+    period = (timer1_pclk + rate_hz / 2) / rate_hz;
+    if (period < 2) period = 2;
+
+    Power_On(POWER_TIM1);
+
+    LPC_TIM1->TCR  = 0x02;               // Reset Counter
+    LPC_TIM1->CTCR = 0x0;                // Timer Mode
+    LPC_TIM1->PR   = 0;                  // Full PCLK resolution
+    return period;
 }
 
 /*
- * Blocking delay using Timer1
+ * ADC start trigger on MAT1.0
  *
- * NOTE:
- * This function intentionally uses a blocking delay and
- * reconfigures Timer1 on each call.
- * Suitable for low-rate tasks and demonstration purposes.
+ * MR0 resets the counter and toggles MAT1.0 every half period, so the
+ * ADC (START = MAT1.0 rising edge) converts exactly once per period,
+ * paced by hardware with no interrupt and no jitter.
  */
-void delay_ms(uint32_t ms)
+uint32_t Timer1_StartTrigger(uint32_t rate_hz)
 {
-    LPC_SC->PCONP |= (1 << 2);           // Power On Timer1
-    LPC_SC->PCLKSEL0 &= ~(0x3 << 4);     // PCLK = 25 MHz
-    
-    LPC_TIM1->CTCR = 0x0;
-    LPC_TIM1->PR   = 24;                 // 1s resolution
-    
-    LPC_TIM1->TCR = 0x02;                // Reset Counter
-    LPC_TIM1->TCR = 0x01;                // Enable Timer
-    
-    while (LPC_TIM1->TC < (ms * 1000));  // Wait
-    
-    LPC_TIM1->TCR = 0x00;                // Disable Timer
+    uint32_t half = Timer1_Setup(rate_hz) / 2;   // Two toggles per period
+
+    LPC_TIM1->MR0  = half - 1;
+    LPC_TIM1->MCR  = (1 << 1);           // Reset on Match, no interrupt
+    LPC_TIM1->EMR  = (0x3 << 4);         // MAT1.0 toggles on Match
+    LPC_TIM1->TCR  = 0x01;               // Start Timer
+
+    return timer1_pclk / (2 * half);
+}
+
+/*
+ * Periodic MR0 interrupt
+ *
+ * Used to start ADC burst scans: BURST mode ignores START, so a match
+ * output cannot launch a scan and the callback sets BURST instead.
+ */
+uint32_t Timer1_StartPeriodic(uint32_t rate_hz, Timer_Callback cb)
+{
+    uint32_t period = Timer1_Setup(rate_hz);
+
+    timer1_cb = cb;
+    LPC_TIM1->MR0  = period - 1;
+    LPC_TIM1->MCR  = (1 << 0) | (1 << 1); // Interrupt & Reset on Match
+    LPC_TIM1->EMR  = 0;
+    LPC_TIM1->IR   = 0x3F;
+    NVIC_EnableIRQ(TIMER1_IRQn);
+    LPC_TIM1->TCR  = 0x01;               // Start Timer
+
+    return timer1_pclk / period;
+}
+
+void Timer1_StopTrigger(void)
+{
+    LPC_TIM1->TCR = 0x00;
+    LPC_TIM1->MCR = 0;
+    LPC_TIM1->EMR = 0;                   // MAT1.0 low: next start is a rising edge
+    NVIC_DisableIRQ(TIMER1_IRQn);
+    timer1_cb = 0;
+    Power_Off(POWER_TIM1);               // Powered again by the next start
 }
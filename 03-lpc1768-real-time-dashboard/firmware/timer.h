@@ -3,7 +3,20 @@
 
 #include <LPC17xx.h>
 
+/* Timer PCLK comes from the clock profile (Clock_GetPCLK). Timer0
+   follows profile switches; Timer1 users restart it (the ADC does). */
 void Timer0_Init(void);
-void delay_ms(uint32_t ms);
+
+typedef void (*Timer_Callback)(void);
+
+/* Timer1 MAT1.0 square wave: one rising edge (ADC start) per 1/rate_hz.
+   Returns the rate actually achieved. */
+uint32_t Timer1_StartTrigger(uint32_t rate_hz);
+
+/* Timer1 MR0 interrupt at rate_hz, calling cb (ADC burst scans).
+   Returns the rate actually achieved. */
+uint32_t Timer1_StartPeriodic(uint32_t rate_hz, Timer_Callback cb);
+
+void Timer1_StopTrigger(void);              // Stops either mode
 
 #endif /* TIMER_H_ */
@@ -1,33 +1,261 @@
 #include "uart.h"
+#include "clock_config.h"
+#include "power.h"
+#include "dma.h"
+#include "prof.h"
+
+/*
+ * Transmit queue: buffers handed to UART0_TxAsync() are sent by GPDMA
+ * (one byte per UART0 TX request) while the CPU carries on. The DMA
+ * interrupt completes the head job, starts the next one and then calls
+ * the owner's callback. Buffers must be in DMA_RAM and stay untouched
+ * until that callback.
+ */
+typedef struct {
+    const char *buf;
+    uint16_t len;
+    UART_TxCallback cb;
+} UART_TxJob;
+
+static UART_TxJob tx_queue[UART_TX_QUEUE];
+static volatile uint8_t tx_head = 0;        // Job on the wire
+static volatile uint8_t tx_count = 0;       // Jobs queued incl. the head
+static volatile uint32_t tx_errors = 0;
+
+static uint32_t uart_baud = 0;               // Requested
+static uint32_t uart_baud_actual = 0;
+
+/* Receive ring: written by the ISR (head), read in main context (tail) */
+static uint8_t rx_buf[UART_RX_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+static UART_RxStats rx_stats;
+
+static void UART0_TxStart(const UART_TxJob *job)
+{
+    LPC_GPDMACH_TypeDef *ch = DMA_Channel(DMA_CH_UART0_TX);
+
+    ch->DMACCSrcAddr  = (uint32_t)job->buf;
+    ch->DMACCDestAddr = (uint32_t)&LPC_UART0->THR;
+    ch->DMACCLLI      = 0;
+    ch->DMACCControl  = DMA_CTRL_SIZE(job->len) | DMA_CTRL_SI | DMA_CTRL_I;  // Byte wide, single transfers
+    ch->DMACCConfig   = DMA_CFG_DST(DMA_REQ_UART0_TX) | DMA_CFG_M2P |
+                        DMA_CFG_IE | DMA_CFG_ITC | DMA_CFG_E;
+}
+
+/* DMA interrupt: head job finished (or failed) */
+static void UART0_TxComplete(uint8_t status)
+{
+    UART_TxJob done = tx_queue[tx_head];
+
+    if (status != DMA_DONE) tx_errors++;
+
+    tx_head = (tx_head + 1) % UART_TX_QUEUE;
+    tx_count--;
+    if (tx_count) UART0_TxStart(&tx_queue[tx_head]);
+
+    if (done.cb) done.cb(done.buf, status);
+}
+
+/* Clock profile switch: let queued frames out at the old divider, then
+   recompute it; a rate the new PCLK cannot reach drops to the reset
+   default (CLOCK announces that with a LINK frame beforehand) */
+static void UART0_ClockChange(uint8_t event)
+{
+    if (event == CLOCK_PRE)
+    {
+        UART0_TxFlush();
+    }
+    else if (!UART0_SetBaud(uart_baud))
+    {
+        UART0_SetBaud(UART_BAUD_DEFAULT);
+    }
+}
 
 void UART0_Init(void)
 {
-    LPC_SC->PCONP |= (1 << 3);              // Power On UART0
-    LPC_SC->PCLKSEL0 &= ~(0x3 << 6);        // PCLK = 25 MHz (CCLK/4)
+    Power_On(POWER_UART0);                  // PCLK set by the clock profile
     
     // Configure Pin Select (P0.2 = TXD0, P0.3 = RXD0)
     LPC_PINCON->PINSEL0 &= ~(0xF << 4);
     LPC_PINCON->PINSEL0 |=  (0x5 << 4);
     
-    // Line Control: 8-bit, No Parity, 1 Stop Bit, DLAB Enable
-    LPC_UART0->LCR = 0x83;                  
-    
-    // Baud Rate Calculation for 9600 Baud @ 25MHz PCLK
-    LPC_UART0->DLM = 0;
-    LPC_UART0->DLL = 0xA3;                  
-    
-    LPC_UART0->LCR = 0x03;                  // Disable DLAB (Lock Baud)
+    // Line Control: 8-bit, No Parity, 1 Stop Bit; 9600 Baud
+    LPC_UART0->LCR = 0x03;
+    UART0_SetBaud(UART_BAUD_DEFAULT);
     
-    // FIFO Setup: Enable FIFO, Reset RX/TX, Trigger Level 0 (1 char)
-    LPC_UART0->FCR = 0x07;                  
+    // FIFO Setup: Enable FIFO, Reset RX/TX, Trigger Level 2 (8 chars),
+    // DMA Mode (TX requests to GPDMA)
+    LPC_UART0->FCR = 0x8F;
     
-    LPC_UART0->IER = (1 << 0);              // Enable Receive Data Interrupt
+    LPC_UART0->IER = (1 << 0) | (1 << 2);   // Receive Data + Line Status Interrupts
     NVIC_EnableIRQ(UART0_IRQn);             // Enable UART0 in NVIC
+
+    DMA_Init();
+    DMA_SetCallback(DMA_CH_UART0_TX, UART0_TxComplete);
+
+    Clock_Register(UART0_ClockChange);
+}
+
+/*
+ * Best divider for baud at pclk:
+ * baud = PCLK / (16 * DL * (1 + DIVADDVAL / MULVAL))
+ * Tries every MULVAL / DIVADDVAL pair (DIVADDVAL < MULVAL) with the
+ * rounded DL for it; DL must be >= 3 once DIVADDVAL is used (UM10360).
+ * Ties keep the first hit, so an exact integer divider wins (FDR unused).
+ * Returns the achieved rate, 0 if nothing fits DL.
+ */
+uint32_t UART_FindDivider(uint32_t pclk, uint32_t baud, UART_Divider *d)
+{
+    uint32_t best_err = 0xFFFFFFFFUL;
+    uint32_t best = 0;
+    uint32_t den;
+    uint32_t dl;
+    uint32_t rate;
+    uint32_t err;
+    uint8_t mul;
+    uint8_t add;
+
+    if (baud == 0 || baud > pclk / 16) return 0;   // Keeps 16 * baud * 29 in range
+
+    for (mul = 1; mul <= 15; mul++)
+    {
+        for (add = 0; add < mul; add++)
+        {
+            if (add && mul == 1) continue;
+
+            den = 16 * baud * (mul + add);
+            dl = (pclk * mul + den / 2) / den;
+            if (dl < (add ? 3UL : 1UL) || dl > 0xFFFF) continue;
+
+            den = 16 * dl * (mul + add);
+            rate = (pclk * mul + den / 2) / den;
+            err = (rate > baud) ? rate - baud : baud - rate;
+            if (err < best_err)
+            {
+                best_err = err;
+                best = rate;
+                d->dl = (uint16_t)dl;
+                d->divadd = add;
+                d->mul = mul;
+            }
+        }
+    }
+    return best;
 }
 
-/* Transmit a single character (Polling) */
+uint32_t UART_MatchBaud(uint32_t pclk, uint32_t baud, UART_Divider *d)
+{
+    uint32_t rate = UART_FindDivider(pclk, baud, d);
+    uint32_t err;
+
+    if (rate == 0) return 0;
+    err = (rate > baud) ? rate - baud : baud - rate;
+    return (err > baud / 1000 * UART_BAUD_TOL_PERMILLE) ? 0 : rate;
+}
+
+/*
+ * Program the divider for baud from the UART's running PCLK. Call with
+ * the transmitter idle (UART0_TxFlush): the divider changes under any
+ * byte in flight. Returns the achieved rate, or 0 (rate unchanged) if the
+ * best divider is off by more than UART_BAUD_TOL_PERMILLE.
+ */
+uint32_t UART_SetBaud(LPC_UART_TypeDef *uart, uint32_t baud)
+{
+    UART_Divider d;
+    uint32_t pclk;
+    uint32_t rate;
+
+    if (uart == (LPC_UART_TypeDef *)LPC_UART0)      pclk = Clock_GetPCLK(CLOCK_PCLK_UART0);
+    else if (uart == (LPC_UART_TypeDef *)LPC_UART2) pclk = Clock_GetPCLK(CLOCK_PCLK_UART2);
+    else if (uart == (LPC_UART_TypeDef *)LPC_UART3) pclk = Clock_GetPCLK(CLOCK_PCLK_UART3);
+    else return 0;
+
+    rate = UART_MatchBaud(pclk, baud, &d);
+    if (rate == 0) return 0;
+
+    uart->LCR |= (1 << 7);                  // DLAB Enable
+    uart->DLM = d.dl >> 8;
+    uart->DLL = d.dl & 0xFF;
+    uart->FDR = (d.mul << 4) | d.divadd;
+    uart->LCR &= ~(1 << 7);                 // Disable DLAB (Lock Baud)
+
+    return rate;
+}
+
+uint8_t UART0_SetBaud(uint32_t baud)
+{
+    uint32_t rate = UART_SetBaud((LPC_UART_TypeDef *)LPC_UART0, baud);
+
+    if (rate == 0) return 0;
+    uart_baud = baud;
+    uart_baud_actual = rate;
+    return 1;
+}
+
+uint32_t UART0_GetBaud(void)
+{
+    return uart_baud;
+}
+
+uint32_t UART0_GetBaudActual(void)
+{
+    return uart_baud_actual;
+}
+
+/*
+ * Queue a buffer for DMA transmission. Returns 1 if queued, 0 if the
+ * queue is full or len is out of range. cb (optional) runs in the DMA
+ * interrupt once the buffer may be reused.
+ */
+uint8_t UART0_TxAsync(const char *buf, uint16_t len, UART_TxCallback cb)
+{
+    UART_TxJob *job;
+
+    if (len == 0 || len > DMA_MAX_TRANSFER) return 0;
+
+    PROF_ENTER(PROF_TX_QUEUE);
+    NVIC_DisableIRQ(DMA_IRQn);
+
+    if (tx_count == UART_TX_QUEUE)
+    {
+        NVIC_EnableIRQ(DMA_IRQn);
+        return 0;
+    }
+
+    job = &tx_queue[(tx_head + tx_count) % UART_TX_QUEUE];
+    job->buf = buf;
+    job->len = len;
+    job->cb  = cb;
+
+    if (tx_count++ == 0) UART0_TxStart(job);
+
+    NVIC_EnableIRQ(DMA_IRQn);
+    PROF_EXIT(PROF_TX_QUEUE);
+    return 1;
+}
+
+/* Wait until every queued buffer has left the transmitter */
+void UART0_TxFlush(void)
+{
+    while (!UART0_TxIdle());
+}
+
+/* Non-blocking form of UART0_TxFlush() for tasks */
+uint8_t UART0_TxIdle(void)
+{
+    return tx_count == 0 && (LPC_UART0->LSR & (1 << 6)); // TEMT
+}
+
+uint32_t UART0_TxErrors(void)
+{
+    return tx_errors;
+}
+
+/* Transmit a single character (Polling, after any queued DMA output) */
 void UART0_TxChar(char ch)
 {
+    while (tx_count);                         // Keep ordering with DMA jobs
     while ((LPC_UART0->LSR & (1 << 5)) == 0); // Wait for THR empty
     LPC_UART0->THR = ch;
 }
@@ -35,46 +263,92 @@ void UART0_TxChar(char ch)
 /* Transmit a string */
 void UART0_TxString(char *str)
 {
+    PROF_ENTER(PROF_TX_QUEUE);
     while (*str != '\0')
     {
         UART0_TxChar(*str);
         str++;
     }
+    PROF_EXIT(PROF_TX_QUEUE);
+}
+
+/* Move every byte in the RX FIFO into the ring, counting line errors */
+static void UART0_RxDrain(void)
+{
+    uint8_t lsr = LPC_UART0->LSR;          // Reading clears the error bits
+    uint8_t ch;
+    uint16_t next;
+
+    while (1)
+    {
+        if (lsr & (1 << 1)) rx_stats.overrun++;     // OE: FIFO was full, bytes lost
+        if (!(lsr & (1 << 0))) break;               // RDR: FIFO empty
+
+        ch = LPC_UART0->RBR;                        // Errors below belong to this byte
+        if (lsr & (1 << 2)) rx_stats.parity++;
+        if (lsr & (1 << 3)) rx_stats.framing++;
+        if (lsr & (1 << 4)) rx_stats.breaks++;
+
+        if (!(lsr & 0x1C))
+        {
+            next = (rx_head + 1) & (UART_RX_SIZE - 1);
+            if (next == rx_tail) rx_stats.dropped++;  // Ring full: reader too slow
+            else
+            {
+                rx_buf[rx_head] = ch;
+                rx_head = next;
+            }
+        }
+        lsr = LPC_UART0->LSR;
+    }
 }
 
 /*
  * UART0 Interrupt Service Routine
- * Handles incoming commands from PC (LED Control)
  *
- * NOTE:
- * This ISR handles only Receive Data Available (RDA) and
- * Character Timeout Indicator (CTI) interrupts for simplicity.
- * Error handling (OERR, FE, PE) can be extended if required.
+ * RX only (TX is DMA): RDA fires every 8 bytes (FIFO trigger level),
+ * CTI picks up the tail of a burst, RLS reports line errors. Each drains
+ * the whole FIFO into the ring buffer; commands are parsed by cmd.c in
+ * main context.
  */
 void UART0_IRQHandler(void)
 {
-    uint8_t iir = LPC_UART0->IIR;
+    uint32_t iir;
 
-    // Check if an interrupt is pending
-    if ((iir & 0x01) == 0)
+    PROF_IRQ_ENTRY(PROF_UART0_LAT);
+    PROF_ENTER(PROF_UART0_ISR);
+    while (((iir = LPC_UART0->IIR) & 0x01) == 0)   // Until nothing is pending
     {
-        uint8_t int_id = (iir >> 1) & 0x07;
-
-        // RDA or CTI interrupt
-        if (int_id == 0x02 || int_id == 0x06)
+        switch ((iir >> 1) & 0x07)
         {
-            char received_char = LPC_UART0->RBR; // Reading clears interrupt
-
-            switch (received_char)
-            {
-                case 'A': // Turn User LED ON
-                    LPC_GPIO0->FIOSET = (1 << 1);
-                    break;
+            case 0x03:                          // RLS: error at the FIFO head
+            case 0x02:                          // RDA: trigger level reached
+            case 0x06:                          // CTI: bytes below the trigger, line idle
+                UART0_RxDrain();
+                break;
 
-                case 'B': // Turn User LED OFF
-                    LPC_GPIO0->FIOCLR = (1 << 1);
-                    break;
-            }
+            default:
+                break;
         }
     }
+    PROF_EXIT(PROF_UART0_ISR);
+}
+
+/* Next received byte from the ring. Returns 0 if none is waiting. */
+uint8_t UART0_RxChar(char *ch)
+{
+    uint16_t tail = rx_tail;
+
+    if (tail == rx_head) return 0;
+
+    *ch = (char)rx_buf[tail];
+    rx_tail = (tail + 1) & (UART_RX_SIZE - 1);
+    return 1;
+}
+
+void UART0_RxStats(UART_RxStats *s)
+{
+    NVIC_DisableIRQ(UART0_IRQn);
+    *s = rx_stats;
+    NVIC_EnableIRQ(UART0_IRQn);
 }
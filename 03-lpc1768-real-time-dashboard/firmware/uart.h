@@ -3,8 +3,51 @@
 
 #include <LPC17xx.h>
 
+#define UART_TX_QUEUE   4                   // Pending DMA transmit buffers
+#define UART_RX_SIZE    128                 // Receive ring (power of 2)
+#define UART_BAUD_DEFAULT       9600        // After reset (dashboard BAUD_RATE)
+#define UART_BAUD_TOL_PERMILLE  15          // Worst divider error accepted (1.5 %)
+
+/* Baud rate generator setting: DLM:DLL and the fractional divider (FDR) */
+typedef struct {
+    uint16_t dl;
+    uint8_t divadd;                         // DIVADDVAL, 0 = FDR unused
+    uint8_t mul;                            // MULVAL
+} UART_Divider;
+
+/* Receive errors since UART0_Init() */
+typedef struct {
+    uint32_t overrun;                       // FIFO overflowed: bytes lost in hardware
+    uint32_t framing;                       // Bad stop bit (wrong baud, noise): byte dropped
+    uint32_t parity;                        // Byte dropped
+    uint32_t breaks;                        // Line held low
+    uint32_t dropped;                       // Ring full: byte dropped
+} UART_RxStats;
+
+/* Called from the DMA interrupt when buf has been sent (status: DMA_DONE / DMA_ERROR) */
+typedef void (*UART_TxCallback)(const char *buf, uint8_t status);
+
 void UART0_Init(void);
 void UART0_TxChar(char ch);
 void UART0_TxString(char *str);
 
+/* Divider search against the UART's PCLK; return the achieved rate (0 = none).
+   UART_MatchBaud() also rejects a rate off by more than UART_BAUD_TOL_PERMILLE.
+   UART_SetBaud() covers UART0 / 2 / 3 (UART0 pointer: cast LPC_UART0). */
+uint32_t UART_FindDivider(uint32_t pclk, uint32_t baud, UART_Divider *d);
+uint32_t UART_MatchBaud(uint32_t pclk, uint32_t baud, UART_Divider *d);
+uint32_t UART_SetBaud(LPC_UART_TypeDef *uart, uint32_t baud);
+
+uint8_t UART0_SetBaud(uint32_t baud);       // 1 = set (UART_SetBaud on UART0)
+uint32_t UART0_GetBaud(void);               // Requested rate
+uint32_t UART0_GetBaudActual(void);         // Achieved rate
+
+uint8_t UART0_TxAsync(const char *buf, uint16_t len, UART_TxCallback cb);
+void UART0_TxFlush(void);
+uint8_t UART0_TxIdle(void);                // 1 = nothing queued, transmitter empty
+uint32_t UART0_TxErrors(void);
+
+uint8_t UART0_RxChar(char *ch);             // 1 = byte read from the ring
+void UART0_RxStats(UART_RxStats *s);
+
 #endif /* UART_H_ */